@@ -21,6 +21,8 @@
 
 #include <neogfx/neogfx.hpp>
 #include <map>
+#include <list>
+#include <unordered_map>
 #include <optional>
 #include <boost/pool/pool_alloc.hpp>
 #include <neolib/core/map.hpp>
@@ -34,6 +36,8 @@
 #include <neogfx/app/action.hpp>
 #include <neogfx/app/i_mnemonic.hpp>
 #include <neogfx/app/i_help.hpp>
+#include <neogfx/app/i_resource.hpp>
+#include <neogfx/app/translation_catalogue.hpp>
 
 #ifdef _WIN32
 #pragma comment(linker, "/include:nrc_neogfx_icons")
@@ -112,7 +116,9 @@ namespace neogfx
     public:
         void clear_translations();
         void load_translations();
-        void load_translations(std::filesystem::path const& aTranslationFile);
+        bool load_translations(std::filesystem::path const& aTranslationFile);
+        std::string const& language() const;
+        void set_language(std::string const& aLanguage);
         i_string const& translate(i_string const& aTranslatableString, i_string const& aContext = string{}, std::int64_t aPlurality = 1) const override;
     public:
         i_action& action_file_new() override;
@@ -174,7 +180,18 @@ namespace neogfx
         neogfx::event_processing_context iAppContext;
         std::vector<std::pair<key_code_e, key_modifiers_e>> iKeySequence;
         mutable std::unique_ptr<i_help> iHelp;
-        std::map<std::string, std::map<std::string, std::map<std::pair<std::int64_t, std::int64_t>, string>>> iTranslations;
+        struct translation_file
+        {
+            ref_ptr<i_resource> compiledFile;
+            std::vector<char> compiled;
+            std::optional<translation_catalogue> catalogue;
+            mutable std::unordered_map<std::size_t, string> targetText;
+        };
+        typedef std::list<translation_file> translations; // in load order, later files taking precedence
+        void update_active_translations();
+        std::map<std::string, translations> iTranslations;
+        std::string iLanguage;
+        translations const* iActiveTranslations = nullptr;
         // standard actions
     public:
         action actionFileNew;
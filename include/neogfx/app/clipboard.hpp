@@ -48,14 +48,24 @@ namespace neogfx
         bool has_image() const override;
         neogfx::image image() const override;
         void set_image(const neogfx::image& aImage) override;
+        using i_clipboard::has_payload;
+        using i_clipboard::payload;
+        bool has_payload(i_string const& aMimeType) const override;
+        void payload(i_string const& aMimeType, i_ref_ptr<i_data_payload>& aPayload) const override;
+        void set_payload(i_ref_ptr<i_data_payload> const& aPayload) override;
     public:
         void cut() override;
         void copy() override;
         void paste() override;
         void delete_selected() override;
         void select_all() override;
+    private:
+        bool payload_current() const;
     private:
         i_native_clipboard& iSystemClipboard;
         i_clipboard_sink* iActiveSink;
+        ref_ptr<i_data_payload> iPayload; // last payload set by this process; shared with in-process receivers while the system clipboard still holds it
+        uint32_t iPayloadSequenceNumber;
+        mutable std::optional<string> iPayloadText; // text of the payload, read once on first request
     };
 }
\ No newline at end of file
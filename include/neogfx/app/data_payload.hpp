@@ -0,0 +1,198 @@
+// data_payload.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <neolib/core/string_utf.hpp>
+#include <neogfx/app/i_data_payload.hpp>
+
+namespace neogfx
+{
+    class shared_buffer_payload : public reference_counted<i_data_payload>
+    {
+    public:
+        typedef std::shared_ptr<std::string const> buffer_pointer;
+    private:
+        class reader : public reference_counted<i_data_payload_reader>
+        {
+        public:
+            reader(buffer_pointer const& aBuffer) :
+                iBuffer{ aBuffer }, iNext{ 0u }
+            {
+            }
+        public:
+            std::size_t read(void* aBuffer, std::size_t aBufferSize) override
+            {
+                auto const count = std::min(aBufferSize, iBuffer->size() - iNext);
+                std::copy(std::next(iBuffer->begin(), iNext), std::next(iBuffer->begin(), iNext + count), static_cast<char*>(aBuffer));
+                iNext += count;
+                return count;
+            }
+        private:
+            buffer_pointer iBuffer;
+            std::size_t iNext;
+        };
+    public:
+        shared_buffer_payload(std::string_view const& aMimeType, std::string&& aData) :
+            iMimeType{ std::string{ aMimeType } }, iBuffer{ std::make_shared<std::string const>(std::move(aData)) }
+        {
+        }
+        shared_buffer_payload(std::string_view const& aMimeType, buffer_pointer const& aBuffer) :
+            iMimeType{ std::string{ aMimeType } }, iBuffer{ aBuffer }
+        {
+        }
+    public:
+        i_string const& mime_type() const override
+        {
+            return iMimeType;
+        }
+        bool size_known() const override
+        {
+            return true;
+        }
+        std::uint64_t size() const override
+        {
+            return iBuffer->size();
+        }
+        bool shared() const override
+        {
+            return true;
+        }
+        void const* shared_data() const override
+        {
+            return iBuffer->data();
+        }
+        using i_data_payload::open;
+        void open(i_ref_ptr<i_data_payload_reader>& aReader) const override
+        {
+            aReader = ref_ptr<i_data_payload_reader>{ make_ref<reader>(iBuffer) };
+        }
+    public:
+        buffer_pointer const& buffer() const
+        {
+            return iBuffer;
+        }
+    private:
+        string iMimeType;
+        buffer_pointer iBuffer;
+    };
+
+    // data is rendered by the producer a chunk at a time as it is read
+    class generated_payload : public reference_counted<i_data_payload>
+    {
+    public:
+        typedef std::function<std::size_t(std::uint64_t aOffset, void* aBuffer, std::size_t aBufferSize)> producer;
+    private:
+        class reader : public reference_counted<i_data_payload_reader>
+        {
+        public:
+            reader(std::shared_ptr<producer const> const& aProducer) :
+                iProducer{ aProducer }, iNext{ 0u }
+            {
+            }
+        public:
+            std::size_t read(void* aBuffer, std::size_t aBufferSize) override
+            {
+                auto const count = (*iProducer)(iNext, aBuffer, aBufferSize);
+                iNext += count;
+                return count;
+            }
+        private:
+            std::shared_ptr<producer const> iProducer;
+            std::uint64_t iNext;
+        };
+    public:
+        generated_payload(std::string_view const& aMimeType, producer const& aProducer, std::optional<std::uint64_t> const& aSize = {}) :
+            iMimeType{ std::string{ aMimeType } }, iProducer{ std::make_shared<producer const>(aProducer) }, iSize{ aSize }
+        {
+        }
+    public:
+        i_string const& mime_type() const override
+        {
+            return iMimeType;
+        }
+        bool size_known() const override
+        {
+            return iSize != std::nullopt;
+        }
+        std::uint64_t size() const override
+        {
+            if (!size_known())
+                throw data_payload_size_unknown();
+            return *iSize;
+        }
+        bool shared() const override
+        {
+            return false;
+        }
+        void const* shared_data() const override
+        {
+            throw data_payload_not_shared();
+        }
+        using i_data_payload::open;
+        void open(i_ref_ptr<i_data_payload_reader>& aReader) const override
+        {
+            aReader = ref_ptr<i_data_payload_reader>{ make_ref<reader>(iProducer) };
+        }
+    private:
+        string iMimeType;
+        std::shared_ptr<producer const> iProducer;
+        std::optional<std::uint64_t> iSize;
+    };
+
+    // Reads a UTF-8 payload a chunk at a time and passes each chunk to aSink converted to UTF-16. A sequence split
+    // across chunks is carried over to the next one; one left incomplete at the end of the data becomes U+FFFD.
+    template <typename Sink>
+    inline void read_utf16(i_data_payload const& aPayload, Sink&& aSink, std::size_t aChunkSize = 64u * 1024u)
+    {
+        auto reader = aPayload.open();
+        std::string chunk;
+        std::size_t carried = 0u;
+        for (;;)
+        {
+            chunk.resize(carried + aChunkSize);
+            auto const read = reader->read(chunk.data() + carried, aChunkSize);
+            chunk.resize(carried + read);
+            if (read == 0u)
+            {
+                if (carried != 0u)
+                    aSink(std::u16string{ u'\xFFFD' });
+                break;
+            }
+            auto complete = chunk.size();
+            for (std::size_t back = 1u; back <= std::min<std::size_t>(4u, chunk.size()); ++back)
+            {
+                auto const lead = static_cast<unsigned char>(chunk[chunk.size() - back]);
+                if ((lead & 0xC0u) == 0x80u)
+                    continue;
+                auto const sequenceLength = lead < 0x80u ? 1u : lead < 0xE0u ? 2u : lead < 0xF0u ? 3u : 4u;
+                if (sequenceLength > back)
+                    complete = chunk.size() - back;
+                break;
+            }
+            aSink(neolib::utf8_to_utf16(chunk.substr(0u, complete)));
+            carried = chunk.size() - complete;
+            std::copy(std::next(chunk.begin(), complete), chunk.end(), chunk.begin());
+        }
+    }
+}
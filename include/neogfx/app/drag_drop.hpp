@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <neolib/core/vector.hpp>
 #include <neogfx/app/i_drag_drop.hpp>
+#include <neogfx/app/data_payload.hpp>
 #include <neogfx/gui/window/i_window.hpp>
 
 namespace neogfx
@@ -83,6 +84,24 @@ namespace neogfx
         neolib::vector<string> iFilePaths;
     };
 
+    class drag_drop_data : public drag_drop_object<i_drag_drop_data>
+    {
+        typedef drag_drop_object<i_drag_drop_data> base_type;
+    public:
+        drag_drop_data(i_drag_drop_source& aSource, i_ref_ptr<i_data_payload> const& aPayload) :
+            base_type{ aSource },
+            iPayload{ aPayload }
+        {
+        }
+    public:
+        i_data_payload const& payload() const override
+        {
+            return *iPayload;
+        }
+    private:
+        ref_ptr<i_data_payload> iPayload;
+    };
+
     class drag_drop_item : public drag_drop_object<i_drag_drop_item>
     {
         typedef drag_drop_object<i_drag_drop_item> base_type;
@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <neogfx/core/event.hpp>
 #include <neogfx/gfx/image.hpp>
+#include <neogfx/app/i_data_payload.hpp>
 
 namespace neogfx
 {
@@ -74,6 +75,7 @@ namespace neogfx
     public:
         struct no_active_sink : std::logic_error { no_active_sink() : std::logic_error("neogfx::i_clipboard::no_active_sink") {} };
         struct sink_not_active : std::logic_error { sink_not_active() : std::logic_error("neogfx::i_clipboard::sink_not_active") {} };
+        struct no_payload : std::logic_error { no_payload() : std::logic_error("neogfx::i_clipboard::no_payload") {} };
     public:
         virtual bool sink_active() const = 0;
         virtual i_clipboard_sink& active_sink() = 0;
@@ -86,12 +88,27 @@ namespace neogfx
         virtual bool has_image() const = 0;
         virtual neogfx::image image() const = 0;
         virtual void set_image(const neogfx::image& aImage) = 0;
+        virtual bool has_payload(i_string const& aMimeType) const = 0;
+        virtual void payload(i_string const& aMimeType, i_ref_ptr<i_data_payload>& aPayload) const = 0;
+        virtual void set_payload(i_ref_ptr<i_data_payload> const& aPayload) = 0;
     public:
         virtual void cut() = 0;
         virtual void copy() = 0;
         virtual void paste() = 0;
         virtual void delete_selected() = 0;
         virtual void select_all() = 0;
+        // helpers
+    public:
+        bool has_payload(std::string_view const& aMimeType) const
+        {
+            return has_payload(string{ std::string{ aMimeType } });
+        }
+        ref_ptr<i_data_payload> payload(std::string_view const& aMimeType) const
+        {
+            ref_ptr<i_data_payload> result;
+            payload(string{ std::string{ aMimeType } }, result);
+            return result;
+        }
     public:
         static uuid const& iid() { static uuid const sIid{ 0x441eee78, 0x6c80, 0x464b, 0xb733, { 0x18, 0x91, 0x90, 0xa8, 0x39, 0xb9 } }; return sIid; }
     };
@@ -0,0 +1,80 @@
+// i_data_payload.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <string_view>
+
+namespace neogfx
+{
+    constexpr std::string_view TextPlainMimeType = "text/plain;charset=utf-8";
+
+    struct data_payload_size_unknown : std::logic_error { data_payload_size_unknown() : std::logic_error{ "neogfx::data_payload_size_unknown" } {} };
+    struct data_payload_not_shared : std::logic_error { data_payload_not_shared() : std::logic_error{ "neogfx::data_payload_not_shared" } {} };
+
+    class i_data_payload_reader : public i_reference_counted
+    {
+    public:
+        typedef i_data_payload_reader abstract_type;
+    public:
+        virtual ~i_data_payload_reader() = default;
+    public:
+        // renders the next chunk of data into the buffer; returns 0 once all data has been read
+        virtual std::size_t read(void* aBuffer, std::size_t aBufferSize) = 0;
+    };
+
+    // Data of a single MIME type exchanged via the clipboard or drag and drop. The data is only produced when a
+    // receiver reads it; in-process receivers can use a shared buffer directly rather than reading a copy.
+    class i_data_payload : public i_reference_counted
+    {
+    public:
+        typedef i_data_payload abstract_type;
+    public:
+        virtual ~i_data_payload() = default;
+    public:
+        virtual i_string const& mime_type() const = 0;
+        virtual bool size_known() const = 0;
+        virtual std::uint64_t size() const = 0;
+        virtual bool shared() const = 0;
+        virtual void const* shared_data() const = 0;
+        virtual void open(i_ref_ptr<i_data_payload_reader>& aReader) const = 0;
+        // helpers
+    public:
+        ref_ptr<i_data_payload_reader> open() const
+        {
+            ref_ptr<i_data_payload_reader> result;
+            open(result);
+            return result;
+        }
+        std::string to_std_string() const
+        {
+            if (shared())
+                return std::string{ static_cast<char const*>(shared_data()), static_cast<std::size_t>(size()) };
+            std::string result;
+            if (size_known())
+                result.reserve(static_cast<std::size_t>(size()));
+            auto reader = open();
+            char chunk[4096];
+            for (std::size_t read; (read = reader->read(chunk, sizeof(chunk))) != 0u;)
+                result.append(chunk, read);
+            return result;
+        }
+    };
+}
@@ -27,6 +27,7 @@
 #include <neogfx/gui/widget/item_index.hpp>
 #include <neogfx/gui/widget/i_item_presentation_model.hpp>
 #include <neogfx/game/i_ecs.hpp>
+#include <neogfx/app/i_data_payload.hpp>
 
 namespace neogfx
 {
@@ -65,6 +66,18 @@ namespace neogfx
         }
     };
 
+    class i_drag_drop_data : public i_drag_drop_object
+    {
+    public:
+        virtual i_data_payload const& payload() const = 0;
+    public:
+        static const drag_drop_object_type_id otid()
+        {
+            static drag_drop_object_type_id sId{ 0x3c1e5a2d, 0x8b47, 0x4f0e, 0x9d16, { 0x72, 0xa4, 0xe0, 0x5b, 0xc3, 0x81 } };
+            return sId;
+        }
+    };
+
     class i_drag_drop_item : public i_drag_drop_object
     {
     public:
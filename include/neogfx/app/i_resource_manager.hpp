@@ -20,11 +20,14 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <future>
+#include <functional>
 #include <neogfx/app/i_resource.hpp>
 
 namespace neogfx
 {
     struct embedded_resource_not_found : std::runtime_error { embedded_resource_not_found(std::string const& aResource) : std::runtime_error{ "neogfx::embedded_resource_not_found: " + aResource } {} };
+    struct bad_compressed_resource : std::runtime_error { bad_compressed_resource(std::string const& aResource) : std::runtime_error{ "neogfx::bad_compressed_resource: " + aResource } {} };
 
     class i_resource_manager : public i_service
     {
@@ -33,7 +36,11 @@ namespace neogfx
     public:
         virtual void add_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize) = 0;
         virtual void add_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize) = 0;
+        virtual void add_compressed_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize, std::size_t aUncompressedSize) = 0;
         virtual void load_resource(i_string const& aUri, i_ref_ptr<i_resource>& aResult) = 0;
+    public:
+        virtual std::size_t archive_entry_cache_capacity() const = 0;
+        virtual void set_archive_entry_cache_capacity(std::size_t aCapacity) = 0;
     public:
         virtual void cleanup() = 0;
         virtual void clean() = 0;
@@ -49,12 +56,27 @@ namespace neogfx
         {
             add_module_resource(string{ aUri }, aResourceData, aResourceSize);
         }
+        void add_compressed_module_resource(std::string const& aUri, const void* aResourceData, std::size_t aResourceSize, std::size_t aUncompressedSize)
+        {
+            add_compressed_module_resource(string{ aUri }, aResourceData, aResourceSize, aUncompressedSize);
+        }
         ref_ptr<i_resource> load_resource(std::string const& aUri)
         {
             ref_ptr<i_resource> result;
             load_resource(string{ aUri }, result);
             return result;
         }
+        std::future<ref_ptr<i_resource>> load_resource_async(std::string const& aUri)
+        {
+            auto load = std::make_shared<std::packaged_task<ref_ptr<i_resource>()>>([this, aUri]() { return load_resource(aUri); });
+            auto result = load->get_future();
+            queue_load([load]() { (*load)(); });
+            return result;
+        }
+    public:
+        // runs aLoad on one of a bounded number of loader threads, or on the calling thread once the
+        // resource manager has been torn down
+        virtual void queue_load(std::function<void()> aLoad) = 0;
     public:
         static uuid const& iid() { static uuid const sIid{ 0xe5f11ade, 0x7596, 0x4179, 0x8d77, { 0x1e, 0xb9, 0x9d, 0x6f, 0x3b, 0x96 } }; return sIid; }
     };
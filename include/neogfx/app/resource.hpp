@@ -39,6 +39,7 @@ namespace neogfx
         resource() = delete;
         resource(i_resource_manager& aManager, std::string const& aUri);
         resource(i_resource_manager& aManager, std::string const& aUri, const void* aData, std::size_t aSize);
+        resource(i_resource_manager& aManager, std::string const& aUri, data_type&& aData);
         ~resource();
     public:
         bool available() const override;
@@ -60,6 +61,8 @@ namespace neogfx
         std::optional<string> iError;
         std::size_t iSize;
         data_type iData;
+        std::shared_ptr<void> iMapping;
+        void* iMappedData = nullptr;
         mutable std::optional<data_type> iHash;
     };
 }
\ No newline at end of file
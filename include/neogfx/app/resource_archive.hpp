@@ -0,0 +1,52 @@
+// resource_archive.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <unordered_map>
+#include <mutex>
+#include <neolib/file/zip.hpp>
+#include <neogfx/app/i_resource.hpp>
+
+namespace neogfx
+{
+    // An asset archive opened once: the archive bytes (a memory-mapped file or an embedded resource)
+    // are kept alive for the lifetime of the archive and the zip central directory is indexed by
+    // entry path so that entries can be located and extracted individually.
+    class resource_archive
+    {
+    public:
+        struct entry_not_found : std::runtime_error { entry_not_found(std::string const& aEntry) : std::runtime_error{ "neogfx::resource_archive::entry_not_found: " + aEntry } {} };
+    public:
+        typedef neolib::zip::buffer_type buffer_type;
+    public:
+        resource_archive(ref_ptr<i_resource> const& aArchive);
+    public:
+        i_resource const& archive() const;
+        std::size_t entry_count() const;
+        bool contains(std::string const& aEntryPath) const;
+        void extract(std::string const& aEntryPath, buffer_type& aBuffer) const;
+    private:
+        ref_ptr<i_resource> iArchive;
+        mutable std::mutex iMutex;
+        mutable neolib::zip iZip;
+        std::unordered_map<std::string, std::size_t> iIndex;
+    };
+}
@@ -20,9 +20,16 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include <neolib/core/variant.hpp>
 #include <neolib/core/map.hpp>
 #include "i_resource_manager.hpp"
+#include "resource_archive.hpp"
 
 namespace neogfx
 {
@@ -30,24 +37,50 @@ namespace neogfx
     {
     public:
         resource_manager();
+        ~resource_manager();
         static resource_manager& instance();
     public:
         void merge(i_resource_manager& aResourceManager) override;
     public:
         using i_resource_manager::add_resource;
         using i_resource_manager::add_module_resource;
+        using i_resource_manager::add_compressed_module_resource;
         using i_resource_manager::load_resource;
         void add_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize) override;
         void add_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize) override;
+        void add_compressed_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize, std::size_t aUncompressedSize) override;
         void load_resource(i_string const& aUri, i_ref_ptr<i_resource>& aResult) override;
+    public:
+        std::size_t archive_entry_cache_capacity() const override;
+        void set_archive_entry_cache_capacity(std::size_t aCapacity) override;
     public:
         void cleanup() override;
         void clean() override;
     public:
         neolib::i_map<i_string, neolib::i_variant<i_ref_ptr<i_resource>, i_weak_ref_ptr<i_resource>>> const& resources() override;
         neolib::i_map<i_string, neolib::i_variant<i_ref_ptr<i_resource>, i_weak_ref_ptr<i_resource>>> const& resource_archives() override;
+    public:
+        void queue_load(std::function<void()> aLoad) override;
+        void stop_loading();
+    private:
+        bool find_resource(i_string const& aUri, i_ref_ptr<i_resource>& aResult);
+        resource_archive& archive(std::string const& aArchiveUri);
+        void cache_archive_entry(ref_ptr<i_resource> const& aEntry);
+        void trim_archive_entry_cache();
+        void load_work();
     private:
+        mutable std::recursive_mutex iMutex;
         neolib::map<string, neolib::variant<ref_ptr<i_resource>, weak_ref_ptr<i_resource>>> iResources;
         neolib::map<string, neolib::variant<ref_ptr<i_resource>, weak_ref_ptr<i_resource>>> iResourceArchives;
+        std::unordered_map<std::string, std::unique_ptr<resource_archive>> iArchives;
+        std::size_t iArchiveEntryCacheCapacity;
+        std::size_t iArchiveEntryCacheSize = 0;
+        std::list<ref_ptr<i_resource>> iArchiveEntryCache;
+        std::unordered_map<std::string, std::list<ref_ptr<i_resource>>::iterator> iArchiveEntryCacheIndex;
+        std::mutex iLoadMutex;
+        std::condition_variable iLoadAvailable;
+        std::deque<std::function<void()>> iLoads;
+        bool iStopping = false;
+        std::vector<std::thread> iLoaders;
     };
 }
\ No newline at end of file
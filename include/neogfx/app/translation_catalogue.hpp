@@ -0,0 +1,390 @@
+// translation_catalogue.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <optional>
+#include <limits>
+#include <boost/lexical_cast.hpp>
+#include <neolib/core/vecarray.hpp>
+#include <neolib/core/string_utils.hpp>
+#include <neolib/file/xml.hpp>
+
+namespace neogfx
+{
+    // Compiled translation catalogue (.neolc); one catalogue per target language.
+    // Layout (native endian, offsets from start of catalogue):
+    //   header, displacement seeds (uint32 per bucket), entries (one per slot of a minimal perfect hash),
+    //   targets (plural ranges), string pool.
+    // A key is the source text, optionally prefixed by its context and kContextSeparator.
+    // Header-only so that it can be used by nrc, which does not link neogfx.
+    namespace translation_catalogue_format
+    {
+        char const kMagic[4] = { 'N', 'E', 'O', 'L' };
+        std::uint32_t const kVersion = 1u;
+        char const kContextSeparator = '\x04';
+
+        struct header
+        {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t languageOffset;
+            std::uint32_t languageLength;
+            std::uint32_t entryCount;
+            std::uint32_t bucketCount;
+            std::uint32_t seedsOffset;
+            std::uint32_t entriesOffset;
+            std::uint32_t targetsOffset;
+            std::uint32_t reserved;
+        };
+
+        struct entry
+        {
+            std::uint32_t keyOffset;
+            std::uint32_t keyLength;
+            std::uint32_t firstTarget;
+            std::uint32_t targetCount;
+        };
+
+        struct target
+        {
+            std::int64_t pluralityMin;
+            std::int64_t pluralityMax;
+            std::uint32_t textOffset;
+            std::uint32_t textLength;
+        };
+
+        // FNV-1a, fed incrementally so that context and source can be hashed without being concatenated
+        inline std::uint32_t hash_begin(std::uint32_t aSeed)
+        {
+            return 2166136261u ^ (aSeed * 0x9E3779B9u);
+        }
+
+        inline std::uint32_t hash_continue(std::uint32_t aHash, std::string_view const& aData)
+        {
+            for (auto ch : aData)
+            {
+                aHash ^= static_cast<std::uint8_t>(ch);
+                aHash *= 16777619u;
+            }
+            return aHash;
+        }
+
+        inline std::uint32_t hash_key(std::uint32_t aSeed, std::string_view const& aContext, std::string_view const& aSource)
+        {
+            auto hash = hash_begin(aSeed);
+            if (!aContext.empty())
+            {
+                hash = hash_continue(hash, aContext);
+                hash = hash_continue(hash, std::string_view{ &kContextSeparator, 1 });
+            }
+            return hash_continue(hash, aSource);
+        }
+    }
+
+    class translation_catalogue
+    {
+    public:
+        struct bad_catalogue : std::runtime_error { bad_catalogue() : std::runtime_error{ "neogfx::translation_catalogue::bad_catalogue" } {} };
+    public:
+        typedef translation_catalogue_format::header header;
+        typedef translation_catalogue_format::entry entry;
+        typedef translation_catalogue_format::target target;
+    public:
+        translation_catalogue(const void* aData, std::size_t aSize) :
+            iData{ static_cast<const char*>(aData) }, iSize{ aSize }
+        {
+            if (iSize < sizeof(header))
+                throw bad_catalogue();
+            std::memcpy(&iHeader, iData, sizeof(header));
+            if (std::memcmp(iHeader.magic, translation_catalogue_format::kMagic, sizeof(iHeader.magic)) != 0 || 
+                iHeader.version != translation_catalogue_format::kVersion ||
+                !in_bounds(iHeader.languageOffset, iHeader.languageLength) ||
+                !in_bounds(iHeader.seedsOffset, std::size_t{ iHeader.bucketCount } * sizeof(std::uint32_t)) ||
+                !in_bounds(iHeader.entriesOffset, std::size_t{ iHeader.entryCount } * sizeof(entry)) ||
+                (iHeader.entryCount != 0 && iHeader.bucketCount == 0) ||
+                iHeader.targetsOffset > iSize)
+                throw bad_catalogue();
+            // every entry and the targets it refers to are checked here so that a corrupt catalogue is rejected when it
+            // is loaded rather than when it is first searched
+            for (std::size_t e = 0; e < iHeader.entryCount; ++e)
+            {
+                auto const checked = read<entry>(iHeader.entriesOffset + e * sizeof(entry));
+                if (!in_bounds(checked.keyOffset, checked.keyLength) ||
+                    std::uint64_t{ checked.firstTarget } + checked.targetCount > std::numeric_limits<std::uint32_t>::max())
+                    throw bad_catalogue();
+                for (std::uint32_t t = checked.firstTarget; t < checked.firstTarget + checked.targetCount; ++t)
+                    target_at(t);
+            }
+        }
+    public:
+        std::string_view language() const
+        {
+            return std::string_view{ iData + iHeader.languageOffset, iHeader.languageLength };
+        }
+        std::size_t size() const
+        {
+            return iHeader.entryCount;
+        }
+        // returns the index of the matching target, if any; no allocation
+        std::optional<std::size_t> find(std::string_view const& aContext, std::string_view const& aSource, std::int64_t aPlurality) const
+        {
+            if (iHeader.entryCount == 0)
+                return {};
+            auto const bucket = translation_catalogue_format::hash_key(0u, aContext, aSource) % iHeader.bucketCount;
+            auto const seed = read<std::uint32_t>(iHeader.seedsOffset + bucket * sizeof(std::uint32_t));
+            auto const slot = translation_catalogue_format::hash_key(seed, aContext, aSource) % iHeader.entryCount;
+            auto const e = read<entry>(iHeader.entriesOffset + slot * sizeof(entry));
+            if (!key_matches(e, aContext, aSource) || e.targetCount == 0)
+                return {};
+            for (std::uint32_t t = e.firstTarget; t < e.firstTarget + e.targetCount; ++t)
+            {
+                auto const candidate = target_at(t);
+                if (aPlurality >= candidate.pluralityMin && aPlurality <= candidate.pluralityMax)
+                    return t;
+            }
+            return e.firstTarget;
+        }
+        std::string_view text(std::size_t aTarget) const
+        {
+            auto const t = target_at(aTarget);
+            return std::string_view{ iData + t.textOffset, t.textLength };
+        }
+    private:
+        bool in_bounds(std::size_t aOffset, std::size_t aLength) const
+        {
+            return aOffset <= iSize && aLength <= iSize - aOffset;
+        }
+        template <typename T>
+        T read(std::size_t aOffset) const
+        {
+            if (!in_bounds(aOffset, sizeof(T)))
+                throw bad_catalogue();
+            T result;
+            std::memcpy(&result, iData + aOffset, sizeof(T));
+            return result;
+        }
+        target target_at(std::size_t aTarget) const
+        {
+            auto const result = read<target>(iHeader.targetsOffset + aTarget * sizeof(target));
+            if (!in_bounds(result.textOffset, result.textLength))
+                throw bad_catalogue();
+            return result;
+        }
+        bool key_matches(entry const& aEntry, std::string_view const& aContext, std::string_view const& aSource) const
+        {
+            std::size_t const expectedLength = aContext.empty() ? aSource.size() : aContext.size() + 1u + aSource.size();
+            if (aEntry.keyLength != expectedLength || !in_bounds(aEntry.keyOffset, aEntry.keyLength))
+                return false;
+            std::string_view const key{ iData + aEntry.keyOffset, aEntry.keyLength };
+            if (aContext.empty())
+                return key == aSource;
+            return key.substr(0, aContext.size()) == aContext &&
+                key[aContext.size()] == translation_catalogue_format::kContextSeparator &&
+                key.substr(aContext.size() + 1u) == aSource;
+        }
+    private:
+        const char* iData;
+        std::size_t iSize;
+        header iHeader;
+    };
+
+    class translation_catalogue_builder
+    {
+    public:
+        struct catalogue_too_large : std::runtime_error { catalogue_too_large() : std::runtime_error{ "neogfx::translation_catalogue_builder::catalogue_too_large" } {} };
+        struct no_perfect_hash : std::runtime_error { no_perfect_hash() : std::runtime_error{ "neogfx::translation_catalogue_builder::no_perfect_hash" } {} };
+    public:
+        typedef std::pair<std::int64_t, std::int64_t> plurality_range;
+        static constexpr plurality_range any_plurality() { return plurality_range{ std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max() }; }
+    public:
+        std::string const& language() const
+        {
+            return iLanguage;
+        }
+        void set_language(std::string const& aLanguage)
+        {
+            iLanguage = aLanguage;
+        }
+        bool empty() const
+        {
+            return iTranslations.empty();
+        }
+        void add(std::string const& aContext, std::string const& aSource, plurality_range const& aPlurality, std::string const& aTarget)
+        {
+            auto key = aContext.empty() ? aSource : aContext + translation_catalogue_format::kContextSeparator + aSource;
+            iTranslations[key][aPlurality] = aTarget;
+        }
+        // parses an .xneol translation file: <xneol trgLang="..."><text [context="..."]><source/><target [n="a..b"]/>...</text>...</xneol>
+        bool parse_xneol(std::string const& aPath)
+        {
+            using namespace std::string_literals;
+            neolib::xml translationFile{ aPath };
+            if (translationFile.root().name() != "xneol")
+                return false;
+            set_language(translationFile.root().attribute_value("trgLang").to_std_string());
+            for (auto const& item : translationFile.root())
+            {
+                if (item.name() != "text")
+                    continue;
+                std::string const context = item.has_attribute("context") ? item.attribute_value("context").to_std_string() : std::string{};
+                std::optional<std::string> source;
+                std::vector<std::pair<plurality_range, std::string>> targets;
+                for (auto const& part : item)
+                {
+                    if (part.name() == "source")
+                        source = part.text();
+                    else if (part.name() == "target")
+                    {
+                        auto plurality = any_plurality();
+                        if (part.has_attribute("n"))
+                        {
+                            auto const& n = part.attribute_value("n").to_std_string();
+                            neolib::vecarray<std::string, 2> bits;
+                            neolib::tokens(n, ".."s, bits, 2, false, true);
+                            if (bits.size() == 1)
+                                plurality.second = (plurality.first = boost::lexical_cast<std::int64_t>(bits[0]));
+                            else if (bits.size() == 2)
+                            {
+                                if (!bits[0].empty())
+                                    plurality.first = boost::lexical_cast<std::int64_t>(bits[0]);
+                                if (!bits[1].empty())
+                                    plurality.second = boost::lexical_cast<std::int64_t>(bits[1]);
+                            }
+                        }
+                        targets.push_back(std::make_pair(plurality, part.text()));
+                    }
+                }
+                if (source)
+                    for (auto const& target : targets)
+                        add(context, source.value(), target.first, target.second);
+            }
+            return true;
+        }
+        std::vector<char> build() const
+        {
+            using namespace translation_catalogue_format;
+            std::vector<std::string const*> keys;
+            for (auto const& t : iTranslations)
+                keys.push_back(&t.first);
+            std::uint32_t const entryCount = static_cast<std::uint32_t>(keys.size());
+            std::uint32_t const bucketCount = std::max<std::uint32_t>(1u, (entryCount + 3u) / 4u);
+            // hash and displace: place the largest buckets first, trying seeds until each of a bucket's keys lands in a free slot
+            std::vector<std::vector<std::uint32_t>> buckets(bucketCount);
+            for (std::uint32_t k = 0; k < entryCount; ++k)
+                buckets[hash_key(0u, {}, *keys[k]) % bucketCount].push_back(k);
+            std::vector<std::uint32_t> bucketOrder(bucketCount);
+            for (std::uint32_t b = 0; b < bucketCount; ++b)
+                bucketOrder[b] = b;
+            std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](std::uint32_t lhs, std::uint32_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+            std::vector<std::uint32_t> seeds(bucketCount, 0u);
+            std::vector<std::optional<std::uint32_t>> slots(entryCount);
+            std::vector<std::uint32_t> candidateSlots;
+            for (auto b : bucketOrder)
+            {
+                if (buckets[b].empty())
+                    break;
+                for (std::uint32_t seed = 1u;; ++seed)
+                {
+                    if (seed == 0u)
+                        throw no_perfect_hash();
+                    candidateSlots.clear();
+                    bool placed = true;
+                    for (auto k : buckets[b])
+                    {
+                        auto const slot = hash_key(seed, {}, *keys[k]) % entryCount;
+                        if (slots[slot] || std::find(candidateSlots.begin(), candidateSlots.end(), slot) != candidateSlots.end())
+                        {
+                            placed = false;
+                            break;
+                        }
+                        candidateSlots.push_back(slot);
+                    }
+                    if (!placed)
+                        continue;
+                    for (std::size_t i = 0; i < candidateSlots.size(); ++i)
+                        slots[candidateSlots[i]] = buckets[b][i];
+                    seeds[b] = seed;
+                    break;
+                }
+            }
+            std::vector<char> result;
+            auto const reserve = [&](std::size_t aLength, std::size_t aAlignment) -> std::uint32_t
+            {
+                auto const offset = (result.size() + aAlignment - 1u) / aAlignment * aAlignment;
+                if (offset + aLength > std::numeric_limits<std::uint32_t>::max())
+                    throw catalogue_too_large();
+                result.resize(offset + aLength);
+                return static_cast<std::uint32_t>(offset);
+            };
+            auto const append_string = [&](std::string const& aString) -> std::uint32_t
+            {
+                auto const offset = reserve(aString.size(), 1u);
+                std::memcpy(result.data() + offset, aString.data(), aString.size());
+                return offset;
+            };
+            header h = {};
+            std::memcpy(h.magic, kMagic, sizeof(h.magic));
+            h.version = kVersion;
+            h.entryCount = entryCount;
+            h.bucketCount = bucketCount;
+            reserve(sizeof(header), alignof(header));
+            h.seedsOffset = reserve(bucketCount * sizeof(std::uint32_t), alignof(std::uint32_t));
+            std::memcpy(result.data() + h.seedsOffset, seeds.data(), bucketCount * sizeof(std::uint32_t));
+            h.entriesOffset = reserve(entryCount * sizeof(entry), alignof(entry));
+            std::size_t targetCount = 0;
+            for (auto const& t : iTranslations)
+                targetCount += t.second.size();
+            h.targetsOffset = reserve(targetCount * sizeof(target), alignof(target));
+            std::uint32_t nextTarget = 0u;
+            for (std::uint32_t slot = 0; slot < entryCount; ++slot)
+            {
+                auto const& translation = *iTranslations.find(*keys[*slots[slot]]);
+                entry e = {};
+                e.keyLength = static_cast<std::uint32_t>(translation.first.size());
+                e.keyOffset = append_string(translation.first);
+                e.firstTarget = nextTarget;
+                e.targetCount = static_cast<std::uint32_t>(translation.second.size());
+                for (auto const& plural : translation.second)
+                {
+                    target t = {};
+                    t.pluralityMin = plural.first.first;
+                    t.pluralityMax = plural.first.second;
+                    t.textLength = static_cast<std::uint32_t>(plural.second.size());
+                    t.textOffset = append_string(plural.second);
+                    std::memcpy(result.data() + h.targetsOffset + nextTarget++ * sizeof(target), &t, sizeof(target));
+                }
+                std::memcpy(result.data() + h.entriesOffset + slot * sizeof(entry), &e, sizeof(entry));
+            }
+            h.languageLength = static_cast<std::uint32_t>(iLanguage.size());
+            h.languageOffset = append_string(iLanguage);
+            std::memcpy(result.data(), &h, sizeof(header));
+            return result;
+        }
+    private:
+        std::string iLanguage;
+        std::map<std::string, std::map<plurality_range, std::string>> iTranslations;
+    };
+}
@@ -540,113 +540,133 @@ namespace neogfx
         return standard_easing_index(easing::Zero);
     }
 
+    // Calls aVisitor with a callable that evaluates the (non-inverted part of the) easing function; lets
+    // callers resolve the easing once and then evaluate it many times.
+    template <typename Visitor>
+    inline decltype(auto) visit_easing(easing e, Visitor&& aVisitor)
+    {
+        switch (e & ~(easing_class::Inverted))
+        {
+        case easing::Linear:
+        case easing::InLinear:
+        case easing::OutLinear:
+        case easing::InOutLinear:
+        case easing::OutInLinear:
+            return aVisitor([](auto t) { return ease_linear(t); });
+        case easing::InQuad:
+            return aVisitor([](auto t) { return ease_in_quad(t); });
+        case easing::OutQuad:
+            return aVisitor([](auto t) { return ease_out_quad(t); });
+        case easing::InOutQuad:
+            return aVisitor([](auto t) { return ease_in_out_quad(t); });
+        case easing::OutInQuad:
+            return aVisitor([](auto t) { return ease_out_in_quad(t); });
+        case easing::InCubic:
+            return aVisitor([](auto t) { return ease_in_cubic(t); });
+        case easing::OutCubic:
+            return aVisitor([](auto t) { return ease_out_cubic(t); });
+        case easing::InOutCubic:
+            return aVisitor([](auto t) { return ease_in_out_cubic(t); });
+        case easing::OutInCubic:
+            return aVisitor([](auto t) { return ease_out_in_cubic(t); });
+        case easing::InQuart:
+            return aVisitor([](auto t) { return ease_in_quart(t); });
+        case easing::OutQuart:
+            return aVisitor([](auto t) { return ease_out_quart(t); });
+        case easing::InOutQuart:
+            return aVisitor([](auto t) { return ease_in_out_quart(t); });
+        case easing::OutInQuart:
+            return aVisitor([](auto t) { return ease_out_in_quart(t); });
+        case easing::InQuint:
+            return aVisitor([](auto t) { return ease_in_quint(t); });
+        case easing::OutQuint:
+            return aVisitor([](auto t) { return ease_out_quint(t); });
+        case easing::InOutQuint:
+            return aVisitor([](auto t) { return ease_in_out_quint(t); });
+        case easing::OutInQuint:
+            return aVisitor([](auto t) { return ease_out_in_quint(t); });
+        case easing::InSine:
+            return aVisitor([](auto t) { return ease_in_sine(t); });
+        case easing::OutSine:
+            return aVisitor([](auto t) { return ease_out_sine(t); });
+        case easing::InOutSine:
+            return aVisitor([](auto t) { return ease_in_out_sine(t); });
+        case easing::OutInSine:
+            return aVisitor([](auto t) { return ease_out_in_sine(t); });
+        case easing::InExpo:
+            return aVisitor([](auto t) { return ease_in_expo(t); });
+        case easing::OutExpo:
+            return aVisitor([](auto t) { return ease_out_expo(t); });
+        case easing::InOutExpo:
+            return aVisitor([](auto t) { return ease_in_out_expo(t); });
+        case easing::OutInExpo:
+            return aVisitor([](auto t) { return ease_out_in_expo(t); });
+        case easing::InCirc:
+            return aVisitor([](auto t) { return ease_in_circ(t); });
+        case easing::OutCirc:
+            return aVisitor([](auto t) { return ease_out_circ(t); });
+        case easing::InOutCirc:
+            return aVisitor([](auto t) { return ease_in_out_circ(t); });
+        case easing::OutInCirc:
+            return aVisitor([](auto t) { return ease_out_in_circ(t); });
+        case easing::InElastic:
+            return aVisitor([](auto t) { return ease_in_elastic(t); });
+        case easing::OutElastic:
+            return aVisitor([](auto t) { return ease_out_elastic(t); });
+        case easing::InOutElastic:
+            return aVisitor([](auto t) { return ease_in_out_elastic(t); });
+        case easing::OutInElastic:
+            return aVisitor([](auto t) { return ease_out_in_elastic(t); });
+        case easing::InBack:
+            return aVisitor([](auto t) { return ease_in_back(t); });
+        case easing::OutBack:
+            return aVisitor([](auto t) { return ease_out_back(t); });
+        case easing::InOutBack:
+            return aVisitor([](auto t) { return ease_in_out_back(t); });
+        case easing::OutInBack:
+            return aVisitor([](auto t) { return ease_out_in_back(t); });
+        case easing::InBounce:
+            return aVisitor([](auto t) { return ease_in_bounce(t); });
+        case easing::OutBounce:
+            return aVisitor([](auto t) { return ease_out_bounce(t); });
+        case easing::InOutBounce:
+            return aVisitor([](auto t) { return ease_in_out_bounce(t); });
+        case easing::OutInBounce:
+            return aVisitor([](auto t) { return ease_out_in_bounce(t); });
+        case easing::Zero:
+            return aVisitor([](auto t) { return ease_zero(t); });
+        case easing::One:
+            return aVisitor([](auto t) { return ease_one(t); });
+        default:
+            throw std::logic_error("neogfx::easing: unknown easing type");
+        }
+    }
+
     template <typename T>
     inline T ease(easing e, T t)
     {
-        auto standard_result = [e, t]()
-        {
-            switch (e & ~(easing_class::Inverted))
-            {
-            case easing::Linear:
-            case easing::InLinear:
-            case easing::OutLinear:
-            case easing::InOutLinear:
-            case easing::OutInLinear:
-                return ease_linear(t);
-            case easing::InQuad:
-                return ease_in_quad(t);
-            case easing::OutQuad:
-                return ease_out_quad(t);
-            case easing::InOutQuad:
-                return ease_in_out_quad(t);
-            case easing::OutInQuad:
-                return ease_out_in_quad(t);
-            case easing::InCubic:
-                return ease_in_cubic(t);
-            case easing::OutCubic:
-                return ease_out_cubic(t);
-            case easing::InOutCubic:
-                return ease_in_out_cubic(t);
-            case easing::OutInCubic:
-                return ease_out_in_cubic(t);
-            case easing::InQuart:
-                return ease_in_quart(t);
-            case easing::OutQuart:
-                return ease_out_quart(t);
-            case easing::InOutQuart:
-                return ease_in_out_quart(t);
-            case easing::OutInQuart:
-                return ease_out_in_quart(t);
-            case easing::InQuint:
-                return ease_in_quint(t);
-            case easing::OutQuint:
-                return ease_out_quint(t);
-            case easing::InOutQuint:
-                return ease_in_out_quint(t);
-            case easing::OutInQuint:
-                return ease_out_in_quint(t);
-            case easing::InSine:
-                return ease_in_sine(t);
-            case easing::OutSine:
-                return ease_out_sine(t);
-            case easing::InOutSine:
-                return ease_in_out_sine(t);
-            case easing::OutInSine:
-                return ease_out_in_sine(t);
-            case easing::InExpo:
-                return ease_in_expo(t);
-            case easing::OutExpo:
-                return ease_out_expo(t);
-            case easing::InOutExpo:
-                return ease_in_out_expo(t);
-            case easing::OutInExpo:
-                return ease_out_in_expo(t);
-            case easing::InCirc:
-                return ease_in_circ(t);
-            case easing::OutCirc:
-                return ease_out_circ(t);
-            case easing::InOutCirc:
-                return ease_in_out_circ(t);
-            case easing::OutInCirc:
-                return ease_out_in_circ(t);
-            case easing::InElastic:
-                return ease_in_elastic(t);
-            case easing::OutElastic:
-                return ease_out_elastic(t);
-            case easing::InOutElastic:
-                return ease_in_out_elastic(t);
-            case easing::OutInElastic:
-                return ease_out_in_elastic(t);
-            case easing::InBack:
-                return ease_in_back(t);
-            case easing::OutBack:
-                return ease_out_back(t);
-            case easing::InOutBack:
-                return ease_in_out_back(t);
-            case easing::OutInBack:
-                return ease_out_in_back(t);
-            case easing::InBounce:
-                return ease_in_bounce(t);
-            case easing::OutBounce:
-                return ease_out_bounce(t);
-            case easing::InOutBounce:
-                return ease_in_out_bounce(t);
-            case easing::OutInBounce:
-                return ease_out_in_bounce(t);
-            case easing::Zero:
-                return ease_zero(t);
-            case easing::One:
-                return ease_one(t);
-            default:
-                throw std::logic_error("neogfx::easing: unknown easing type");
-            }
-        };
-        auto result = standard_result();
+        auto result = visit_easing(e, [t](auto aFunction) { return static_cast<T>(aFunction(t)); });
         if (static_cast<easing_class>(e & easing_class::Inverted) == easing_class::Inverted)
             result = 1.0 - result;
         return result;
     }
 
+    // Evaluates one easing function over a batch of normalized times; the easing is resolved once per batch
+    // rather than once per value so the loops below can be vectorized.
+    template <typename T>
+    inline void ease(easing e, T const* aFirst, T const* aLast, T* aResult)
+    {
+        std::size_t const count = aLast - aFirst;
+        visit_easing(e, [&](auto aFunction)
+        {
+            for (std::size_t i = 0u; i < count; ++i)
+                aResult[i] = static_cast<T>(aFunction(aFirst[i]));
+        });
+        if (static_cast<easing_class>(e & easing_class::Inverted) == easing_class::Inverted)
+            for (std::size_t i = 0u; i < count; ++i)
+                aResult[i] = 1.0 - aResult[i];
+    }
+
     template <typename T>
     inline T ease(easing_class in, easing_class out, T t)
     {
@@ -25,4 +25,11 @@
 namespace neogfx
 {
     using neolib::event;
+
+    // Lets a trigger be skipped, along with the construction of its arguments, when nothing is listening.
+    template <typename... Args>
+    inline bool has_subscribers(event<Args...> const& aEvent)
+    {
+        return aEvent.has_subscribers();
+    }
 }
\ No newline at end of file
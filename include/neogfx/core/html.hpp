@@ -20,9 +20,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/core/quick_string.hpp>
+#include <string>
+#include <string_view>
+#include <istream>
 #include <neolib/core/variant.hpp>
 #include <neolib/core/vecarray.hpp>
+#include <neogfx/core/event.hpp>
 #include <neogfx/core/geometrical.hpp>
 #include <neogfx/gfx/hsl_color.hpp>
 #include <neogfx/gfx/hsv_color.hpp>
@@ -37,12 +40,12 @@ namespace neogfx
         // types
         enum type_e { Document = 0x1, Element = 0x2, Text = 0x4, Comment = 0x8, All = 0xFF };
         typedef Alloc allocator_type;
-        typedef neolib::basic_quick_string<CharT> string;
+        typedef std::basic_string<CharT, std::char_traits<CharT>, typename std::allocator_traits<allocator_type>::template rebind_alloc<CharT>> string;
         typedef html_node<CharT, allocator_type> node;
         typedef node* node_ptr;
     private:
         // types
-        typedef std::list<node_ptr, typename allocator_type::template rebind<node_ptr>::other> node_list;
+        typedef std::list<node_ptr, typename std::allocator_traits<allocator_type>::template rebind_alloc<node_ptr>> node_list;
         /* Why std::list of pointers instead of std::vector of pointers?  std::vector is not compatible with chunk allocator
         and timings indicate performance benefit of std::list with chunk allocator compared to std::vector when parsing large (~10MB) html files. */
     public:
@@ -202,13 +205,14 @@ namespace neogfx
             Heading4,
             Heading5,
             Heading6,
-            Paragraph
+            Paragraph,
+            Other
         };
 
     public:
         // allocation
-        static void* operator new(std::size_t) { return typename Alloc::template rebind<html_element>::other().allocate(1); }
-        static void operator delete(void* ptr) { return typename Alloc::template rebind<html_element>::other().deallocate(static_cast<html_element*>(ptr), 1); }
+        static void* operator new(std::size_t) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_element>().allocate(1); }
+        static void operator delete(void* ptr) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_element>().deallocate(static_cast<html_element*>(ptr), 1); }
 
     public:
         // types
@@ -216,7 +220,7 @@ namespace neogfx
         typedef typename node::allocator_type allocator_type;
         typedef typename node::string string;
         typedef std::pair<const string, string> attribute;
-        typedef std::map<string, string, std::less<string>, typename allocator_type::template rebind<attribute>::other> attribute_list;
+        typedef std::map<string, string, std::less<string>, typename std::allocator_traits<allocator_type>::template rebind_alloc<attribute>> attribute_list;
         class iterator : public node::iterator
         {
         public:
@@ -235,10 +239,11 @@ namespace neogfx
 
     public:
         // construction
-        html_element(type_e aType) : node(node::Element), iType(aType), iUseEmptyElementTag(true) {}
+        html_element(const string& aName) : node(node::Element), iName(aName), iType(to_type(aName)), iUseEmptyElementTag(true) {}
 
     public:
         // operations
+        const string& name() const { return iName; }
         type_e type() const { return iType; }
         using node::insert;
         typename node::iterator insert(typename node::iterator aPosition, const CharT* aName) { return node::insert(aPosition, new html_element(aName)); }
@@ -259,8 +264,13 @@ namespace neogfx
         void append_text(const string& aText);
         void set_use_empty_element_tag(bool aUseEmptyElementTag) { iUseEmptyElementTag = aUseEmptyElementTag; }
 
+    private:
+        // implementation
+        static type_e to_type(const string& aName);
+
     private:
         // attributes
+        string iName;
         type_e iType;
         attribute_list iAttributes;
         mutable string iText;
@@ -272,8 +282,8 @@ namespace neogfx
     {
     public:
         // allocation
-        static void* operator new(std::size_t) { return typename Alloc::template rebind<html_text>::other().allocate(1); }
-        static void operator delete(void* ptr) { return typename Alloc::template rebind<html_text>::other().deallocate(static_cast<html_text*>(ptr), 1); }
+        static void* operator new(std::size_t) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_text>().allocate(1); }
+        static void operator delete(void* ptr) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_text>().deallocate(static_cast<html_text*>(ptr), 1); }
 
     public:
         // types
@@ -299,8 +309,8 @@ namespace neogfx
     {
     public:
         // allocation
-        static void* operator new(std::size_t) { return typename Alloc::template rebind<html_comment>::other().allocate(1); }
-        static void operator delete(void* ptr) { return typename Alloc::template rebind<html_comment>::other().deallocate(static_cast<html_comment*>(ptr), 1); }
+        static void* operator new(std::size_t) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_comment>().allocate(1); }
+        static void operator delete(void* ptr) { return typename std::allocator_traits<Alloc>::template rebind_alloc<html_comment>().deallocate(static_cast<html_comment*>(ptr), 1); }
 
     public:
         // types
@@ -321,16 +331,188 @@ namespace neogfx
         string iContent;
     };
 
-    class html
+    template <typename CharT, typename Alloc>
+    inline typename html_node<CharT, Alloc>::const_iterator html_node<CharT, Alloc>::begin(type_e aFilter) const
+    {
+        auto i = iContent.cbegin();
+        while (i != iContent.cend() && !((*i)->type() & aFilter))
+            ++i;
+        return const_iterator(*this, i, aFilter);
+    }
+
+    template <typename CharT, typename Alloc>
+    inline typename html_node<CharT, Alloc>::const_iterator html_node<CharT, Alloc>::end(type_e aFilter) const
+    {
+        return const_iterator(*this, iContent.cend(), aFilter);
+    }
+
+    template <typename CharT, typename Alloc>
+    inline typename html_node<CharT, Alloc>::iterator html_node<CharT, Alloc>::begin(type_e aFilter)
+    {
+        auto i = iContent.begin();
+        while (i != iContent.end() && !((*i)->type() & aFilter))
+            ++i;
+        return iterator(*this, i, aFilter);
+    }
+
+    template <typename CharT, typename Alloc>
+    inline typename html_node<CharT, Alloc>::iterator html_node<CharT, Alloc>::end(type_e aFilter)
+    {
+        return iterator(*this, iContent.end(), aFilter);
+    }
+
+    template <typename CharT, typename Alloc>
+    inline typename html_element<CharT, Alloc>::type_e html_element<CharT, Alloc>::to_type(const string& aName)
+    {
+        static const std::pair<std::string_view, type_e> sTypes[] =
+        {
+            { "!doctype", Doctype },
+            { "html", Html },
+            { "head", Head },
+            { "body", Body },
+            { "h1", Heading1 },
+            { "h2", Heading2 },
+            { "h3", Heading3 },
+            { "h4", Heading4 },
+            { "h5", Heading5 },
+            { "h6", Heading6 },
+            { "p", Paragraph }
+        };
+        for (auto const& t : sTypes)
+            if (std::equal(t.first.begin(), t.first.end(), aName.begin(), aName.end(), [](char aLhs, CharT aRhs) { return static_cast<CharT>(aLhs) == aRhs; }))
+                return t.second;
+        return Other;
+    }
+
+    template <typename CharT, typename Alloc>
+    inline bool html_element<CharT, Alloc>::has_attribute(const string& aAttributeName) const
+    {
+        return iAttributes.find(aAttributeName) != iAttributes.end();
+    }
+
+    template <typename CharT, typename Alloc>
+    inline const typename html_element<CharT, Alloc>::string& html_element<CharT, Alloc>::attribute_value(const string& aAttributeName) const
+    {
+        static const string sEmpty;
+        auto existing = iAttributes.find(aAttributeName);
+        return existing != iAttributes.end() ? existing->second : sEmpty;
+    }
+
+    template <typename CharT, typename Alloc>
+    inline const typename html_element<CharT, Alloc>::string& html_element<CharT, Alloc>::attribute_value(const string& aNewAttributeName, const string& aOldAttributeName) const
+    {
+        return has_attribute(aNewAttributeName) ? attribute_value(aNewAttributeName) : attribute_value(aOldAttributeName);
+    }
+
+    template <typename CharT, typename Alloc>
+    inline const typename html_element<CharT, Alloc>::string& html_element<CharT, Alloc>::text() const
+    {
+        iText.clear();
+        for (auto i = node::begin(node::Text); i != node::end(node::Text); ++i)
+            iText += static_cast<const html_text<CharT, Alloc>&>(*i).content();
+        return iText;
+    }
+
+    template <typename CharT, typename Alloc>
+    inline void html_element<CharT, Alloc>::set_attribute(const string& aAttributeName, const string& aAttributeValue)
+    {
+        iAttributes[aAttributeName] = aAttributeValue;
+    }
+
+    template <typename CharT, typename Alloc>
+    inline void html_element<CharT, Alloc>::append_text(const string& aText)
+    {
+        if (!node::empty() && node::back().node::type() == node::Text)
+            static_cast<html_text<CharT, Alloc>&>(node::back()).content() += aText;
+        else
+            node::push_back(new html_text<CharT, Alloc>{ aText });
+    }
+
+    typedef std::pair<std::string_view, std::string_view> html_attribute;
+    typedef std::vector<html_attribute> html_attributes;
+
+    // Receives tokens as html_tokenizer recognises them; views are only valid for the duration of the call.
+    class i_html_handler
+    {
+    public:
+        virtual ~i_html_handler() = default;
+    public:
+        virtual void doctype(std::string_view aDeclaration) = 0;
+        virtual void start_element(std::string_view aName, const html_attributes& aAttributes, bool aSelfClosing) = 0;
+        virtual void end_element(std::string_view aName) = 0;
+        virtual void character_data(std::string_view aText) = 0;
+        virtual void comment(std::string_view aText) = 0;
+    };
+
+    // SAX-style tokenizer reading UTF-8 from a stream a chunk at a time; only a token that straddles the
+    // end of a chunk is carried over, so memory use is bounded by the chunk size rather than the document. The search
+    // for the end of a carried over token resumes where it stopped; markup still unterminated after kMaxTokenLength
+    // (see html.cpp) is cut off.
+    class html_tokenizer
     {
+    public:
+        static constexpr std::size_t kDefaultChunkSize = 0x10000u;
+    public:
+        html_tokenizer(std::istream& aInput, i_html_handler& aHandler, std::size_t aChunkSize = kDefaultChunkSize);
+    public:
+        bool finished() const;
+        bool tokenize_chunk();
+        void tokenize();
+    private:
+        void scan(bool aEndOfInput);
+        std::size_t scan_text(std::size_t aPosition, bool aEndOfInput);
+        std::size_t scan_raw_text(std::size_t aPosition, bool aEndOfInput);
+        std::size_t scan_markup(std::size_t aPosition, bool aEndOfInput);
+        void emit_text(std::string_view aText);
+        void emit_start_element(std::string_view aTag);
+    private:
+        std::istream& iInput;
+        i_html_handler& iHandler;
+        std::size_t iChunkSize;
+        std::string iBuffer;
+        std::size_t iBufferPosition;
+        std::size_t iResume;
+        char iQuote;
+        std::string iRawTextElement;
+        std::string iName;
+        std::string iDecoded;
+        std::vector<std::pair<std::string, std::string>> iAttributeStorage;
+        html_attributes iAttributes;
+        bool iFinished;
+    };
+
+    class html : private i_html_handler
+    {
+    public:
+        define_event(ChunkParsed, chunk_parsed)
+        define_event(Parsed, parsed)
     public:
         struct failed_to_open_html : std::runtime_error { failed_to_open_html() : std::runtime_error("neogfx::html::failed_to_open_html") {} };
+    public:
+        typedef html_node<char> node;
+        typedef html_element<char> element;
+        typedef html_text<char> text_node;
+        typedef html_comment<char> comment_node;
     public:
         html(std::string const& aFragment);
-        html(std::istream& aDocument);
-    private:
+        html(std::istream& aDocument, bool aIncremental = false);
+    public:
+        const node& document() const;
+        bool finished() const;
+        bool parse_chunk();
         void parse();
+    private:
+        void doctype(std::string_view aDeclaration) override;
+        void start_element(std::string_view aName, const html_attributes& aAttributes, bool aSelfClosing) override;
+        void end_element(std::string_view aName) override;
+        void character_data(std::string_view aText) override;
+        void comment(std::string_view aText) override;
+    private:
+        node& current_node();
     private:
         std::shared_ptr<std::istream> iDocument;
+        std::optional<html_tokenizer> iTokenizer;
+        node iRoot;
+        std::vector<element*> iOpenElements;
     };
 }
@@ -107,10 +107,13 @@ namespace neogfx
     class i_animator;
     class i_transition;
 
+    class property_change_batch;
+
     class i_property : public i_property_delegate
     {
         template <typename, typename>
         friend class property_delegate;
+        friend class property_change_batch;
         // types
     public:
         typedef i_property abstract_type;
@@ -155,6 +158,7 @@ namespace neogfx
         virtual const void* data() const = 0;
         virtual void* data() = 0;
         virtual void*const* calculator_function() const = 0;
+        virtual void deferred_update(bool aNotify) = 0;
         // helpers
     public:
         template <typename T>
@@ -35,6 +35,16 @@ namespace neogfx
         struct cannot_apply : std::logic_error { cannot_apply() : std::logic_error{ "neogfx::i_transition::cannot_apply" } {} };
     public:
         typedef i_transition abstract_type;
+        // Typed handle to the arithmetic property a transition animates; lets the animator mix and assign a
+        // batch's values itself rather than calling apply(double) once per transition.
+        struct scalar_mix_handle
+        {
+            typedef void (*assign_function)(void* aTarget, double aValue);
+            void* target;
+            assign_function assign;
+            double from;
+            double to;
+        };
     public:
         virtual ~i_transition() = default;
     public:
@@ -63,6 +73,8 @@ namespace neogfx
         virtual void reset(easing aNewEasingFunction, bool aEnable = true, bool aDisableWhenFinished = false, bool aResetStartTime = true) = 0;
         virtual bool can_apply() const = 0;
         virtual void apply() = 0;
+        virtual void apply(double aMixValue) = 0;
+        virtual bool mix_handle(scalar_mix_handle& aHandle) const = 0;
     };
 
     class transition;
@@ -79,6 +91,7 @@ namespace neogfx
         virtual double animation_time() const = 0;
     protected:
         virtual transition_id allocate_id() = 0;
+        virtual void transition_changed(transition_id aTransitionId) = 0;
     public:
         static uuid const& iid() { static uuid const sIid{ 0x182ccd2e, 0xd7dd, 0x4a6c, 0x9ac, { 0x72, 0xfd, 0x81, 0x24, 0x7a, 0xe9 } }; return sIid; }
     };
@@ -0,0 +1,98 @@
+// lru_cache.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <list>
+#include <unordered_map>
+#include <iterator>
+
+namespace neogfx
+{
+    // Bounded least recently used cache of values with keys that are expensive to build (e.g. a copy of a path
+    // outline) so lookups go by a precomputed hash and a match predicate rather than by constructing a key.
+    template <typename Key, typename Value>
+    class lru_cache
+    {
+    public:
+        typedef Key key_type;
+        typedef Value value_type;
+    private:
+        struct entry
+        {
+            std::size_t hash;
+            key_type key;
+            value_type value;
+        };
+        typedef std::list<entry> entry_list;
+    public:
+        lru_cache(std::size_t aCapacity) :
+            iCapacity{ aCapacity }
+        {
+        }
+    public:
+        std::size_t capacity() const
+        {
+            return iCapacity;
+        }
+        std::size_t size() const
+        {
+            return iEntries.size();
+        }
+        template <typename Matches>
+        value_type const* find(std::size_t aHash, Matches aMatches)
+        {
+            auto const candidates = iIndex.equal_range(aHash);
+            for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+                if (aMatches(candidate->second->key))
+                {
+                    iEntries.splice(iEntries.begin(), iEntries, candidate->second);
+                    return &iEntries.front().value;
+                }
+            return nullptr;
+        }
+        value_type const& insert(std::size_t aHash, key_type aKey, value_type aValue)
+        {
+            if (iEntries.size() >= iCapacity && !iEntries.empty())
+            {
+                auto const lru = std::prev(iEntries.end());
+                auto const stale = iIndex.equal_range(lru->hash);
+                for (auto s = stale.first; s != stale.second; ++s)
+                    if (s->second == lru)
+                    {
+                        iIndex.erase(s);
+                        break;
+                    }
+                iEntries.erase(lru);
+            }
+            iEntries.push_front(entry{ aHash, std::move(aKey), std::move(aValue) });
+            iIndex.emplace(aHash, iEntries.begin());
+            return iEntries.front().value;
+        }
+        void clear()
+        {
+            iIndex.clear();
+            iEntries.clear();
+        }
+    private:
+        std::size_t iCapacity;
+        entry_list iEntries; // most recently used first
+        std::unordered_multimap<std::size_t, typename entry_list::iterator> iIndex;
+    };
+}
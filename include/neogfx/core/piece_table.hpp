@@ -0,0 +1,476 @@
+// piece_table.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+
+namespace neogfx
+{
+    // Text storage as a persistent (path copying) treap of pieces referring to immutable buffers:
+    // edits are O(log n), copies share all structure so taking an undo snapshot is O(1), and the
+    // initial text can be adopted (e.g. a memory-mapped file) rather than copied.
+    template <typename Tag, typename CharT = char32_t>
+    class basic_piece_table
+    {
+        typedef basic_piece_table<Tag, CharT> self_type;
+    public:
+        struct bad_position : std::logic_error { bad_position() : std::logic_error{ "neogfx::basic_piece_table::bad_position" } {} };
+    public:
+        typedef Tag tag_type;
+        typedef typename tag_type::tag_data tag_data;
+        typedef CharT value_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef value_type const& const_reference;
+        typedef const_reference reference;
+        typedef value_type const* const_pointer;
+        typedef const_pointer pointer;
+    private:
+        static constexpr size_type MINIMUM_ADD_CHUNK_SIZE = 256;
+        static constexpr size_type MAXIMUM_ADD_CHUNK_SIZE = 65536;
+        struct add_chunk
+        {
+            std::unique_ptr<value_type[]> data;
+            size_type capacity;
+            size_type used;
+        };
+        struct piece
+        {
+            std::shared_ptr<void const> owner;
+            value_type const* data;
+            size_type length;
+            tag_type tag;
+        };
+        struct run
+        {
+            const_pointer data;
+            size_type length;
+            tag_type const* tag;
+        };
+        struct node;
+        typedef std::shared_ptr<node const> node_ptr;
+        struct node
+        {
+            piece value;
+            node_ptr left;
+            node_ptr right;
+            size_type weight;
+            std::uint32_t priority;
+        };
+    public:
+        class const_iterator
+        {
+            friend class basic_piece_table;
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef typename basic_piece_table::value_type value_type;
+            typedef typename basic_piece_table::difference_type difference_type;
+            typedef typename basic_piece_table::const_pointer pointer;
+            typedef typename basic_piece_table::const_reference reference;
+        public:
+            const_iterator() :
+                iOwner{ nullptr }, iIndex{ 0u }
+            {
+            }
+            const_iterator(basic_piece_table const& aOwner, size_type aIndex) :
+                iOwner{ &aOwner }, iIndex{ aIndex }
+            {
+            }
+        public:
+            size_type index() const
+            {
+                return iIndex;
+            }
+        public:
+            reference operator*() const
+            {
+                if (iCacheVersion != iOwner->iVersion || iIndex < iPieceStart || iIndex >= iPieceEnd)
+                {
+                    auto const found = iOwner->find_piece(iIndex);
+                    if (found.first == nullptr)
+                        throw bad_position();
+                    iCacheVersion = iOwner->iVersion;
+                    iPieceData = found.first->value.data;
+                    iPieceStart = found.second;
+                    iPieceEnd = found.second + found.first->value.length;
+                }
+                return iPieceData[iIndex - iPieceStart];
+            }
+            pointer operator->() const
+            {
+                return &**this;
+            }
+            reference operator[](difference_type aOffset) const
+            {
+                return *(*this + aOffset);
+            }
+            const_iterator& operator++()
+            {
+                ++iIndex;
+                return *this;
+            }
+            const_iterator& operator--()
+            {
+                --iIndex;
+                return *this;
+            }
+            const_iterator operator++(int)
+            {
+                auto result = *this;
+                ++iIndex;
+                return result;
+            }
+            const_iterator operator--(int)
+            {
+                auto result = *this;
+                --iIndex;
+                return result;
+            }
+            const_iterator& operator+=(difference_type aOffset)
+            {
+                iIndex = static_cast<size_type>(static_cast<difference_type>(iIndex) + aOffset);
+                return *this;
+            }
+            const_iterator& operator-=(difference_type aOffset)
+            {
+                return *this += -aOffset;
+            }
+            friend const_iterator operator+(const_iterator aIterator, difference_type aOffset)
+            {
+                return aIterator += aOffset;
+            }
+            friend const_iterator operator+(difference_type aOffset, const_iterator aIterator)
+            {
+                return aIterator += aOffset;
+            }
+            friend const_iterator operator-(const_iterator aIterator, difference_type aOffset)
+            {
+                return aIterator -= aOffset;
+            }
+            friend difference_type operator-(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return static_cast<difference_type>(aLhs.iIndex) - static_cast<difference_type>(aRhs.iIndex);
+            }
+            friend bool operator==(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex == aRhs.iIndex;
+            }
+            friend bool operator!=(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex != aRhs.iIndex;
+            }
+            friend bool operator<(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex < aRhs.iIndex;
+            }
+            friend bool operator<=(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex <= aRhs.iIndex;
+            }
+            friend bool operator>(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex > aRhs.iIndex;
+            }
+            friend bool operator>=(const_iterator const& aLhs, const_iterator const& aRhs)
+            {
+                return aLhs.iIndex >= aRhs.iIndex;
+            }
+        private:
+            basic_piece_table const* iOwner;
+            size_type iIndex;
+            // sequential access stays within the cached piece so only needs a tree lookup per piece
+            mutable std::uint64_t iCacheVersion = ~std::uint64_t{};
+            mutable value_type const* iPieceData = nullptr;
+            mutable size_type iPieceStart = 0u;
+            mutable size_type iPieceEnd = 0u;
+        };
+        typedef const_iterator iterator;
+    public:
+        basic_piece_table() :
+            iSize{ 0u }, iVersion{ next_version() }, iSeed{ 0x9E3779B9u }
+        {
+        }
+        basic_piece_table(basic_piece_table const& aOther) :
+            iRoot{ aOther.iRoot }, iSize{ aOther.iSize }, iAddChunk{ aOther.iAddChunk }, iVersion{ next_version() }, iSeed{ aOther.iSeed }
+        {
+        }
+        basic_piece_table& operator=(basic_piece_table const& aOther)
+        {
+            iRoot = aOther.iRoot;
+            iSize = aOther.iSize;
+            iAddChunk = aOther.iAddChunk;
+            iVersion = next_version();
+            return *this;
+        }
+    public:
+        bool empty() const
+        {
+            return iSize == 0u;
+        }
+        size_type size() const
+        {
+            return iSize;
+        }
+        const_iterator begin() const
+        {
+            return const_iterator{ *this, 0u };
+        }
+        const_iterator end() const
+        {
+            return const_iterator{ *this, iSize };
+        }
+        const_reference operator[](size_type aIndex) const
+        {
+            return *const_iterator{ *this, aIndex };
+        }
+        tag_type const& tag(const_iterator aPosition) const
+        {
+            auto const found = find_piece(aPosition.index());
+            if (found.first == nullptr)
+                throw bad_position();
+            return found.first->value.tag;
+        }
+        template <typename Visitor>
+        void visit(Visitor aVisitor) const
+        {
+            visit(iRoot.get(), aVisitor);
+        }
+    public:
+        void clear()
+        {
+            iRoot = nullptr;
+            iSize = 0u;
+            iVersion = next_version();
+        }
+        void swap(basic_piece_table& aOther)
+        {
+            std::swap(iRoot, aOther.iRoot);
+            std::swap(iSize, aOther.iSize);
+            std::swap(iAddChunk, aOther.iAddChunk);
+            iVersion = next_version();
+            aOther.iVersion = next_version();
+        }
+        // adopt an immutable buffer (kept alive by aOwner) as the entire contents without copying it
+        void assign(tag_data const& aTagData, std::shared_ptr<void const> aOwner, const_pointer aData, size_type aLength)
+        {
+            clear();
+            if (aLength != 0u)
+            {
+                iRoot = make_node(piece{ std::move(aOwner), aData, aLength, tag_type{ aTagData } }, next_priority(), nullptr, nullptr);
+                iSize = aLength;
+            }
+        }
+        template <typename ForwardIter>
+        const_iterator insert(tag_data const& aTagData, const_iterator aPosition, ForwardIter aFirst, ForwardIter aLast)
+        {
+            auto const position = aPosition.index();
+            if (aFirst == aLast)
+                return const_iterator{ *this, position };
+            auto newPiece = append(aTagData, aFirst, aLast);
+            auto const length = newPiece.length;
+            auto parts = split(iRoot, position);
+            // consecutive typing lands contiguously in the add chunk so usually just lengthens the preceding piece
+            auto extended = extend_back(parts.first, newPiece);
+            if (extended == nullptr)
+                extended = merge(parts.first, make_node(std::move(newPiece), next_priority(), nullptr, nullptr));
+            iRoot = merge(extended, parts.second);
+            iSize += length;
+            iVersion = next_version();
+            return const_iterator{ *this, position };
+        }
+        const_iterator erase(const_iterator aFirst, const_iterator aLast)
+        {
+            auto const first = aFirst.index();
+            auto const last = aLast.index();
+            if (first < last)
+            {
+                auto const head = split(iRoot, first);
+                auto const tail = split(head.second, last - first);
+                iRoot = merge(head.first, tail.second);
+                iSize -= (last - first);
+                iVersion = next_version();
+            }
+            return const_iterator{ *this, first };
+        }
+    public:
+        friend bool operator==(basic_piece_table const& aLhs, basic_piece_table const& aRhs)
+        {
+            if (aLhs.iRoot == aRhs.iRoot)
+                return true;
+            if (aLhs.size() != aRhs.size())
+                return false;
+            thread_local std::vector<run> lhsRuns;
+            thread_local std::vector<run> rhsRuns;
+            lhsRuns.clear();
+            rhsRuns.clear();
+            aLhs.visit([&](const_pointer aData, size_type aLength, tag_type const& aTag) { lhsRuns.push_back(run{ aData, aLength, &aTag }); });
+            aRhs.visit([&](const_pointer aData, size_type aLength, tag_type const& aTag) { rhsRuns.push_back(run{ aData, aLength, &aTag }); });
+            auto lhs = lhsRuns.begin();
+            auto rhs = rhsRuns.begin();
+            while (lhs != lhsRuns.end() && rhs != rhsRuns.end())
+            {
+                auto const length = std::min(lhs->length, rhs->length);
+                if (*lhs->tag != *rhs->tag || (lhs->data != rhs->data && !std::equal(lhs->data, lhs->data + length, rhs->data)))
+                    return false;
+                lhs->data += length;
+                rhs->data += length;
+                if ((lhs->length -= length) == 0u)
+                    ++lhs;
+                if ((rhs->length -= length) == 0u)
+                    ++rhs;
+            }
+            return true;
+        }
+        friend bool operator!=(basic_piece_table const& aLhs, basic_piece_table const& aRhs)
+        {
+            return !(aLhs == aRhs);
+        }
+    private:
+        std::pair<node const*, size_type> find_piece(size_type aIndex) const
+        {
+            node const* current = iRoot.get();
+            size_type base = 0u;
+            while (current != nullptr)
+            {
+                auto const leftWeight = weight(current->left);
+                if (aIndex < base + leftWeight)
+                    current = current->left.get();
+                else if (aIndex < base + leftWeight + current->value.length)
+                    return std::make_pair(current, base + leftWeight);
+                else
+                {
+                    base += leftWeight + current->value.length;
+                    current = current->right.get();
+                }
+            }
+            return std::make_pair(nullptr, base);
+        }
+        template <typename ForwardIter>
+        piece append(tag_data const& aTagData, ForwardIter aFirst, ForwardIter aLast)
+        {
+            auto const length = static_cast<size_type>(std::distance(aFirst, aLast));
+            if (iAddChunk == nullptr || iAddChunk->capacity - iAddChunk->used < length)
+            {
+                auto const capacity = std::max(length, iAddChunk == nullptr ? 
+                    MINIMUM_ADD_CHUNK_SIZE : std::min(iAddChunk->capacity * 2u, MAXIMUM_ADD_CHUNK_SIZE));
+                iAddChunk = std::make_shared<add_chunk>(add_chunk{ std::unique_ptr<value_type[]>{ new value_type[capacity] }, capacity, 0u });
+            }
+            // chunks are shared with snapshots; existing characters are never overwritten, only appended to
+            auto const data = iAddChunk->data.get() + iAddChunk->used;
+            std::copy(aFirst, aLast, data);
+            iAddChunk->used += length;
+            return piece{ iAddChunk, data, length, tag_type{ aTagData } };
+        }
+        std::uint32_t next_priority()
+        {
+            iSeed ^= iSeed << 13;
+            iSeed ^= iSeed >> 17;
+            iSeed ^= iSeed << 5;
+            return iSeed;
+        }
+        static std::uint64_t next_version()
+        {
+            static std::atomic<std::uint64_t> sVersion;
+            return ++sVersion;
+        }
+        static size_type weight(node_ptr const& aNode)
+        {
+            return aNode != nullptr ? aNode->weight : 0u;
+        }
+        static node_ptr make_node(piece aPiece, std::uint32_t aPriority, node_ptr aLeft, node_ptr aRight)
+        {
+            auto const totalWeight = aPiece.length + weight(aLeft) + weight(aRight);
+            return std::make_shared<node const>(node{ std::move(aPiece), std::move(aLeft), std::move(aRight), totalWeight, aPriority });
+        }
+        static std::pair<node_ptr, node_ptr> split(node_ptr const& aNode, size_type aIndex)
+        {
+            if (aNode == nullptr || aIndex == 0u)
+                return std::make_pair(nullptr, aNode);
+            if (aIndex >= aNode->weight)
+                return std::make_pair(aNode, nullptr);
+            auto const leftWeight = weight(aNode->left);
+            if (aIndex <= leftWeight)
+            {
+                auto parts = split(aNode->left, aIndex);
+                return std::make_pair(std::move(parts.first), make_node(aNode->value, aNode->priority, std::move(parts.second), aNode->right));
+            }
+            auto const pieceEnd = leftWeight + aNode->value.length;
+            if (aIndex >= pieceEnd)
+            {
+                auto parts = split(aNode->right, aIndex - pieceEnd);
+                return std::make_pair(make_node(aNode->value, aNode->priority, aNode->left, std::move(parts.first)), std::move(parts.second));
+            }
+            auto const offset = aIndex - leftWeight;
+            piece head = aNode->value;
+            head.length = offset;
+            piece tail = aNode->value;
+            tail.data += offset;
+            tail.length -= offset;
+            return std::make_pair(
+                make_node(std::move(head), aNode->priority, aNode->left, nullptr),
+                make_node(std::move(tail), aNode->priority, nullptr, aNode->right));
+        }
+        static node_ptr merge(node_ptr const& aLeft, node_ptr const& aRight)
+        {
+            if (aLeft == nullptr)
+                return aRight;
+            if (aRight == nullptr)
+                return aLeft;
+            if (aLeft->priority >= aRight->priority)
+                return make_node(aLeft->value, aLeft->priority, aLeft->left, merge(aLeft->right, aRight));
+            return make_node(aRight->value, aRight->priority, merge(aLeft, aRight->left), aRight->right);
+        }
+        static node_ptr extend_back(node_ptr const& aNode, piece const& aPiece)
+        {
+            if (aNode == nullptr)
+                return nullptr;
+            if (aNode->right != nullptr)
+            {
+                auto right = extend_back(aNode->right, aPiece);
+                return right != nullptr ? make_node(aNode->value, aNode->priority, aNode->left, std::move(right)) : nullptr;
+            }
+            if (aNode->value.owner != aPiece.owner || aNode->value.data + aNode->value.length != aPiece.data || aNode->value.tag != aPiece.tag)
+                return nullptr;
+            piece extended = aNode->value;
+            extended.length += aPiece.length;
+            return make_node(std::move(extended), aNode->priority, aNode->left, nullptr);
+        }
+        template <typename Visitor>
+        static void visit(node const* aNode, Visitor& aVisitor)
+        {
+            if (aNode == nullptr)
+                return;
+            visit(aNode->left.get(), aVisitor);
+            aVisitor(aNode->value.data, aNode->value.length, aNode->value.tag);
+            visit(aNode->right.get(), aVisitor);
+        }
+    private:
+        node_ptr iRoot;
+        size_type iSize;
+        std::shared_ptr<add_chunk> iAddChunk;
+        std::uint64_t iVersion;
+        std::uint32_t iSeed;
+    };
+}
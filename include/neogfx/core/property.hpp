@@ -21,6 +21,9 @@
 
 #include <neogfx/neogfx.hpp>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <exception>
 #include <neolib/core/optional.hpp>
 #include <neogfx/core/i_object.hpp>
 #include <neogfx/core/i_property.hpp>
@@ -36,6 +39,103 @@ namespace neogfx
     template <typename T, typename Category, class Context, typename Calculator>
     class property;
 
+    // Defers property change notifications made on this thread until the outermost batch ends; a property
+    // changed more than once within a batch is notified once, from the value it had before the batch.
+    // Notifications are sent by commit(), which propagates any exception thrown by a notification handler,
+    // or else by the destructor, which cannot and so swallows such exceptions.
+    class property_change_batch
+    {
+    public:
+        property_change_batch() :
+            iOutermost{ current_batch_for_this_thread() == nullptr }, iUncaughtExceptions{ std::uncaught_exceptions() }
+        {
+            if (iOutermost)
+                current_batch_for_this_thread() = this;
+        }
+        ~property_change_batch()
+        {
+            if (!iOutermost || iEnded)
+                return;
+            try
+            {
+                end(std::uncaught_exceptions() <= iUncaughtExceptions);
+            }
+            catch (...)
+            {
+            }
+        }
+    public:
+        void commit()
+        {
+            if (iOutermost && !iEnded)
+                end(true);
+        }
+    public:
+        static bool active()
+        {
+            auto const batch = current_batch_for_this_thread();
+            return batch != nullptr && !batch->iFlushing;
+        }
+        static property_change_batch& defer(i_property& aProperty)
+        {
+            auto& batch = *current_batch_for_this_thread();
+            std::scoped_lock<std::mutex> lock{ batch.iMutex };
+            batch.iDeferred.push_back(&aProperty);
+            return batch;
+        }
+        // may be called from any thread, e.g. when a deferred property is destroyed by another thread
+        void cancel(i_property& aProperty)
+        {
+            std::scoped_lock<std::mutex> lock{ iMutex };
+            std::replace(iDeferred.begin(), iDeferred.end(), &aProperty, static_cast<i_property*>(nullptr));
+        }
+    private:
+        void end(bool aNotify)
+        {
+            iEnded = true;
+            iFlushing = true;
+            // notifications can change further properties (which are then notified immediately) or destroy deferred ones
+            try
+            {
+                flush(aNotify);
+            }
+            catch (...)
+            {
+                flush(false);
+                current_batch_for_this_thread() = nullptr;
+                throw;
+            }
+            current_batch_for_this_thread() = nullptr;
+        }
+        void flush(bool aNotify)
+        {
+            for (std::size_t i = 0u;; ++i)
+            {
+                i_property* deferred = nullptr;
+                {
+                    std::scoped_lock<std::mutex> lock{ iMutex };
+                    if (i >= iDeferred.size())
+                        break;
+                    deferred = std::exchange(iDeferred[i], nullptr);
+                }
+                if (deferred != nullptr)
+                    deferred->deferred_update(aNotify);
+            }
+        }
+        static property_change_batch*& current_batch_for_this_thread()
+        {
+            thread_local property_change_batch* tCurrentBatch = nullptr;
+            return tCurrentBatch;
+        }
+    private:
+        bool const iOutermost;
+        int const iUncaughtExceptions;
+        bool iEnded = false;
+        bool iFlushing = false;
+        std::mutex iMutex;
+        std::vector<i_property*> iDeferred;
+    };
+
     template <typename T, typename Category, class Context, typename Calculator>
     class property_transition : public transition
     {
@@ -90,12 +190,7 @@ namespace neogfx
             if (!can_apply())
                 throw cannot_apply();
             if (!animation_finished())
-            {
-                auto const mixValue = mix_value();
-                iMix = neogfx::mix(iFrom, iTo, mixValue);
-                neolib::scoped_flag sf{ iUpdatingProperty };
-                iProperty = mix();
-            }
+                apply(mix_value());
             else
             {
                 iMix = (easing_function() != easing::Zero ? *iTo : *iFrom);
@@ -106,6 +201,24 @@ namespace neogfx
                     disable();
             }
         }
+        void apply(double aMixValue) final
+        {
+            iMix = neogfx::mix(iFrom, iTo, aMixValue);
+            neolib::scoped_flag sf{ iUpdatingProperty };
+            iProperty = mix();
+        }
+        bool mix_handle(scalar_mix_handle& aHandle) const final
+        {
+            if constexpr (std::is_arithmetic_v<value_type>)
+            {
+                if (!iFrom || !iTo)
+                    return false;
+                aHandle = { const_cast<property_transition*>(this), &assign_mixed, static_cast<double>(*iFrom), static_cast<double>(*iTo) };
+                return true;
+            }
+            else
+                return false;
+        }
         bool finished() const final
         {
             return iFrom == std::nullopt;
@@ -116,12 +229,21 @@ namespace neogfx
             iFrom = std::nullopt;
             iTo = std::nullopt;
             iMix = std::nullopt;
+            changed();
         }
         void sync(bool aIgnorePrevious = false) final
         {
             iFrom = aIgnorePrevious ? iProperty.iValue : iProperty.iPreviousValue;
             iTo = iProperty.iValue;
         }
+    private:
+        static void assign_mixed(void* aTarget, double aValue)
+        {
+            auto& self = *static_cast<property_transition*>(aTarget);
+            self.iMix = static_cast<value_type>(aValue);
+            neolib::scoped_flag sf{ self.iUpdatingProperty };
+            self.iProperty = self.mix();
+        }
     private:
         property_type& iProperty;
         std::optional<value_type> iFrom;
@@ -197,6 +319,11 @@ namespace neogfx
         {
             aOwner.properties().register_property(*this);
         }
+        ~property()
+        {
+            if (iDeferringBatch != nullptr)
+                iDeferringBatch->cancel(*this);
+        }
     public:
         property_variant get(const i_property& aProperty) const final
         {
@@ -438,6 +565,16 @@ namespace neogfx
                 return reinterpret_cast<void*const*>(&iCalculator);
             throw no_calculator();
         }
+        void deferred_update(bool aNotify) final
+        {
+            iDeferringBatch = nullptr;
+            std::optional<value_type> previousValue;
+            previousValue.swap(iValueBeforeDeferredUpdate);
+            if (!aNotify || *previousValue == value())
+                return;
+            iPreviousValue = std::move(previousValue);
+            update(iDeferredOwnerNotify);
+        }
     private:
         value_type& mutable_value()
         {
@@ -481,6 +618,19 @@ namespace neogfx
         }
         void update(bool aOwnerNotify = true)
         {
+            if (property_change_batch::active())
+            {
+                if (iDeferringBatch == nullptr)
+                {
+                    iDeferredOwnerNotify = aOwnerNotify;
+                    iValueBeforeDeferredUpdate = iPreviousValue;
+                    iDeferringBatch = &property_change_batch::defer(*this);
+                }
+                else
+                    iDeferredOwnerNotify = iDeferredOwnerNotify || aOwnerNotify;
+                return;
+            }
+
             destroyed_flag destroyed{ *this };
 
             if (aOwnerNotify)
@@ -488,24 +638,30 @@ namespace neogfx
             if (destroyed)
                 return;
 
-            bool const discardChanged = event_consumed(PropertyChanged.trigger(get_as_variant()));
+            // variants are only constructed if something is listening
+            bool discardChanged = false;
+            if (has_subscribers(PropertyChanged))
+                discardChanged = event_consumed(PropertyChanged.trigger(get_as_variant()));
             if (destroyed)
                 return;
 
             bool discardChangedFromTo = false;
-            if constexpr (!neolib::is_optional_v<T>)
-                discardChangedFromTo = event_consumed(PropertyChangedFromTo.trigger(property_variant{ *iPreviousValue }, get_as_variant()));
-            else
-                discardChangedFromTo = event_consumed(PropertyChangedFromTo.trigger(*iPreviousValue != std::nullopt ? property_variant{ **iPreviousValue } : property_variant{ neolib::none }, get_as_variant()));
+            if (has_subscribers(PropertyChangedFromTo))
+            {
+                if constexpr (!neolib::is_optional_v<T>)
+                    discardChangedFromTo = event_consumed(PropertyChangedFromTo.trigger(property_variant{ *iPreviousValue }, get_as_variant()));
+                else
+                    discardChangedFromTo = event_consumed(PropertyChangedFromTo.trigger(*iPreviousValue != std::nullopt ? property_variant{ **iPreviousValue } : property_variant{ neolib::none }, get_as_variant()));
+            }
             if (destroyed)
                 return;
 
-            if (!discardChanged && event_consumed(Changed.trigger(value())))
+            if (!discardChanged && has_subscribers(Changed) && event_consumed(Changed.trigger(value())))
                 return;
             if (destroyed)
                 return;
 
-            if (!discardChangedFromTo && event_consumed(ChangedFromTo.trigger(*iPreviousValue, value())))
+            if (!discardChangedFromTo && has_subscribers(ChangedFromTo) && event_consumed(ChangedFromTo.trigger(*iPreviousValue, value())))
                 return;
             if (destroyed)
                 return;
@@ -516,6 +672,9 @@ namespace neogfx
         calculator_function_type iCalculator;
         mutable value_type iValue;
         std::optional<value_type> iPreviousValue;
+        std::optional<value_type> iValueBeforeDeferredUpdate;
+        property_change_batch* iDeferringBatch = nullptr;
+        bool iDeferredOwnerNotify = false;
         bool iReadOnly = false;
         std::unique_ptr<transition_type> iTransition;
         bool iTransitionSuppressed = false;
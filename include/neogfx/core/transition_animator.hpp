@@ -20,6 +20,8 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <set>
+#include <vector>
 #include <neolib/core/jar.hpp>
 #include <neogfx/gui/widget/timer.hpp>
 #include <neogfx/core/event.hpp>
@@ -53,6 +55,9 @@ namespace neogfx
     public:
         void reset(bool aEnable = true, bool aDisableWhenFinished = false, bool aResetStartTime = true) override;
         void reset(easing aNewEasingFunction, bool aEnable = true, bool aDisableWhenFinished = false, bool aResetStartTime = true) override;
+        bool mix_handle(scalar_mix_handle& aHandle) const override;
+    protected:
+        void changed();
     private:
         i_animator& iAnimator;
         transition_id iId;
@@ -64,8 +69,26 @@ namespace neogfx
         bool iPaused;
     };
 
+    // The frame timer only runs while there are active transitions; ticks are aligned to the rendering
+    // engine's frame rate rather than running at a fixed rate. Active transitions are kept in batches, one
+    // per easing function, as parallel arrays so that each frame's mix values are evaluated a batch at a time;
+    // transitions of arithmetic properties are then assigned through their scalar_mix_handle.
     class animator : public i_animator
     {
+    private:
+        struct transition_batch
+        {
+            easing easingFunction;
+            std::vector<transition_id> ids;
+            std::vector<i_transition*> transitions;
+            std::vector<double> startTimes;
+            std::vector<double> durations;
+            std::vector<double> mixValues;
+            std::vector<void*> targets;
+            std::vector<i_transition::scalar_mix_handle::assign_function> assigns;
+            std::vector<double> froms;
+            std::vector<double> tos;
+        };
     public:
         animator();
     public:
@@ -75,13 +98,23 @@ namespace neogfx
         void stop() override;
     public:
         double animation_time() const override;
+        bool idle() const;
     protected:
         transition_id allocate_id() override;
+        void transition_changed(transition_id aTransitionId) override;
     private:
+        std::chrono::milliseconds until_next_frame() const;
+        void update_batches();
         void next_frame();
     private:
         neolib::callback_timer iTimer;
         neolib::jar<ref_ptr<i_transition>> iTransitions;
+        std::set<transition_id> iActiveTransitions;
+        std::vector<transition_batch> iBatches;
+        bool iBatchesDirty;
+        uint32_t iChanges;
+        bool iTicking;
+        bool iStopped;
         std::chrono::time_point<std::chrono::high_resolution_clock> iZeroHour;
         double iAnimationTime;
     };
@@ -156,9 +156,9 @@ namespace neogfx::game
                                     pos.x + glyphTexture.placement().x,
                                     aGc.logical_coordinates().is_game_orientation() ?
                                         pos.y + (glyphTexture.placement().y + -glyphFont.descender()) :
-                                        pos.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.texture().extents().cy,
+                                        pos.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.extents().cy,
                                     0.0);
-                                add_patch(*mf.mesh, mr, rect{ glyphOrigin, glyphTexture.texture().extents() }, glyphTexture.texture());
+                                add_patch(*mf.mesh, mr, rect{ glyphOrigin, glyphTexture.extents() }, glyphTexture.texture());
                                 mr.patches.back().material = material{ aMaterial.color, aMaterial.gradient, aMaterial.sharedTexture, mr.patches.back().material.texture, aMaterial.shaderEffect };
                             }
                             pos.x += advance(glyph).cx;
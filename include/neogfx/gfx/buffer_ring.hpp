@@ -0,0 +1,67 @@
+// buffer_ring.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2024 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <neogfx/gfx/i_fence_source.hpp>
+
+namespace neogfx
+{
+    // Divides a streaming buffer of element indices into equally sized regions which are written in turn.
+    // When writing moves on from a region a fence is inserted for it and before a region is written again
+    // its fence is waited on (a stall only if the GPU is still reading it: back-pressure).
+    class buffer_ring
+    {
+    public:
+        struct bad_region_count : std::logic_error { bad_region_count() : std::logic_error{ "neogfx::buffer_ring::bad_region_count" } {} };
+    public:
+        typedef std::size_t size_type;
+    public:
+        buffer_ring(i_fence_source& aFenceSource, size_type aCapacity, size_type aRegionCount);
+        ~buffer_ring();
+    public:
+        size_type capacity() const;
+        size_type region_count() const;
+        size_type region_size() const;
+        size_type current_region() const;
+        size_type region_begin() const;
+        size_type region_end() const;
+        size_type advances() const;
+        size_type stalls() const;
+    public:
+        void advance();
+        void resize(size_type aCapacity);
+        void wait_all();
+    private:
+        void update_current_region();
+    private:
+        i_fence_source& iFenceSource;
+        size_type iCapacity;
+        size_type iRegionSize;
+        size_type iCurrentRegion;
+        size_type iRegionBegin;
+        size_type iRegionEnd;
+        std::vector<i_fence_source::fence> iFences;
+        bool iResized;
+        size_type iAdvances;
+        size_type iStalls;
+    };
+}
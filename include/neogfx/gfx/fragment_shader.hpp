@@ -188,6 +188,7 @@ namespace neogfx
         cache_uniform(uGlyphRenderOutput)
         cache_uniform(uGlyphSubpixel)
         cache_uniform(uGlyphSubpixelFormat)
+        cache_uniform(uGlyphSdf)
         cache_uniform(uGlyphEnabled)
     };
 
@@ -201,15 +202,12 @@ namespace neogfx
         bool stipple_active() const override;
         void clear_stipple() override;
         void set_stipple(scalar aFactor, uint16_t aPattern, scalar aPosition = 0.0) override;
-        void start(const i_rendering_context& aContext, const vec3& aFrom) override;
-        void next(const i_rendering_context& aContext, const vec3& aFrom, scalar aPositionOffset) override;
     private:
         scalar iPosition;
     private:
         cache_uniform(uStippleFactor)
         cache_uniform(uStipplePattern)
         cache_uniform(uStipplePosition)
-        cache_uniform(uStippleVertex)
         cache_uniform(uStippleEnabled)
     };
 
@@ -0,0 +1,39 @@
+// i_fence_source.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2024 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+
+namespace neogfx
+{
+    // Source of GPU fences (e.g. glFenceSync); abstracted so that ring bookkeeping can be driven without a GPU.
+    class i_fence_source
+    {
+    public:
+        typedef void* fence;
+    public:
+        virtual ~i_fence_source() = default;
+    public:
+        virtual fence insert_fence() = 0;
+        virtual bool fence_signalled(fence aFence) = 0;
+        virtual void wait_fence(fence aFence) = 0;
+        virtual void delete_fence(fence aFence) = 0;
+    };
+}
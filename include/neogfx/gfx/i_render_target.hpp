@@ -48,6 +48,10 @@ namespace neogfx
         struct already_active : std::logic_error { already_active() : std::logic_error("neogfx::i_render_target::already_active") {} };
         struct not_active : std::logic_error { not_active() : std::logic_error("neogfx::i_render_target::not_active") {} };
         struct logical_coordinates_not_specified : std::logic_error { logical_coordinates_not_specified() : std::logic_error("neogfx::i_render_target::logical_coordinates_not_specified") {} };
+    public:
+        // receives aRect.cx * aRect.cy RGBA8 pixels, row by row starting with row aRect.y (aRect is the requested rect with its
+        // extents rounded as they were for the read); aPixels is nullptr if the read failed
+        typedef std::function<void(const rect& aRect, const avec4u8* aPixels)> read_pixels_callback;
     public:
         virtual render_target_type target_type() const = 0;
         virtual void* target_handle() const = 0;
@@ -71,6 +75,8 @@ namespace neogfx
     public:
         virtual neogfx::color_space color_space() const = 0;
         virtual color read_pixel(const point& aPosition) const = 0;
+        virtual void read_pixels(const rect& aRect, avec4u8* aPixels) const = 0;
+        virtual void read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const = 0;
     public:
         virtual std::unique_ptr<i_rendering_context> create_graphics_context(blending_mode aBlendingMode = blending_mode::Default) const = 0;
     };
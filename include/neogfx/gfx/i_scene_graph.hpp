@@ -396,7 +396,7 @@ namespace neogfx
             typedef i_orthographic_camera abstract_type;
         public:
             virtual scalar xmag() const = 0;
-            virtual scalar xmag() const = 0;
+            virtual scalar ymag() const = 0;
             virtual scalar zfar() const = 0;
             virtual scalar znear() const = 0;
         };
@@ -39,5 +39,9 @@ namespace neogfx
         virtual i_sub_texture& create_sub_texture(const i_image& aImage) = 0;
         virtual i_sub_texture& create_sub_texture(const i_image& aImage, const rect& aImagePart) = 0;
         virtual void destroy_sub_texture(i_sub_texture& aSubTexture) = 0;
+    public:
+        virtual uint32_t page_count() const = 0;
+        virtual uint32_t sub_texture_count() const = 0;
+        virtual double occupancy() const = 0;
     };
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 #include <vector>
 #include <unordered_map>
 #include <optional>
+#include <future>
 #include <neogfx/core/event.hpp>
 #include <neogfx/gfx/i_image.hpp>
 
@@ -56,6 +57,8 @@ namespace neogfx
         image(image const& aOther, texture_sampling aSampling);
         image(image&& aOther, texture_sampling aSampling);
         ~image();
+    public:
+        static std::future<ref_ptr<i_image>> load_async(std::string const& aUri, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap, neogfx::color_space aColorSpace = neogfx::color_space::sRGB);
     public:
         bool available() const override;
         bool downloading() const override;
@@ -0,0 +1,115 @@
+// line_geometry.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <optional>
+#include <neogfx/core/geometrical.hpp>
+
+namespace neogfx
+{
+    // Conversion of lines to the quads (as pairs of triangles) that the rendering context draws for them.
+
+    inline vertices line_loop_to_lines(const vertices& aLineLoop, bool aClosed = true)
+    {
+        vertices result;
+        result.reserve(aLineLoop.size() * 2);
+        for (auto v = aLineLoop.begin(); v != aLineLoop.end(); ++v)
+        {
+            result.push_back(*v);
+            if (v != aLineLoop.begin() && (aClosed || v != std::prev(aLineLoop.end())))
+                result.push_back(*v);
+        }
+        if (aClosed)
+            result.push_back(*aLineLoop.begin());
+        return result;
+    }
+
+    inline vertices line_strip_to_lines(const vertices& aLineStrip, bool aClosed = true)
+    {
+        return line_loop_to_lines(aLineStrip, false);
+    }
+
+    inline quad line_to_quad(const vec3& aStart, const vec3& aEnd, double aLineWidth)
+    {
+        auto const vecLine = aEnd - aStart;
+        auto const length = vecLine.magnitude();
+        auto const halfWidth = aLineWidth / 2.0;
+        auto const v1 = vec3{ -halfWidth, -halfWidth, 0.0 };
+        auto const v2 = vec3{ -halfWidth, halfWidth, 0.0 };
+        auto const v3 = vec3{ length + halfWidth, halfWidth, 0.0 };
+        auto const v4 = vec3{ length + halfWidth, -halfWidth, 0.0 };
+        auto const r = rotation_matrix(vec3{ 1.0, 0.0, 0.0 }, vecLine);
+        return quad{ aStart + r * v1, aStart + r * v2, aStart + r * v3, aStart + r * v4 };
+    }
+
+    template <typename VerticesIn, typename VerticesOut>
+    inline void lines_to_quads(const VerticesIn& aLines, double aLineWidth, VerticesOut& aQuads)
+    {
+        for (auto v = aLines.begin(); v != aLines.end(); v += 2)
+        {
+            quad const q = line_to_quad(v[0], v[1], aLineWidth);
+            aQuads.insert(aQuads.end(), q.begin(), q.end());
+        }
+    }
+
+    template <typename VerticesIn, typename VerticesOut>
+    inline void quads_to_triangles(const VerticesIn& aQuads, VerticesOut& aTriangles)
+    {
+        for (auto v = aQuads.begin(); v != aQuads.end(); v += 4)
+        {
+            aTriangles.push_back(v[0]);
+            aTriangles.push_back(v[1]);
+            aTriangles.push_back(v[2]);
+            aTriangles.push_back(v[0]);
+            aTriangles.push_back(v[3]);
+            aTriangles.push_back(v[2]);
+        }
+    }
+
+    // Cumulative distance along the lines at each vertex of quads (as two triangles) created with lines_to_quads and
+    // quads_to_triangles; passed to the stipple shader in function3.w and interpolated across each quad so that a
+    // whole stippled run of lines is a single draw. If aLoop then the gaps between the end of one line and the start of
+    // the next count. A quad extends half the line width beyond each end of its line; that overlap is not counted so
+    // the stipple pattern continues unbroken from one line of a strip to the next.
+    template <typename Vertices>
+    inline void stipple_distances(const Vertices& aTriangles, std::vector<float>& aDistances, bool aLoop = false)
+    {
+        aDistances.resize(aTriangles.size());
+        scalar distance = 0.0;
+        std::optional<vec3> previousLineEnd;
+        for (std::size_t quad = 0; quad + 6u <= aTriangles.size(); quad += 6u)
+        {
+            auto const start = midpoint(aTriangles[quad], aTriangles[quad + 1u]);
+            auto const end = midpoint(aTriangles[quad + 4u], aTriangles[quad + 2u]);
+            auto const quadLength = start.distance(end);
+            auto const halfWidth = std::min(aTriangles[quad].distance(aTriangles[quad + 1u]) / 2.0, quadLength / 2.0);
+            auto const lineLength = quadLength - halfWidth * 2.0;
+            auto const lineStart = (quadLength != 0.0 ? start + (end - start) * (halfWidth / quadLength) : start);
+            if (aLoop && previousLineEnd)
+                distance += lineStart.distance(*previousLineEnd);
+            aDistances[quad] = aDistances[quad + 1u] = aDistances[quad + 3u] = static_cast<float>(distance);
+            aDistances[quad + 2u] = aDistances[quad + 4u] = aDistances[quad + 5u] = static_cast<float>(distance + quadLength);
+            distance += lineLength;
+            previousLineEnd = (quadLength != 0.0 ? end - (end - start) * (halfWidth / quadLength) : end);
+        }
+    }
+}
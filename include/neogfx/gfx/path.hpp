@@ -34,6 +34,12 @@ namespace neogfx
         ConvexPolygon
     };
 
+    enum class fill_rule : uint32_t
+    {
+        NonZero,
+        EvenOdd
+    };
+
     template <typename PointType>
     class basic_path
     {
@@ -83,11 +89,11 @@ namespace neogfx
         typedef std::vector<intersect> intersect_list;
         // construction
     public:
-        basic_path(path_shape aShape = path_shape::ConvexPolygon, sub_paths_size_type aPathCountHint = 0) : iShape(aShape)
+        basic_path(path_shape aShape = path_shape::ConvexPolygon, sub_paths_size_type aPathCountHint = 0) : iShape(aShape), iFillRule(neogfx::fill_rule::NonZero)
         {
             iSubPaths.reserve(aPathCountHint);
         }
-        basic_path(const mesh_type& aRect, path_shape aShape = path_shape::ConvexPolygon) : iShape(aShape)
+        basic_path(const mesh_type& aRect, path_shape aShape = path_shape::ConvexPolygon) : iShape(aShape), iFillRule(neogfx::fill_rule::NonZero)
         {
             move_to(aRect.top_left());
             line_to(aRect.top_right());
@@ -105,6 +111,14 @@ namespace neogfx
         { 
             iShape = aShape; 
         }
+        neogfx::fill_rule fill_rule() const
+        {
+            return iFillRule;
+        }
+        void set_fill_rule(neogfx::fill_rule aFillRule)
+        {
+            iFillRule = aFillRule;
+        }
         point_type position() const 
         { 
             return iPosition; 
@@ -232,9 +246,12 @@ namespace neogfx
         }
         mesh_type bounding_rect(bool aOffsetPosition = true, size_type aPixelWidthAdjustment = size_type{}) const;
         clip_rect_list clip_rects(const point& aOrigin) const;
+        std::size_t outline_hash() const;
+        bool same_outline(const sub_paths_type& aSubPaths) const;
         // attributes
     private:
         path_shape iShape;
+        neogfx::fill_rule iFillRule;
         point_type iPosition;
         std::optional<point_type> iPointFrom;
         sub_paths_type iSubPaths;
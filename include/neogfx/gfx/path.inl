@@ -54,6 +54,37 @@ namespace neogfx
         return std::get<2>(*iBoundingRect);
     }
 
+    template <typename PointType>
+    inline std::size_t basic_path<PointType>::outline_hash() const
+    {
+        auto const combine = [](std::size_t& aSeed, std::size_t aValue)
+        {
+            aSeed ^= aValue + 0x9e3779b9u + (aSeed << 6) + (aSeed >> 2);
+        };
+        std::size_t seed = 0u;
+        for (auto const& subPath : iSubPaths)
+        {
+            combine(seed, subPath.size());
+            for (auto const& point : subPath)
+            {
+                combine(seed, std::hash<coordinate_type>{}(point.x));
+                combine(seed, std::hash<coordinate_type>{}(point.y));
+            }
+        }
+        return seed;
+    }
+
+    template <typename PointType>
+    inline bool basic_path<PointType>::same_outline(const sub_paths_type& aSubPaths) const
+    {
+        if (iSubPaths.size() != aSubPaths.size())
+            return false;
+        for (std::size_t i = 0u; i < iSubPaths.size(); ++i)
+            if (iSubPaths[i].size() != aSubPaths[i].size() || !std::equal(iSubPaths[i].begin(), iSubPaths[i].end(), aSubPaths[i].begin()))
+                return false;
+        return true;
+    }
+
     namespace
     {
         template <typename PointType>
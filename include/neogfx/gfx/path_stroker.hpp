@@ -0,0 +1,68 @@
+// path_stroker.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <memory>
+#include <neogfx/core/geometrical.hpp>
+#include <neogfx/core/lru_cache.hpp>
+#include <neogfx/gfx/path.hpp>
+#include <neogfx/gfx/pen.hpp>
+
+namespace neogfx
+{
+    struct stroked_path
+    {
+        vertices vertices; // triangle strip relative to path position; strips of each line joined by degenerate triangles
+        std::vector<float> distances; // distance along the line of each vertex (for stippling)
+    };
+
+    // Outlines the lines of a Lines, LineStrip or LineLoop path with the pen's width, joins and caps. Each line
+    // becomes one triangle strip so adjacent segments neither overlap nor leave gaps at the joins. Results for
+    // small paths are cached by outline, shape and pen geometry; large paths (e.g. plots) are regenerated.
+    class path_stroker
+    {
+    public:
+        typedef std::shared_ptr<const stroked_path> result_type;
+    public:
+        static constexpr scalar MiterLimit = 4.0; // as SVG
+        static constexpr std::size_t MaxCachedPathSize = 4096u;
+    private:
+        struct cache_key
+        {
+            path_shape shape;
+            dimension width;
+            line_join join;
+            line_cap cap;
+            path::sub_paths_type subPaths;
+        };
+    public:
+        path_stroker(std::size_t aCacheCapacity = 256u);
+    public:
+        static bool strokable(const path& aPath);
+        static stroked_path stroke(const path& aPath, const pen& aPen);
+    public:
+        result_type operator()(const path& aPath, const pen& aPen);
+        std::size_t cache_size() const;
+        void clear_cache();
+    private:
+        lru_cache<cache_key, result_type> iCache;
+    };
+}
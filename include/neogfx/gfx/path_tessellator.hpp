@@ -0,0 +1,61 @@
+// path_tessellator.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <memory>
+#include <neogfx/core/geometrical.hpp>
+#include <neogfx/core/lru_cache.hpp>
+#include <neogfx/gfx/path.hpp>
+
+namespace neogfx
+{
+    struct tessellated_path
+    {
+        vertices vertices; // relative to path position
+        std::vector<uint32_t> indices; // triangle list
+    };
+
+    // Triangulates the interior of a path with its fill rule; every sub-path is treated as a closed polygon so
+    // concave, self-intersecting and holed paths are filled correctly. The plane is swept in horizontal slabs
+    // split at each vertex and edge crossing and every interior span of a slab becomes a trapezoid. Results
+    // are cached by path outline (not position) so that static paths such as vector icons are tessellated once.
+    class path_tessellator
+    {
+    public:
+        typedef std::shared_ptr<const tessellated_path> result_type;
+    private:
+        struct cache_key
+        {
+            neogfx::fill_rule fillRule;
+            path::sub_paths_type subPaths;
+        };
+    public:
+        path_tessellator(std::size_t aCacheCapacity = 256u);
+    public:
+        static tessellated_path tessellate(const path& aPath);
+    public:
+        result_type operator()(const path& aPath);
+        std::size_t cache_size() const;
+        void clear_cache();
+    private:
+        lru_cache<cache_key, result_type> iCache;
+    };
+}
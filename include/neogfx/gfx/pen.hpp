@@ -25,27 +25,47 @@
 
 namespace neogfx
 {
+    enum class line_join : uint32_t
+    {
+        Miter,
+        Round,
+        Bevel
+    };
+
+    enum class line_cap : uint32_t
+    {
+        Butt,
+        Square,
+        Round
+    };
+
     class pen
     {
     public:
         // construction
     public:
-        pen() : iWidth{ 0.0 } {}
-        pen(const color& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased } {}
-        pen(const color& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased } {}
-        pen(const gradient& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased } {}
-        pen(const gradient& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased } {}
-        pen(const color_or_gradient& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased } {}
-        pen(const color_or_gradient& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased } {}
+        pen() : iWidth{ 0.0 }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const color& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const color& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const gradient& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const gradient& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const color_or_gradient& aColor, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ 1.0 }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
+        pen(const color_or_gradient& aColor, dimension aWidth, bool aAntiAliased = true) : iColor{ aColor }, iWidth{ aWidth }, iAntiAliased{ aAntiAliased }, iJoin{ line_join::Miter }, iCap{ line_cap::Square } {}
         // operations
     public:
         const color_or_gradient& color() const { return iColor; }
         dimension width() const { return iWidth; }
         bool anti_aliased() const { return iAntiAliased; }
+        line_join join() const { return iJoin; }
+        line_cap cap() const { return iCap; }
+        pen with_join(line_join aJoin) const { pen result = *this; result.iJoin = aJoin; return result; }
+        pen with_cap(line_cap aCap) const { pen result = *this; result.iCap = aCap; return result; }
     private:
         color_or_gradient iColor;
         dimension iWidth;
         bool iAntiAliased;
+        line_join iJoin;
+        line_cap iCap;
     };
 
     typedef std::optional<pen> optional_pen;
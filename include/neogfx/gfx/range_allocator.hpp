@@ -0,0 +1,83 @@
+// range_allocator.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2024 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <array>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+namespace neogfx
+{
+    // Sub-allocator for ranges of element indices [start, end) within a linear buffer; it does not own any
+    // storage so it can be exercised without a graphics context. Free ranges are kept in size-segregated
+    // (power of two) lists with a bitmap of non-empty classes and are coalesced with their neighbours when
+    // deallocated, so allocate and deallocate are O(1) (plus a bounded good-fit scan of one class).
+    class range_allocator
+    {
+    public:
+        struct bad_range : std::logic_error { bad_range() : std::logic_error{ "neogfx::range_allocator::bad_range" } {} };
+    public:
+        typedef std::size_t size_type;
+        struct statistics
+        {
+            size_type freeSize;
+            size_type freeRangeCount;
+            size_type largestFreeRange;
+            double fragmentation;
+        };
+    public:
+        range_allocator();
+    public:
+        bool empty() const;
+        size_type free_size() const;
+        size_type free_range_count() const;
+        size_type largest_free_range() const;
+        double fragmentation() const;
+        statistics stats() const;
+    public:
+        std::optional<size_type> allocate(size_type aCount);
+        void deallocate(size_type aStart, size_type aEnd);
+        void clear();
+    private:
+        static constexpr size_type npos = static_cast<size_type>(-1);
+        static constexpr std::size_t kClassCount = sizeof(size_type) * 8u;
+        struct free_range
+        {
+            size_type start;
+            size_type end;
+            size_type previous;
+            size_type next;
+        };
+    private:
+        static std::size_t size_class(size_type aSize);
+        size_type insert(size_type aStart, size_type aEnd);
+        void remove(size_type aRange);
+    private:
+        std::vector<free_range> iRanges;
+        std::vector<size_type> iUnusedRanges;
+        std::array<size_type, kClassCount> iClassHeads;
+        std::uint64_t iNonEmptyClasses;
+        std::unordered_map<size_type, size_type> iByStart;
+        std::unordered_map<size_type, size_type> iByEnd;
+        size_type iFreeSize;
+    };
+}
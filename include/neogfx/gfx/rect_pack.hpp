@@ -1,6 +1,7 @@
 // rect_pack.hpp
 /*
- *  Based on public domain code @ http://blackpawn.com/texts/lightmaps/default.html.
+ *  Originally based on public domain code @ http://blackpawn.com/texts/lightmaps/default.html;
+ *  now a MaxRects packer as described in "A Thousand Ways to Pack the Bin" (Jukka Jylanki).
  *
  *  This implementation written by Leigh Johnston.
  *
@@ -34,60 +35,39 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <boost/pool/pool_alloc.hpp>
+#include <vector>
 #include <neogfx/core/geometrical.hpp>
 
 #pragma once
 
 namespace neogfx
 {
+    // MaxRects bin packer (best short side fit); unlike a guillotine split tree space given back
+    // via remove() is returned to the free list and can be reused by later insertions.
     class rect_pack
     {
     private:
-        class node
-        {
-        public:
-            typedef boost::fast_pool_allocator<node, boost::default_user_allocator_new_delete, boost::details::pool::null_mutex> allocator_type;
-        public:
-            node(const rect& aRect, allocator_type& aAllocator) :
-                iAllocator{ aAllocator }, iInUse { false }, iChildren{}, iRect{ aRect }
-            {
-            }
-            ~node()
-            {
-                if (iChildren[0] != nullptr)
-                {
-                    iAllocator.destroy(iChildren[0]);
-                    iAllocator.deallocate(iChildren[0]);
-                }
-                if (iChildren[1] != nullptr)
-                {
-                    iAllocator.destroy(iChildren[1]);
-                    iAllocator.deallocate(iChildren[1]);
-                }
-            }
-        public:
-            bool is_leaf() const 
-            {
-                return iChildren[0] == nullptr;
-            }
-            const neogfx::rect& rect() const
-            {
-                return iRect;
-            }
-            node* insert(const size& aElementSize);
-        private:
-            allocator_type& iAllocator;
-            bool iInUse;
-            std::array<node*, 2> iChildren;
-            neogfx::rect iRect;
-        };
+        typedef std::vector<rect> free_list;
     public:
         rect_pack(const size& aDimensions);
+    public:
+        const size& dimensions() const;
+        bool empty() const;
+        std::size_t count() const;
+        dimension used_area() const;
+        double occupancy() const;
     public:
         bool insert(const size& aElementSize, rect& aResult);
+        void remove(const rect& aElement);
+        void clear();
+    private:
+        free_list::size_type split_free_rects(const rect& aUsed);
+        void merge_last_free_rect();
+        void prune_free_rects(free_list::size_type aFirstNew);
     private:
-        node::allocator_type iAllocator;
-        node iRoot;
+        size iDimensions;
+        free_list iFree;
+        std::size_t iCount;
+        dimension iUsedArea;
     };
 }
\ No newline at end of file
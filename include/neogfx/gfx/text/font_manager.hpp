@@ -24,6 +24,7 @@
 #include <set>
 #include <neolib/core/jar.hpp>
 #include <neolib/core/string_ci.hpp>
+#include <boost/functional/hash.hpp>
 #include <neogfx/gfx/texture_atlas.hpp>
 #include <neogfx/gfx/text/emoji_atlas.hpp>
 #include <neogfx/gfx/text/i_font_manager.hpp>
@@ -33,6 +34,7 @@ typedef struct FT_LibraryRec_* FT_Library;
 namespace neogfx
 {
     class native_font;
+    class native_font_face;
 
     class fallback_font_info : public i_fallback_font_info
     {
@@ -50,6 +52,15 @@ namespace neogfx
         friend class native_font_face;
     private:
         typedef std::list<native_font> native_font_list;
+        struct sdf_glyph
+        {
+            i_sub_texture const* texture;
+            point placement; // at SdfReferencePixelSize
+            std::vector<native_font_face const*> users; // faces holding a glyph texture scaled from this one
+            uint64_t lastUsed;
+        };
+        typedef std::tuple<i_native_font const*, neogfx::font_style, uint32_t> sdf_glyph_key;
+        typedef std::unordered_map<sdf_glyph_key, sdf_glyph, boost::hash<sdf_glyph_key>> sdf_glyph_cache;
         typedef std::map<string, std::vector<native_font_list::iterator>, neolib::ci_less> font_family_list;
         typedef font id_cache_entry;
         typedef neolib::small_jar<id_cache_entry> id_cache;
@@ -58,6 +69,10 @@ namespace neogfx
         struct error_initializing_font_library : std::runtime_error { error_initializing_font_library() : std::runtime_error("neogfx::font_manager::error_initializing_font_library") {} };
         struct no_matching_font_found : std::runtime_error { no_matching_font_found() : std::runtime_error("neogfx::font_manager::no_matching_font_found") {} };
         struct failed_to_allocate_glyph_space : std::runtime_error { failed_to_allocate_glyph_space() : std::runtime_error("neogfx::font_manager::failed_to_allocate_glyph_space") {} };
+    public:
+        static constexpr uint32_t SdfReferencePixelSize = 64u;
+        static constexpr std::size_t GlyphCacheCapacity = 8192u;
+        static constexpr std::size_t SdfGlyphCacheCapacity = 2048u;
     public:
         font_manager();
         ~font_manager();
@@ -97,6 +112,10 @@ namespace neogfx
         i_texture_atlas& glyph_atlas() override;
         const i_emoji_atlas& emoji_atlas() const override;
         i_emoji_atlas& emoji_atlas() override;
+    public:
+        neogfx::glyph_rendering_mode glyph_rendering_mode() const override;
+        void set_glyph_rendering_mode(neogfx::glyph_rendering_mode aMode) override;
+        void trim_glyph_cache() override;
     protected:
         void add_ref(font_id aId) override;
         void release(font_id aId) override;
@@ -118,5 +137,8 @@ namespace neogfx
         std::unique_ptr<i_glyph_text_factory> iGlyphTextFactory;
         texture_atlas iGlyphAtlas;
         neogfx::emoji_atlas iEmojiAtlas;
+        neogfx::glyph_rendering_mode iGlyphRenderingMode = neogfx::glyph_rendering_mode::Bitmap;
+        std::size_t iGlyphCount = 0u;
+        sdf_glyph_cache iSdfGlyphs;
     };
 }
\ No newline at end of file
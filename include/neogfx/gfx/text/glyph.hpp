@@ -494,6 +494,7 @@ namespace neogfx
     }
 
     typedef std::optional<glyph_text> optional_glyph_text;
+    typedef std::shared_ptr<const glyph_text> shared_glyph_text;
 
     class i_graphics_context;
 
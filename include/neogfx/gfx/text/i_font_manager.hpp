@@ -43,6 +43,12 @@ namespace neogfx
         Widget
     };
 
+    enum class glyph_rendering_mode : uint32_t
+    {
+        Bitmap,                 // one rasterised bitmap per glyph per font size
+        SignedDistanceField     // one distance field per glyph per font face rendered at any scale
+    };
+
     class i_fallback_font_info
     {
     public:
@@ -97,6 +103,11 @@ namespace neogfx
         virtual i_texture_atlas& glyph_atlas() = 0;
         virtual const i_emoji_atlas& emoji_atlas() const = 0;
         virtual i_emoji_atlas& emoji_atlas() = 0;
+    public:
+        virtual neogfx::glyph_rendering_mode glyph_rendering_mode() const = 0;
+        virtual void set_glyph_rendering_mode(neogfx::glyph_rendering_mode aMode) = 0;
+        // called by the rendering engine between frames, when no glyphs are waiting to be drawn
+        virtual void trim_glyph_cache() = 0;
     public:
         bool has_font(std::string const& aFamily, std::string const& aStyle) const
         {
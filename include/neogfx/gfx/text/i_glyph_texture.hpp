@@ -35,7 +35,8 @@ namespace neogfx
         Gray = Gray8Bit,
         LCD,
         LCD_V,
-        BGRA
+        BGRA,
+        SDF
     };
 
     class i_glyph_texture
@@ -47,5 +48,15 @@ namespace neogfx
         virtual bool subpixel() const = 0;
         virtual const point& placement() const = 0;
         virtual glyph_pixel_mode pixel_mode() const = 0;
+        virtual scalar scale() const = 0;
+    public:
+        bool sdf() const
+        {
+            return pixel_mode() == glyph_pixel_mode::SDF;
+        }
+        size extents() const
+        {
+            return texture().extents() * scale();
+        }
     };
 }
\ No newline at end of file
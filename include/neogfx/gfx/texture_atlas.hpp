@@ -21,8 +21,6 @@
 
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
-#include <set>
-#include <tuple>
 #include "i_texture_atlas.hpp"
 #include "i_texture_manager.hpp"
 #include "texture.hpp"
@@ -33,34 +31,14 @@ namespace neogfx
 {
     class i_native_texture;
 
+    // Sub-textures are packed into pages; space given back by destroy_sub_texture() is reused and a page left empty
+    // has its packer reset (or is released if it is not the only page). The atlas does not evict or move sub-textures
+    // itself as their locations may be referenced by vertices waiting to be drawn; owners such as font_manager evict
+    // between frames instead.
     class texture_atlas : public i_texture_atlas
     {
     private:
-        struct fragments
-        {
-            struct fragment_less_than
-            {
-                bool operator()(const rect& aLhs, const rect& aRhs) const
-                {
-                    return std::forward_as_tuple(aLhs.width() * aLhs.height(), aLhs.top_left()) <
-                        std::forward_as_tuple(aRhs.width() * aRhs.height(), aRhs.top_left());
-                }
-            };
-            rect_pack pack;
-            std::set<rect, fragment_less_than> used;
-            std::set<rect, fragment_less_than> freed; // todo: use this when bin pack is full
-            bool insert(const size& aSize, rect& aResult)
-            {
-                if (pack.insert(aSize, aResult))
-                {
-                    used.insert(aResult);
-                    return true;
-                }
-                else
-                    return false;
-            }
-        };
-        typedef std::pair<texture, fragments> page;
+        typedef std::pair<texture, rect_pack> page;
         typedef std::list<page> pages;
         typedef std::pair<pages::iterator, neogfx::sub_texture> entry;
         typedef std::unordered_map<texture_id, entry> entries;
@@ -73,6 +51,10 @@ namespace neogfx
         i_sub_texture& create_sub_texture(const i_image& aImage) override;
         i_sub_texture& create_sub_texture(const i_image& aImage, const rect& aImagePart) override;
         void destroy_sub_texture(i_sub_texture& aSubTexture) override;
+    public:
+        uint32_t page_count() const override;
+        uint32_t sub_texture_count() const override;
+        double occupancy() const override;
     private:
         const size& page_size() const;
         pages::iterator create_page(dimension aDpiScaleFactor, texture_sampling aSampling, texture_data_format aDataFormat);
@@ -0,0 +1,58 @@
+// texture_upload_queue.hpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <cstddef>
+#include <neogfx/core/geometrical.hpp>
+
+namespace neogfx
+{
+    // CPU staging for texture sub-image uploads so a texture can apply a batch of writes in one pass. It has
+    // no graphics API dependency: uploads wholly overwritten by a later one are dropped and an upload is
+    // merged into an earlier one when their union is exactly a rectangle and no upload in between overlaps it.
+    class texture_upload_queue
+    {
+    public:
+        typedef std::size_t size_type;
+        struct upload
+        {
+            rect_u32 rect;
+            std::vector<std::byte> pixels; // tightly packed rows, first row is rect.y
+        };
+        typedef std::vector<upload> upload_list;
+    public:
+        texture_upload_queue(size_type aBytesPerPixel);
+    public:
+        size_type bytes_per_pixel() const;
+        bool empty() const;
+        size_type pending_bytes() const;
+        upload_list const& uploads() const;
+    public:
+        void enqueue(rect_u32 const& aRect, void const* aPixels, uint32_t aUnpackAlignment = 4u);
+        void clear();
+    private:
+        bool merge(upload& aTarget, upload& aAddition) const;
+    private:
+        size_type iBytesPerPixel;
+        upload_list iUploads;
+        size_type iPendingBytes;
+    };
+}
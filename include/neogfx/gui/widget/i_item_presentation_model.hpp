@@ -211,7 +211,8 @@ namespace neogfx
             item_cell_selection_flags selection = item_cell_selection_flags::None;
             button_checked_state checked = false;
             bool expanded = false;
-            optional_glyph_text text;
+            uint32_t textCacheSlot = 0u; // shaped text is held in a bounded cache...
+            uint32_t textCacheGeneration = 0u; // ...and is only valid while the slot's generation matches (zero if never cached)
             optional_size extents;
         };
         class i_meta_visitor
@@ -224,6 +225,11 @@ namespace neogfx
             Ascending,
             Descending
         };
+        enum class column_width_policy
+        {
+            Exact,      // measure every cell in the column
+            Sampled     // measure a sample of cells and refine as other cells are measured (e.g. when painted)
+        };
         typedef std::optional<sort_direction> optional_sort_direction;
         typedef std::pair<item_presentation_model_index::column_type, sort_direction> sort_by_param;
         typedef std::optional<sort_by_param> optional_sort_by_param;
@@ -271,6 +277,8 @@ namespace neogfx
     public:
         virtual void accept(i_meta_visitor& aVisitor, bool aIgnoreCollapsedState = false) = 0;
     public:
+        virtual column_width_policy width_policy() const = 0;
+        virtual void set_width_policy(column_width_policy aPolicy) = 0;
         virtual dimension column_width(item_presentation_model_index::column_type aColumnIndex, i_units_context const& aUnitsContext, bool aExtendIntoPadding = true) const = 0;
         virtual std::string const& column_heading_text(item_presentation_model_index::column_type aColumnIndex) const = 0;
         virtual size column_heading_extents(item_presentation_model_index::column_type aColumnIndex, i_units_context const& aUnitsContext) const = 0;
@@ -324,7 +332,9 @@ namespace neogfx
         virtual optional_size cell_check_box_size(item_presentation_model_index const& aIndex, i_units_context const& aUnitsContext) const = 0;
         virtual optional_size cell_tree_expander_size(item_presentation_model_index const& aIndex, i_units_context const& aUnitsContext) const = 0;
         virtual optional_texture cell_image(item_presentation_model_index const& aIndex) const = 0;
-        virtual neogfx::glyph_text& cell_glyph_text(item_presentation_model_index const& aIndex) const = 0;
+        virtual shared_glyph_text cell_glyph_text(item_presentation_model_index const& aIndex) const = 0;
+        virtual std::size_t glyph_text_cache_capacity() const = 0;
+        virtual void set_glyph_text_cache_capacity(std::size_t aCapacity) = 0;
         virtual size cell_extents(item_presentation_model_index const& aIndex, i_units_context const& aUnitsContext) const = 0;
         virtual dimension indent(item_presentation_model_index const& aIndex, i_units_context const& aUnitsContext) const = 0;
     public:
@@ -22,6 +22,8 @@
 #include <neogfx/neogfx.hpp>
 #include <vector>
 #include <deque>
+#include <algorithm>
+#include <functional>
 #include <boost/algorithm/string.hpp>
 #include <neolib/core/vecarray.hpp>
 #include <neolib/core/segmented_array.hpp>
@@ -78,6 +80,12 @@ namespace neogfx
         using typename base_type::filter_search_key;
         using typename base_type::filter_search_type;
         using typename base_type::case_sensitivity;
+        using typename base_type::column_width_policy;
+    public:
+        static constexpr item_presentation_model_index::row_type ColumnWidthSampleSize = 1000u;
+        static constexpr item_presentation_model_index::row_type ColumnWidthLeadingRows = 100u;
+        static constexpr std::size_t ColumnWidthLongestCells = 16u;
+        static constexpr std::size_t MinimumGlyphTextCacheCapacity = 1024u;
     private:
         typedef ItemModel item_model_type;
         typedef typename item_model_type::container_traits::template rebind<item_model_index::row_type, cell_meta_type, true>::other container_traits;
@@ -99,6 +107,10 @@ namespace neogfx
             mutable item_model_index::optional_column_type modelColumn;
             item_cell_flags flags = item_cell_flags::Default;
             mutable std::map<dimension, uint32_t> cellWidths;
+            mutable bool widthMeasured = false;
+            mutable bool widthSampled = false;
+            mutable bool widthChangePending = false;
+            mutable dimension reportedWidth = 0.0;
             mutable std::optional<std::string> headingText;
             mutable font headingFont;
             mutable optional_size headingExtents;
@@ -119,6 +131,15 @@ namespace neogfx
             }
         };
         typedef typename container_traits::template rebind<item_presentation_model_index::row_type, column_info>::other::row_cell_array column_info_array;
+        static constexpr uint32_t NoGlyphTextCacheSlot = ~0u;
+        struct glyph_text_cache_entry
+        {
+            shared_glyph_text text; // shared so that text handed out survives eviction
+            uint32_t generation = 0u;
+            uint32_t moreRecent = NoGlyphTextCacheSlot;
+            uint32_t lessRecent = NoGlyphTextCacheSlot;
+        };
+        typedef std::vector<glyph_text_cache_entry> glyph_text_cache;
     public:
         using typename base_type::no_item_model;
         using typename base_type::bad_index;
@@ -294,15 +315,37 @@ namespace neogfx
             }
         }
     public:
+        column_width_policy width_policy() const override
+        {
+            return iColumnWidthPolicy;
+        }
+        void set_width_policy(column_width_policy aPolicy) override
+        {
+            if (iColumnWidthPolicy != aPolicy)
+            {
+                iColumnWidthPolicy = aPolicy;
+                for (item_presentation_model_index::column_type col = 0; col < iColumns.size(); ++col)
+                {
+                    if (iColumns[col].widthSampled)
+                    {
+                        iColumns[col].widthMeasured = false;
+                        ColumnInfoChanged.trigger(col);
+                    }
+                }
+            }
+        }
         dimension column_width(item_presentation_model_index::column_type aColumnIndex, i_units_context const& aUnitsContext, bool aExtendIntoPadding = true) const override
         {
             if (rows() == 0 || columns() < aColumnIndex + 1u)
                 return 0.0;
-            auto& cellWidths = column(aColumnIndex).cellWidths;
-            if (!cellWidths.empty())
-                return units_converter(aUnitsContext).from_device_units(cellWidths.rbegin()->first) + (aExtendIntoPadding ? cell_padding(aUnitsContext).size().cx : 0.0);
-            for (item_presentation_model_index::row_type row = 0u; row < rows(); ++row)
-                cell_extents(item_presentation_model_index{ row, aColumnIndex }, aUnitsContext);
+            auto& columnInfo = column(aColumnIndex);
+            if (!columnInfo.widthMeasured)
+                measure_column_width(aColumnIndex, aUnitsContext);
+            auto& cellWidths = columnInfo.cellWidths;
+            if (cellWidths.empty())
+                return 0.0;
+            columnInfo.reportedWidth = cellWidths.rbegin()->first;
+            columnInfo.widthChangePending = false;
             return units_converter(aUnitsContext).from_device_units(cellWidths.rbegin()->first) + (aExtendIntoPadding ? cell_padding(aUnitsContext).size().cx : 0.0);
         }
         std::string const& column_heading_text(item_presentation_model_index::column_type aColumnIndex) const override
@@ -847,15 +890,36 @@ namespace neogfx
         {
             return optional_texture{};
         }
-        neogfx::glyph_text& cell_glyph_text(item_presentation_model_index const& aIndex) const override
+        shared_glyph_text cell_glyph_text(item_presentation_model_index const& aIndex) const override
         {
-            if (cell_meta(aIndex).text != std::nullopt)
-                return *cell_meta(aIndex).text;
+            auto& cellMeta = cell_meta(aIndex);
+            if (cellMeta.textCacheGeneration != 0u && cellMeta.textCacheSlot < iGlyphTextCache.size() &&
+                iGlyphTextCache[cellMeta.textCacheSlot].generation == cellMeta.textCacheGeneration)
+            {
+                touch_glyph_text_cache_slot(cellMeta.textCacheSlot);
+                return iGlyphTextCache[cellMeta.textCacheSlot].text;
+            }
             auto const& cellFont = cell_font(aIndex);
             auto const& effectiveFont = (cellFont == std::nullopt ? default_font() : *cellFont);
-            cell_meta(aIndex).text = graphics_context{ attachment(), graphics_context::type::Unattached }.
-                to_glyph_text(cell_to_string(aIndex), effectiveFont);
-            return *cell_meta(aIndex).text;
+            auto const slot = allocate_glyph_text_cache_slot();
+            auto& entry = iGlyphTextCache[slot];
+            entry.text = std::make_shared<const glyph_text>(graphics_context{ attachment(), graphics_context::type::Unattached }.
+                to_glyph_text(cell_to_string(aIndex), effectiveFont));
+            entry.generation = ++iGlyphTextCacheGeneration;
+            cellMeta.textCacheSlot = slot;
+            cellMeta.textCacheGeneration = entry.generation;
+            return entry.text;
+        }
+        std::size_t glyph_text_cache_capacity() const override
+        {
+            return iGlyphTextCacheCapacity;
+        }
+        void set_glyph_text_cache_capacity(std::size_t aCapacity) override
+        {
+            aCapacity = std::max(aCapacity, MinimumGlyphTextCacheCapacity);
+            if (aCapacity < iGlyphTextCache.size())
+                clear_glyph_text_cache();
+            iGlyphTextCacheCapacity = aCapacity;
         }
         size cell_extents(item_presentation_model_index const& aIndex, i_units_context const& aUnitsContext) const override
         {
@@ -865,7 +929,7 @@ namespace neogfx
             auto& cellMeta = cell_meta(aIndex);
             if (cellMeta.extents != std::nullopt)
                 return units_converter(aUnitsContext).from_device_units(*cellMeta.extents);
-            size cellExtents = cell_glyph_text(aIndex).extents();
+            size cellExtents = cell_glyph_text(aIndex)->extents();
             auto const& cellInfo = item_model().cell_info(to_item_model_index(aIndex));
             if (cell_editable(aIndex) && cellInfo.dataStep != neolib::none)
             {
@@ -889,7 +953,14 @@ namespace neogfx
             }
             cellExtents.cy = std::max(cellExtents.cy, effectiveFont.height());
             cellMeta.extents = cellExtents.ceil();
-            column(aIndex.column()).add_cell_width(cellMeta.extents->cx);
+            auto& columnInfo = column(aIndex.column());
+            columnInfo.add_cell_width(cellMeta.extents->cx);
+            if (columnInfo.widthSampled && cellMeta.extents->cx > columnInfo.reportedWidth && !columnInfo.widthChangePending)
+            {
+                // a cell outside the sample is wider than the width reported so far
+                columnInfo.widthChangePending = true;
+                ColumnInfoChanged.async_trigger(aIndex.column());
+            }
             if (iTotalHeight != std::nullopt)
                 *iTotalHeight += (item_height(aIndex, aUnitsContext) - oldItemHeight);
             return units_converter(aUnitsContext).from_device_units(*cell_meta(aIndex).extents);
@@ -1047,26 +1118,7 @@ namespace neogfx
             ItemsSorting.trigger();
             auto sortPredicate = [&](const typename container_type::value_type& aLhs, const typename container_type::value_type& aRhs) -> bool
             {
-                for (std::size_t i = 0; i < iSortOrder.size(); ++i)
-                {
-                    auto col = iSortOrder[i].first;
-                    auto const& v1 = item_model().cell_data(item_model_index{ aLhs.value, model_column(col) });
-                    auto const& v2 = item_model().cell_data(item_model_index{ aRhs.value, model_column(col) });
-                    if (std::holds_alternative<string>(v1) && std::holds_alternative<string>(v2))
-                    {
-                        std::string s1 = boost::to_upper_copy<std::string>(std::get<string>(v1));
-                        std::string s2 = boost::to_upper_copy<std::string>(std::get<string>(v2));
-                        if (s1 < s2)
-                            return iSortOrder[i].second == sort_direction::Ascending;
-                        else if (s2 < s1)
-                            return iSortOrder[i].second == sort_direction::Descending;
-                    }
-                    if (v1 < v2)
-                        return iSortOrder[i].second == sort_direction::Ascending;
-                    else if (v2 < v1)
-                        return iSortOrder[i].second == sort_direction::Descending;
-                }
-                return false;
+                return sorts_before(aLhs, aRhs);
             };
             if constexpr (container_traits::is_flat)
                 std::sort(iRows.begin(), iRows.end(), sortPredicate);
@@ -1076,6 +1128,52 @@ namespace neogfx
             reset_position_meta(0);
             ItemsSorted.trigger();
         }
+        bool sorts_before(const typename container_type::value_type& aLhs, const typename container_type::value_type& aRhs) const
+        {
+            for (std::size_t i = 0; i < iSortOrder.size(); ++i)
+            {
+                auto col = iSortOrder[i].first;
+                auto const& v1 = item_model().cell_data(item_model_index{ aLhs.value, model_column(col) });
+                auto const& v2 = item_model().cell_data(item_model_index{ aRhs.value, model_column(col) });
+                if (std::holds_alternative<string>(v1) && std::holds_alternative<string>(v2))
+                {
+                    std::string s1 = boost::to_upper_copy<std::string>(std::get<string>(v1));
+                    std::string s2 = boost::to_upper_copy<std::string>(std::get<string>(v2));
+                    if (s1 < s2)
+                        return iSortOrder[i].second == sort_direction::Ascending;
+                    else if (s2 < s1)
+                        return iSortOrder[i].second == sort_direction::Descending;
+                }
+                if (v1 < v2)
+                    return iSortOrder[i].second == sort_direction::Ascending;
+                else if (v2 < v1)
+                    return iSortOrder[i].second == sort_direction::Descending;
+            }
+            return false;
+        }
+        // moves a single row whose sort key has changed to its sorted position (the other rows being sorted); returns its new position
+        item_presentation_model_index::row_type reposition_row(item_presentation_model_index::row_type aRow)
+        {
+            auto sortPredicate = [&](const typename container_type::value_type& aLhs, const typename container_type::value_type& aRhs) -> bool
+            {
+                return sorts_before(aLhs, aRhs);
+            };
+            auto const first = iRows.begin();
+            auto const at = std::next(first, aRow);
+            if (at != first && sortPredicate(*at, *std::prev(at)))
+            {
+                auto const to = std::upper_bound(first, at, *at, sortPredicate);
+                std::rotate(to, at, std::next(at));
+                return static_cast<item_presentation_model_index::row_type>(std::distance(first, to));
+            }
+            if (std::next(at) != iRows.end() && sortPredicate(*std::next(at), *at))
+            {
+                auto const to = std::lower_bound(std::next(at), iRows.end(), *at, sortPredicate);
+                std::rotate(at, std::next(at), to);
+                return static_cast<item_presentation_model_index::row_type>(std::distance(first, to) - 1);
+            }
+            return aRow;
+        }
         void execute_filter()
         {
             {
@@ -1166,6 +1264,14 @@ namespace neogfx
         {
             if (!has_item_model_index(aItemIndex))
                 return;
+            if constexpr (container_traits::is_flat)
+            {
+                if (!updating() && sortable() && !iSortOrder.empty())
+                {
+                    single_item_changed(aItemIndex);
+                    return;
+                }
+            }
             if (!updating())
             {
                 reset_row_map();
@@ -1176,13 +1282,49 @@ namespace neogfx
                 auto& cellMeta = cell_meta(index);
                 if (cellMeta.extents != std::nullopt)
                     col.remove_cell_width(cellMeta.extents->cx);
-                cellMeta.text = std::nullopt;
+                uncache_glyph_text(cellMeta);
                 cellMeta.extents = std::nullopt;
                 if (attached())
                     cell_extents(index, attachment());
                 ItemChanged.trigger(from_item_model_index(aItemIndex));
             }
         }
+        // re-sorts just the changed row rather than all of them; row map and positions are only patched for the rows in between
+        void single_item_changed(const item_model_index& aItemIndex)
+        {
+            auto const oldRow = from_item_model_index(aItemIndex, true).row();
+            auto const oldHeight = attached() ? item_height(item_presentation_model_index(oldRow), attachment()) : 0.0;
+            {
+                auto& cellMeta = cell_meta(item_presentation_model_index(oldRow, mapped_column(aItemIndex.column())));
+                if (cellMeta.extents != std::nullopt)
+                    column(mapped_column(aItemIndex.column())).remove_cell_width(cellMeta.extents->cx);
+                uncache_glyph_text(cellMeta);
+                cellMeta.extents = std::nullopt;
+            }
+            bool const wasMoved = iRows.size() > 1u && (
+                (oldRow > 0u && sorts_before(row(oldRow), row(oldRow - 1u))) ||
+                (oldRow + 1u < iRows.size() && sorts_before(row(oldRow + 1u), row(oldRow))));
+            auto newRow = oldRow;
+            if (wasMoved)
+            {
+                ItemsSorting.trigger();
+                newRow = reposition_row(oldRow);
+            }
+            auto const firstAffected = std::min(oldRow, newRow);
+            auto const lastAffected = std::max(oldRow, newRow);
+            for (auto affected = firstAffected; affected <= lastAffected; ++affected)
+                row_map()[row(affected).value] = affected;
+            auto const index = item_presentation_model_index(newRow, mapped_column(aItemIndex.column()));
+            if (attached())
+                cell_extents(index, attachment());
+            if (attached() && item_height(item_presentation_model_index(newRow), attachment()) == oldHeight)
+                patch_position_meta(firstAffected, lastAffected);
+            else
+                reset_position_meta(firstAffected);
+            if (wasMoved)
+                ItemsSorted.trigger();
+            ItemChanged.trigger(index);
+        }
         void item_removing(const item_model_index& aItemIndex)
         {
             if (!has_item_model_index(aItemIndex))
@@ -1193,6 +1335,7 @@ namespace neogfx
                 auto& cellMeta = cell_meta(index.with_column(col));
                 if (cellMeta.extents != std::nullopt)
                     column(col).remove_cell_width(cellMeta.extents->cx);
+                uncache_glyph_text(cellMeta);
             }
             if (!updating())
                 ItemRemoving.trigger(index);
@@ -1320,7 +1463,7 @@ namespace neogfx
                 {
                     if (aColumn != std::nullopt && col != *aColumn)
                         continue;
-                    cell_meta(item_presentation_model_index(row, col)).text = std::nullopt;
+                    uncache_glyph_text(cell_meta(item_presentation_model_index(row, col)));
                     if (cell_meta(item_presentation_model_index(row, col)).extents != std::nullopt)
                         column(col).remove_cell_width(cell_meta(item_presentation_model_index(row, col)).extents->cx);
                     cell_meta(item_presentation_model_index(row, col)).extents = std::nullopt;
@@ -1334,9 +1477,162 @@ namespace neogfx
                 if (aColumn != std::nullopt && col != *aColumn)
                     continue;
                 column(col).cellWidths.clear();
+                column(col).widthMeasured = false;
+                column(col).widthSampled = false;
+                column(col).widthChangePending = false;
+                column(col).reportedWidth = 0.0;
                 column(col).headingExtents = std::nullopt;
             }
         }
+        void measure_column_width(item_presentation_model_index::column_type aColumnIndex, i_units_context const& aUnitsContext) const
+        {
+            auto& columnInfo = column(aColumnIndex);
+            auto const rowCount = rows();
+            auto const measure = [&](item_presentation_model_index::row_type aRow)
+            {
+                cell_extents(item_presentation_model_index{ aRow, aColumnIndex }, aUnitsContext);
+            };
+            columnInfo.widthMeasured = true;
+            columnInfo.widthSampled = (iColumnWidthPolicy == column_width_policy::Sampled && rowCount > ColumnWidthSampleSize);
+            if (!columnInfo.widthSampled)
+            {
+                for (item_presentation_model_index::row_type row = 0u; row < rowCount; ++row)
+                    measure(row);
+                return;
+            }
+            // the leading rows (the ones visible initially) and the middle row of each stratum...
+            for (item_presentation_model_index::row_type row = 0u; row < ColumnWidthLeadingRows; ++row)
+                measure(row);
+            for (uint64_t stratum = 0u; stratum < ColumnWidthSampleSize; ++stratum)
+                measure(static_cast<item_presentation_model_index::row_type>((stratum * 2u + 1u) * rowCount / (ColumnWidthSampleSize * 2u)));
+            // ...and, for integers and strings, the cells with the most digits or characters which can be found without
+            // shaping any text; other cells (e.g. empty ones) are skipped
+            typedef std::pair<std::size_t, item_presentation_model_index::row_type> candidate;
+            thread_local std::vector<candidate> longest;
+            longest.clear();
+            for (item_presentation_model_index::row_type row = 0u; row < rowCount; ++row)
+            {
+                auto const length = cell_data_length(item_presentation_model_index{ row, aColumnIndex });
+                if (length == std::nullopt)
+                    continue;
+                if (longest.size() < ColumnWidthLongestCells)
+                {
+                    longest.emplace_back(*length, row);
+                    std::push_heap(longest.begin(), longest.end(), std::greater<candidate>{});
+                }
+                else if (*length > longest.front().first)
+                {
+                    std::pop_heap(longest.begin(), longest.end(), std::greater<candidate>{});
+                    longest.back() = candidate{ *length, row };
+                    std::push_heap(longest.begin(), longest.end(), std::greater<candidate>{});
+                }
+            }
+            for (auto const& cell : longest)
+                measure(cell.second);
+        }
+        std::optional<std::size_t> cell_data_length(item_presentation_model_index const& aIndex) const
+        {
+            return std::visit([](auto&& arg) -> std::optional<std::size_t>
+            {
+                typedef std::decay_t<decltype(arg)> type;
+                if constexpr (std::is_integral_v<type> && !std::is_same_v<type, bool>)
+                {
+                    std::size_t digits = 1u;
+                    if constexpr (std::is_signed_v<type>)
+                        if (arg < 0)
+                            ++digits;
+                    for (auto value = arg / 10; value != 0; value /= 10)
+                        ++digits;
+                    return digits;
+                }
+                else if constexpr (std::is_same_v<type, string>)
+                    return arg.size();
+                else
+                    return {};
+            }, item_model().cell_data(to_item_model_index(aIndex)));
+        }
+        void touch_glyph_text_cache_slot(uint32_t aSlot) const
+        {
+            if (iMostRecentGlyphText == aSlot)
+                return;
+            unlink_glyph_text_cache_slot(aSlot);
+            auto& entry = iGlyphTextCache[aSlot];
+            entry.moreRecent = NoGlyphTextCacheSlot;
+            entry.lessRecent = iMostRecentGlyphText;
+            if (iMostRecentGlyphText != NoGlyphTextCacheSlot)
+                iGlyphTextCache[iMostRecentGlyphText].moreRecent = aSlot;
+            iMostRecentGlyphText = aSlot;
+            if (iLeastRecentGlyphText == NoGlyphTextCacheSlot)
+                iLeastRecentGlyphText = aSlot;
+        }
+        void unlink_glyph_text_cache_slot(uint32_t aSlot) const
+        {
+            auto& entry = iGlyphTextCache[aSlot];
+            if (entry.moreRecent != NoGlyphTextCacheSlot)
+                iGlyphTextCache[entry.moreRecent].lessRecent = entry.lessRecent;
+            else if (iMostRecentGlyphText == aSlot)
+                iMostRecentGlyphText = entry.lessRecent;
+            if (entry.lessRecent != NoGlyphTextCacheSlot)
+                iGlyphTextCache[entry.lessRecent].moreRecent = entry.moreRecent;
+            else if (iLeastRecentGlyphText == aSlot)
+                iLeastRecentGlyphText = entry.moreRecent;
+            entry.moreRecent = NoGlyphTextCacheSlot;
+            entry.lessRecent = NoGlyphTextCacheSlot;
+        }
+        uint32_t allocate_glyph_text_cache_slot() const
+        {
+            uint32_t slot;
+            if (iGlyphTextCache.size() < iGlyphTextCacheCapacity)
+            {
+                slot = static_cast<uint32_t>(iGlyphTextCache.size());
+                iGlyphTextCache.emplace_back();
+            }
+            else
+            {
+                // evict the least recently used
+                slot = iLeastRecentGlyphText;
+                iGlyphTextCache[slot].generation = 0u;
+            }
+            touch_glyph_text_cache_slot(slot);
+            return slot;
+        }
+        void uncache_glyph_text(cell_meta_type& aCellMeta) const
+        {
+            if (aCellMeta.textCacheGeneration == 0u)
+                return;
+            if (aCellMeta.textCacheSlot < iGlyphTextCache.size() && iGlyphTextCache[aCellMeta.textCacheSlot].generation == aCellMeta.textCacheGeneration)
+            {
+                // the slot is reused first
+                auto const slot = aCellMeta.textCacheSlot;
+                auto& entry = iGlyphTextCache[slot];
+                entry.generation = 0u;
+                entry.text = nullptr;
+                if (iLeastRecentGlyphText != slot)
+                {
+                    unlink_glyph_text_cache_slot(slot);
+                    entry.moreRecent = iLeastRecentGlyphText;
+                    iGlyphTextCache[iLeastRecentGlyphText].lessRecent = slot;
+                    iLeastRecentGlyphText = slot;
+                }
+            }
+            aCellMeta.textCacheGeneration = 0u;
+        }
+        void clear_glyph_text_cache() const
+        {
+            iGlyphTextCache.clear();
+            iMostRecentGlyphText = NoGlyphTextCacheSlot;
+            iLeastRecentGlyphText = NoGlyphTextCacheSlot;
+        }
+        void patch_position_meta(item_presentation_model_index::row_type aFirstRow, item_presentation_model_index::row_type aLastRow) const
+        {
+            // rows have been permuted within the range without changing height so only positions inside it change
+            for (auto row = aFirstRow + 1u; row <= aLastRow && row < iPositions.size(); ++row)
+            {
+                if (iPositions[row - 1u] == std::nullopt || iPositions[row] == std::nullopt)
+                    break;
+                iPositions[row] = *iPositions[row - 1u] + item_height(item_presentation_model_index(row - 1u), attachment());
+            }
+        }
         void reset_position_meta(item_presentation_model_index::row_type aFromRow) const
         {
             iTotalHeight = std::nullopt;
@@ -1419,6 +1715,12 @@ namespace neogfx
         mutable row_map_type iRowMap;
         mutable item_model_index::optional_row_type iRowMapDirtyFrom;
         mutable column_info_array iColumns;
+        column_width_policy iColumnWidthPolicy = column_width_policy::Sampled;
+        mutable glyph_text_cache iGlyphTextCache;
+        mutable uint32_t iMostRecentGlyphText = NoGlyphTextCacheSlot;
+        mutable uint32_t iLeastRecentGlyphText = NoGlyphTextCacheSlot;
+        mutable uint32_t iGlyphTextCacheGeneration = 0u;
+        std::size_t iGlyphTextCacheCapacity = MinimumGlyphTextCacheCapacity;
         mutable column_map_type iColumnMap;
         mutable optional_font iDefaultFont;
         mutable std::optional<i_scrollbar::value_type> iTotalHeight;
@@ -21,9 +21,9 @@
 
 #include <neogfx/neogfx.hpp>
 #include <boost/pool/pool_alloc.hpp>
-#include <neolib/core/tag_array.hpp>
 #include <neolib/core/segmented_array.hpp>
 #include <neolib/core/indexitor.hpp>
+#include <neogfx/core/piece_table.hpp>
 #include <neogfx/app/i_clipboard.hpp>
 #include <neogfx/gfx/text/glyph.hpp>
 #include <neogfx/gui/window/context_menu.hpp>
@@ -87,6 +87,7 @@ namespace neogfx
         define_event(DefaultStyleChanged, default_style_changed)
         define_event(ContextMenu, context_menu, i_menu&)
         define_event(UriClicked, uri_clicked, i_string const&)
+        define_event(LayoutCompleted, layout_completed)
 
         // types
     private:
@@ -296,7 +297,7 @@ namespace neogfx
             tag_data iContents;
         };
 
-        typedef neolib::tag_array<tag<>, char32_t, 16, 256> document_text;
+        typedef basic_piece_table<tag<>, char32_t> document_text;
 
         class paragraph_positioned_glyph;
         typedef neolib::segmented_array<paragraph_positioned_glyph, 256> glyph_container_type;
@@ -318,8 +319,26 @@ namespace neogfx
 
         struct position_info;
 
+        struct line_update
+        {
+            document_glyphs::size_type glyphStart;
+            document_glyphs::size_type oldGlyphEnd;
+            glyph_paragraphs::iterator first;
+            glyph_paragraphs::iterator last;
+        };
+        struct line_layout
+        {
+            dimension availableWidth;
+            bool wordWrap;
+            dimension height;
+        };
+
     private:
         class dragger;
+    private:
+        static constexpr std::size_t BACKGROUND_LAYOUT_THRESHOLD = 0x10000u;
+        static constexpr std::size_t LAYOUT_CHUNK_SIZE = 0x4000u;
+        static constexpr std::chrono::milliseconds LAYOUT_TIME_SLICE{ 8 };
 
     public:
         typedef document_text::size_type position_type;
@@ -431,6 +450,7 @@ namespace neogfx
     public:
         void clear();
         std::size_t paragraph_count() const;
+        bool layout_complete() const;
         void delete_paragraph(std::size_t aParagraphIndex);
         i_string const& text() const;
         std::size_t set_text(i_string const& aText);
@@ -494,8 +514,20 @@ namespace neogfx
         document_glyphs::const_iterator to_glyph(document_text::const_iterator aWhere) const;
         std::pair<document_text::size_type, document_text::size_type> from_glyph(document_glyphs::const_iterator aWhere) const;
         void refresh_paragraph(document_text::const_iterator aWhere, ptrdiff_t aDelta);
+        void refresh_all_paragraphs(document_text::size_type aPriorityPosition);
+        glyph_paragraphs::iterator shape_paragraphs(document_text::size_type aTextStart, document_text::size_type aTextEnd, glyph_paragraphs::iterator aWhere, document_glyphs::size_type aGlyphPosition);
+        void position_paragraph_glyphs(glyph_paragraphs::iterator aFirst, glyph_paragraphs::iterator aLast);
+        void clear_paragraph_caches();
+        document_text::size_type first_visible_character() const;
+        document_text::size_type layout_chunk_end(document_text::size_type aStart) const;
+        void continue_layout(document_text::size_type aUntil);
         void refresh_columns();
         void refresh_lines();
+        void invalidate_lines(std::optional<line_update> const& aUpdate = {});
+        bool update_lines();
+        void update_text_extents();
+        dimension line_layout_width(size const& aTextExtents) const;
+        coordinate layout_paragraph(glyph_paragraphs::iterator aParagraph, glyph_column const& aColumn, coordinate aTop, dimension aAvailableWidth, std::optional<dimension> const& aPreviousLineHeight, glyph_lines& aLines);
         void animate();
         void update_cursor();
         void make_cursor_visible(bool aForcePreviewScroll = false);
@@ -525,6 +557,9 @@ namespace neogfx
         glyph_paragraphs iGlyphParagraphs;
         glyph_columns iGlyphColumns;
         optional_size iTextExtents;
+        std::optional<document_text::size_type> iLayoutPending;
+        std::optional<line_layout> iLineLayout;
+        std::optional<line_update> iLineUpdate;
         uint64_t iCursorAnimationStartTime;
         typedef std::pair<position_type, position_type> find_span;
         typedef std::map<
@@ -549,6 +584,7 @@ namespace neogfx
         uint32_t iWantedToNotfiyTextChanged;
         std::optional<std::pair<text_edit::position_type, text_edit::position_type>> iSelectedUri;
         bool iOutOfMemory;
+        bool iCursorVisibilityPending;
     public:
         define_property(property_category::other, bool, ReadOnly, read_only, false)
         define_property(property_category::other, bool, WordWrap, word_wrap, (iCaps & text_edit_caps::MultiLine) == text_edit_caps::MultiLine)
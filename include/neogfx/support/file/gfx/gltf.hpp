@@ -21,15 +21,28 @@
 
 #include <neogfx/neogfx.hpp>
 #include <vector>
+#include <map>
 #include <variant>
 #include <optional>
 #include <string>
+#include <cstring>
 #include <neogfx/core/numerical.hpp>
+#include <neogfx/app/i_resource.hpp>
+#include <neogfx/gfx/i_scene_graph.hpp>
+#include <neogfx/game/mesh.hpp>
 
 namespace neogfx::file
 {
     class gltf
     {
+    public:
+        struct failed_to_open_file : std::runtime_error { failed_to_open_file(std::string const& aUri) : std::runtime_error{ "neogfx::file::gltf::failed_to_open_file: " + aUri } {} };
+        struct invalid_file : std::runtime_error { invalid_file() : std::runtime_error{ "neogfx::file::gltf::invalid_file" } {} };
+        struct unsupported_version : std::runtime_error { unsupported_version() : std::runtime_error{ "neogfx::file::gltf::unsupported_version" } {} };
+        struct unsupported_accessor : std::runtime_error { unsupported_accessor() : std::runtime_error{ "neogfx::file::gltf::unsupported_accessor" } {} };
+        struct accessor_type_mismatch : std::logic_error { accessor_type_mismatch() : std::logic_error{ "neogfx::file::gltf::accessor_type_mismatch" } {} };
+        struct accessor_out_of_bounds : std::runtime_error { accessor_out_of_bounds() : std::runtime_error{ "neogfx::file::gltf::accessor_out_of_bounds" } {} };
+        struct vertex_index_out_of_bounds : std::runtime_error { vertex_index_out_of_bounds() : std::runtime_error{ "neogfx::file::gltf::vertex_index_out_of_bounds" } {} };
     public:
         struct asset
         {
@@ -38,35 +51,146 @@ namespace neogfx::file
             std::string generator;
             std::string copyright;
         };
+        struct buffer
+        {
+            ref_ptr<i_resource> resource; // mapped file holding the buffer
+            std::size_t resourceOffset;
+            std::vector<uint8_t> decoded; // storage for data URIs
+            std::size_t byteLength;
+
+            // derived on access so that copies of the buffer never point into another buffer's storage
+            uint8_t const* data() const
+            {
+                if (resource)
+                    return static_cast<uint8_t const*>(resource->cdata()) + resourceOffset;
+                return decoded.data();
+            }
+        };
+        struct buffer_view
+        {
+            std::optional<std::string> name;
+            std::size_t buffer;
+            std::size_t byteOffset;
+            std::size_t byteLength;
+            std::optional<std::size_t> byteStride;
+            std::optional<scene_graph::buffer_view_target> target;
+        };
+        struct accessor
+        {
+            std::optional<std::string> name;
+            std::optional<std::size_t> bufferView;
+            std::size_t byteOffset;
+            scene_graph::accessor_component_type componentType;
+            bool normalized;
+            std::size_t count;
+            scene_graph::accessor_type type;
+            bool sparse;
+        };
+        // Strided view of accessor elements in place in their (memory mapped) buffer; elements are
+        // copied out on access as glTF only guarantees component alignment.
+        template <typename T>
+        class accessor_view
+        {
+        public:
+            typedef T value_type;
+        public:
+            accessor_view(uint8_t const* aData, std::size_t aCount, std::size_t aStride) :
+                iData{ aData }, iCount{ aCount }, iStride{ aStride }
+            {
+            }
+        public:
+            bool empty() const
+            {
+                return iCount == 0;
+            }
+            std::size_t size() const
+            {
+                return iCount;
+            }
+            std::size_t stride() const
+            {
+                return iStride;
+            }
+            uint8_t const* data() const
+            {
+                return iData;
+            }
+            value_type operator[](std::size_t aIndex) const
+            {
+                value_type result;
+                std::memcpy(&result, iData + aIndex * iStride, sizeof(value_type));
+                return result;
+            }
+        private:
+            uint8_t const* iData;
+            std::size_t iCount;
+            std::size_t iStride;
+        };
         typedef mat44 matrix_transform;
         typedef struct { vec3 translation; vec4 rotation; vec3 scale; } trs_transform;
         typedef std::variant<matrix_transform, trs_transform> local_transform;
+        struct primitive
+        {
+            std::map<scene_graph::vertex_attribute, std::size_t> attributes;
+            std::optional<std::size_t> indices;
+            std::optional<std::size_t> material;
+            scene_graph::rendering_mode mode;
+        };
         struct mesh
         {
-
+            std::optional<std::string> name;
+            std::vector<primitive> primitives;
+            std::vector<scalar> weights;
         };
         struct camera
         {
         };
-        struct node;
-        typedef std::vector<node*> nodes;
         struct node
         {
             std::optional<std::string> name;
-            std::optional<nodes> children;
+            std::vector<std::size_t> children;
             std::optional<local_transform> transform;
-            mesh const* mesh;
-            camera const* camera;
+            std::optional<std::size_t> mesh;
+            std::optional<std::size_t> camera;
         };
         struct scene
         {
-            nodes nodes;
+            std::optional<std::string> name;
+            std::vector<std::size_t> nodes;
         };
-        typedef std::vector<scene> scenes;
     public:
-        gltf(std::string const& aUri) {}
+        gltf(std::string const& aUri);
+    public:
+        template <typename T>
+        accessor_view<T> view(std::size_t aAccessor) const
+        {
+            auto const& a = accessors.at(aAccessor);
+            if (sizeof(T) != element_size(a))
+                throw accessor_type_mismatch();
+            return accessor_view<T>{ element_data(a), a.count, element_stride(a) };
+        }
+        game::mesh to_mesh(std::size_t aMesh, std::size_t aPrimitive = 0) const;
+    public:
+        static std::size_t component_size(scene_graph::accessor_component_type aComponentType);
+        static std::size_t component_count(scene_graph::accessor_type aType);
+        static std::size_t element_size(accessor const& aAccessor);
+    private:
+        std::size_t element_stride(accessor const& aAccessor) const;
+        uint8_t const* element_data(accessor const& aAccessor) const;
+        std::size_t max_index(std::size_t aAccessor) const;
+        void validate(primitive const& aPrimitive) const;
+        void parse(std::string const& aUri, char const* aJson, std::size_t aJsonLength, uint8_t const* aBinaryChunk, std::size_t aBinaryChunkLength);
     public:
-        scenes scenes;
-        std::shared_ptr<scene> displayScene;
+        gltf::asset asset;
+        std::vector<buffer> buffers;
+        std::vector<buffer_view> bufferViews;
+        std::vector<accessor> accessors;
+        std::vector<mesh> meshes;
+        std::vector<camera> cameras;
+        std::vector<node> nodes;
+        std::vector<scene> scenes;
+        std::optional<std::size_t> displayScene;
+    private:
+        ref_ptr<i_resource> iResource;
     };
-}
\ No newline at end of file
+}
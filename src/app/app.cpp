@@ -23,7 +23,6 @@
 #include <filesystem>
 #include <boost/locale.hpp> 
 #include <neolib/file/file.hpp>
-#include <neolib/file/xml.hpp>
 #include <neolib/core/scoped.hpp>
 #include <neolib/core/string_utils.hpp>
 #include <neolib/task/event.hpp>
@@ -161,6 +160,7 @@ namespace neogfx
         iApp.plugin_manager().unload_plugins();
         iApp.async_task::cancel();
         teardown_service<i_animator>();
+        teardown_service<i_resource_manager>();
         teardown_service<i_gradient_manager>();
         teardown_service<i_rendering_engine>();
         app* tp = &iApp;
@@ -456,74 +456,117 @@ namespace neogfx
 
     void app::clear_translations()
     {
+        iActiveTranslations = nullptr;
         iTranslations.clear();
     }
 
     void app::load_translations()
     {
-        for (auto const& file : std::filesystem::directory_iterator{ std::filesystem::path{ neolib::program_directory() } })
-            if (file.path().extension() == ".xneol")
-                load_translations(file.path());
+        // compiled catalogues (.neolc, see nrc -translations) are preferred; of a compiled catalogue and the .xneol file it
+        // was compiled from only the newer is loaded
+        std::filesystem::path const programDirectory{ neolib::program_directory() };
+        for (auto const& file : std::filesystem::directory_iterator{ programDirectory })
+        {
+            if (file.path().extension() == ".neolc")
+            {
+                auto source = file.path();
+                source.replace_extension(".xneol");
+                if (!std::filesystem::exists(source))
+                    load_translations(file.path());
+                else if (std::filesystem::last_write_time(file.path()) >= std::filesystem::last_write_time(source) && !load_translations(file.path()))
+                    load_translations(source); // corrupt compiled catalogue
+            }
+            else if (file.path().extension() == ".xneol")
+            {
+                auto compiled = file.path();
+                compiled.replace_extension(".neolc");
+                if (!std::filesystem::exists(compiled) || std::filesystem::last_write_time(compiled) < std::filesystem::last_write_time(file.path()))
+                    load_translations(file.path());
+            }
+        }
     }
 
-    void app::load_translations(std::filesystem::path const& aTranslationFile)
+    bool app::load_translations(std::filesystem::path const& aTranslationFile)
     {
-        neolib::xml translationFile{ aTranslationFile.generic_string() };
-        if (translationFile.root().name() == "xneol")
+        translation_file newFile;
+        std::string language;
+        if (aTranslationFile.extension() == ".neolc")
         {
-            auto const& language = translationFile.root().attribute_value("trgLang").to_std_string();
-            for (auto const& item : translationFile.root())
+            // memory-mapped by the resource manager
+            auto const path = aTranslationFile.generic_string();
+            newFile.compiledFile = service<i_resource_manager>().load_resource("file://" + std::string{ !path.empty() && path[0] == '/' ? "" : "/" } + path);
+            if (newFile.compiledFile->is_empty())
+                return false;
+            try
             {
-                if (item.name() == "text")
-                {
-                    std::optional<std::string> source;
-                    std::vector<std::pair<std::pair<std::int64_t, std::int64_t>, std::string>> targets;
-                    for (auto const& part : item)
-                    {
-                        if (part.name() == "source")
-                            source = part.text();
-                        else if (part.name() == "target")
-                        {
-                            auto plurality = std::make_pair(std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max());
-                            if (part.has_attribute("n"))
-                            {
-                                auto const& n = part.attribute_value("n").to_std_string();
-                                neolib::vecarray<std::string, 2> bits;
-                                neolib::tokens(n, ".."s, bits, 2, false, true);
-                                if (bits.size() == 1)
-                                    plurality.second = (plurality.first = boost::lexical_cast<std::int64_t>(bits[0]));
-                                else if (bits.size() == 2)
-                                {
-                                    if (!bits[0].empty())
-                                        plurality.first = boost::lexical_cast<std::int64_t>(bits[0]);
-                                    if (!bits[1].empty())
-                                        plurality.second = boost::lexical_cast<std::int64_t>(bits[1]);
-                                }
-                            }
-                            targets.push_back(std::make_pair(plurality, part.text()));
-                        }
-                    }
-                    if (source)
-                        for (auto const& target : targets)
-                            iTranslations[language][source.value()][target.first] = target.second;
-                }
+                newFile.catalogue.emplace(newFile.compiledFile->cdata(), newFile.compiledFile->size());
             }
+            catch (translation_catalogue::bad_catalogue const& e)
+            {
+                service<debug::logger>() << "neogfx::app::load_translations: " << aTranslationFile.generic_string() << ": " << e.what() << endl;
+                return false;
+            }
+            language = newFile.catalogue->language();
+        }
+        else
+        {
+            translation_catalogue_builder builder;
+            if (!builder.parse_xneol(aTranslationFile.generic_string()))
+                return false;
+            newFile.compiled = builder.build();
+            language = builder.language();
         }
+        // files for the same language are merged: translate() searches the most recently loaded first
+        auto& entry = iTranslations[language].emplace_back(std::move(newFile));
+        if (!entry.compiled.empty())
+            entry.catalogue.emplace(entry.compiled.data(), entry.compiled.size());
+        update_active_translations();
+        return true;
+    }
+
+    std::string const& app::language() const
+    {
+        return iLanguage;
+    }
+
+    void app::set_language(std::string const& aLanguage)
+    {
+        iLanguage = aLanguage;
+        update_active_translations();
+    }
+
+    void app::update_active_translations()
+    {
+        auto existing = iTranslations.find(iLanguage);
+        if (existing == iTranslations.end())
+            existing = iTranslations.begin();
+        iActiveTranslations = (existing != iTranslations.end() ? &existing->second : nullptr);
     }
 
     i_string const& app::translate(i_string const& aTranslatableString, i_string const& aContext, std::int64_t aPlurality) const
     {
-        if (iTranslations.empty())
+        if (iActiveTranslations == nullptr)
             return aTranslatableString;
-        /// @todo select language
-        /// @todo context
-        auto existing = iTranslations.begin()->second.find(aTranslatableString);
-        if (existing == iTranslations.begin()->second.end())
+        auto const find = [&](std::string_view const& aContext) -> i_string const*
+        {
+            for (auto file = iActiveTranslations->rbegin(); file != iActiveTranslations->rend(); ++file)
+            {
+                auto const target = file->catalogue->find(aContext, aTranslatableString.to_std_string_view(), aPlurality);
+                if (!target)
+                    continue;
+                auto existingText = file->targetText.find(*target);
+                if (existingText == file->targetText.end())
+                    existingText = file->targetText.emplace(*target, string{ std::string{ file->catalogue->text(*target) } }).first;
+                return &existingText->second;
+            }
+            return nullptr;
+        };
+        auto target = find(aContext.to_std_string_view());
+        if (target == nullptr && !aContext.empty())
+            target = find({});
+        if (target == nullptr)
             return aTranslatableString;
-        for (auto const& target : existing->second)
-            if (aPlurality >= target.first.first && aPlurality <= target.first.second)
-                return target.second;
-        return existing->second.begin()->second;
+        return *target;
     }
 
     i_action& app::action_file_new()
@@ -19,11 +19,12 @@
 
 #include <neogfx/neogfx.hpp>
 #include <neogfx/app/clipboard.hpp>
+#include <neogfx/app/data_payload.hpp>
 #include "native/i_native_clipboard.hpp"
 
 namespace neogfx
 {
-    clipboard::clipboard(i_native_clipboard& aSystemClipboard) : iSystemClipboard(aSystemClipboard), iActiveSink(nullptr)
+    clipboard::clipboard(i_native_clipboard& aSystemClipboard) : iSystemClipboard(aSystemClipboard), iActiveSink(nullptr), iPayloadSequenceNumber(0u)
     {
     }
 
@@ -62,7 +63,25 @@ namespace neogfx
 
     i_string const& clipboard::text() const
     {
-       return iSystemClipboard.text();
+        // text copied within this process is read from its payload rather than back from the system clipboard
+        if (payload_current() && iPayload->mime_type().to_std_string_view() == TextPlainMimeType)
+        {
+            if (iPayloadText == std::nullopt)
+            {
+                iPayloadText.emplace();
+                if (iPayload->shared())
+                    iPayloadText->assign(static_cast<char const*>(iPayload->shared_data()), static_cast<std::size_t>(iPayload->size()));
+                else
+                {
+                    auto reader = iPayload->open();
+                    char chunk[4096];
+                    for (std::size_t read; (read = reader->read(chunk, sizeof(chunk))) != 0u;)
+                        iPayloadText->append(chunk, read);
+                }
+            }
+            return *iPayloadText;
+        }
+        return iSystemClipboard.text();
     }
 
     void clipboard::set_text(i_string const& aText)
@@ -85,6 +104,34 @@ namespace neogfx
         iSystemClipboard.set_image(aImage);
     }
 
+    bool clipboard::has_payload(i_string const& aMimeType) const
+    {
+        if (payload_current() && iPayload->mime_type().to_std_string_view() == aMimeType.to_std_string_view())
+            return true;
+        if (aMimeType.to_std_string_view() == TextPlainMimeType)
+            return has_text();
+        return false;
+    }
+
+    void clipboard::payload(i_string const& aMimeType, i_ref_ptr<i_data_payload>& aPayload) const
+    {
+        if (payload_current() && iPayload->mime_type().to_std_string_view() == aMimeType.to_std_string_view())
+            aPayload = iPayload;
+        else if (aMimeType.to_std_string_view() == TextPlainMimeType && has_text())
+            aPayload = ref_ptr<i_data_payload>{ make_ref<shared_buffer_payload>(TextPlainMimeType, text().to_std_string()) };
+        else
+            throw no_payload();
+    }
+
+    void clipboard::set_payload(i_ref_ptr<i_data_payload> const& aPayload)
+    {
+        // only take ownership of the payload once the system clipboard has accepted it
+        iSystemClipboard.set_payload(*aPayload);
+        iPayload = aPayload;
+        iPayloadText = std::nullopt;
+        iPayloadSequenceNumber = iSystemClipboard.sequence_number();
+    }
+
     void clipboard::cut()
     {
         if (sink_active())
@@ -114,4 +161,9 @@ namespace neogfx
         if (sink_active())
             active_sink().select_all();
     }
+
+    bool clipboard::payload_current() const
+    {
+        return iPayload && iPayloadSequenceNumber == iSystemClipboard.sequence_number();
+    }
 }
\ No newline at end of file
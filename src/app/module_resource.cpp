@@ -61,22 +61,28 @@ namespace neogfx
 
     bool module_resource::is_empty() const
     {
-        return size() != 0;
+        return size() == 0;
     }
 
     const void* module_resource::cdata() const
     {
+        if (iWritableData)
+            return iWritableData->data();
         return iData;
     }
 
     const void* module_resource::data() const
     {
-        return iData;
+        return cdata();
     }
 
     void* module_resource::data()
     {
-        throw const_data();
+        // module data is read-only so it is only copied if a caller wants to modify it
+        if (!iWritableData)
+            iWritableData.emplace(static_cast<const uint8_t*>(iData), static_cast<const uint8_t*>(iData) + iSize);
+        iHash = std::nullopt;
+        return iWritableData->data();
     }
 
     std::size_t module_resource::size() const
@@ -21,6 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <neogfx/gfx/image.hpp>
+#include <neogfx/app/i_data_payload.hpp>
 
 namespace neogfx
 {
@@ -40,5 +41,7 @@ namespace neogfx
         virtual bool has_image() const = 0;
         virtual neogfx::image image() const = 0;
         virtual void set_image(const neogfx::image& aImage) = 0;
+        virtual void set_payload(i_data_payload const& aPayload) = 0;
+        virtual uint32_t sequence_number() const = 0; // changes whenever the system clipboard contents change
     };
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include <neolib/core/string_utils.hpp>
 #include <neogfx/hid/display.hpp>
 #include <neogfx/app/i_app.hpp>
+#include <neogfx/app/data_payload.hpp>
 #include "../../hid/native/windows_display.hpp"
 #include "i_native_clipboard.hpp"
 #include "windows_basic_services.hpp"
@@ -259,6 +260,59 @@ namespace neogfx
                     throw failed_to_open_clipboard();
 #endif // todo
             }
+            void set_payload(i_data_payload const& aPayload) override
+            {
+                if (aPayload.mime_type().to_std_string_view() != TextPlainMimeType)
+                    throw unsupported_clipboard_operation();
+                // the payload is converted to UTF-16 a chunk at a time directly into the clipboard's memory block
+                std::size_t const chunkSize = 64u * 1024u;
+                std::size_t capacity = (aPayload.size_known() ? static_cast<std::size_t>(aPayload.size()) : chunkSize) + 1u;
+                auto hMem = ::GlobalAlloc(GMEM_MOVEABLE, capacity * sizeof(char16_t));
+                if (!hMem)
+                    throw failed_to_set_clipboard_data();
+                std::size_t length = 0u;
+                auto const append = [&](std::u16string const& aText)
+                {
+                    if (length + aText.size() + 1u > capacity)
+                    {
+                        capacity = std::max(capacity * 2u, length + aText.size() + 1u);
+                        auto const hNewMem = ::GlobalReAlloc(hMem, capacity * sizeof(char16_t), GMEM_MOVEABLE);
+                        if (!hNewMem)
+                        {
+                            ::GlobalFree(hMem);
+                            throw failed_to_set_clipboard_data();
+                        }
+                        hMem = hNewMem;
+                    }
+                    auto const dst = reinterpret_cast<char16_t*>(::GlobalLock(hMem));
+                    std::copy(aText.begin(), aText.end(), dst + length);
+                    length += aText.size();
+                    dst[length] = u'\0';
+                    ::GlobalUnlock(hMem);
+                };
+                append({});
+                read_utf16(aPayload, append, chunkSize);
+                if (::OpenClipboard(NULL))
+                {
+                    ::EmptyClipboard();
+                    if (!SetClipboardData(CF_UNICODETEXT, hMem))
+                    {
+                        ::CloseClipboard();
+                        ::GlobalFree(hMem);
+                        throw failed_to_set_clipboard_data();
+                    }
+                    ::CloseClipboard();
+                }
+                else
+                {
+                    ::GlobalFree(hMem);
+                    throw failed_to_open_clipboard();
+                }
+            }
+            uint32_t sequence_number() const override
+            {
+                return static_cast<uint32_t>(::GetClipboardSequenceNumber());
+            }
         };
 
         bool basic_services::has_system_clipboard() const
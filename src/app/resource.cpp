@@ -18,65 +18,44 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <sstream>
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <openssl/sha.h>
 #include <neolib/io/uri.hpp>
-#include <neolib/file/zip.hpp>
 #include <neogfx/app/resource.hpp>
 
 namespace neogfx
 {
-    resource::resource(i_resource_manager& aManager, std::string const& aUri) : 
-        iManager{aManager}, iUri{aUri}, iSize{0}
+    namespace
     {
-        neolib::uri uri{aUri};
-        if (uri.scheme() == "file")
+        struct mapped_file
         {
-            if (uri.fragment().empty()) // individual asset file
-            { 
-                iData.resize(static_cast<std::size_t>(boost::filesystem::file_size(uri.path())));
-                std::ifstream input(uri.path(), std::ios::binary | std::ios::in);
-                input.read(reinterpret_cast<char*>(data()), iData.size());
-                iSize = iData.size();
-            }
-            else // asset archive
+            boost::interprocess::file_mapping file;
+            boost::interprocess::mapped_region region;
+            mapped_file(std::string const& aPath) :
+                file{ aPath.c_str(), boost::interprocess::read_only },
+                region{ file, boost::interprocess::copy_on_write }
             {
-                neolib::zip archive{uri.path()};
-                for (std::size_t i = 0; i < archive.file_count(); ++i)
-                {
-                    if (archive.file_path(i) == uri.fragment())
-                    {
-                        archive.extract_to(i, iData.as_std_vector());
-                        iSize = iData.size();
-                    }
-                }
             }
-        }
-        else if (uri.scheme().empty())
-        {
-            if (!uri.fragment().empty()) // asset archive
+        };
+    }
+
+    resource::resource(i_resource_manager& aManager, std::string const& aUri) : 
+        iManager{aManager}, iUri{aUri}, iSize{0}
+    {
+        // archive entries (URIs with a fragment) are extracted by the resource manager which keeps the archive index
+        neolib::uri uri{aUri};
+        if (uri.scheme() == "file" && uri.fragment().empty()) // individual asset file
+        { 
+            auto const fileSize = static_cast<std::size_t>(boost::filesystem::file_size(uri.path()));
+            if (fileSize != 0)
             {
-                auto assetArchive = aManager.load_resource(string{ ":/" + uri.path() });
-                neolib::zip archive{assetArchive->cdata(), assetArchive->size()};
-                for (std::size_t i = 0; i < archive.file_count(); ++i)
-                {
-                    if (archive.file_path(i) == uri.fragment())
-                    {
-                        archive.extract_to(i, iData.as_std_vector());
-                        iSize = iData.size();
-                    }
-                    else
-                    {
-                        neolib::uri otherResource(uri);
-                        otherResource.set_fragment(archive.file_path(i));
-                        std::ostringstream oss;
-                        oss << otherResource;
-                        neolib::zip::buffer_type buffer;
-                        archive.extract_to(i, buffer);
-                        aManager.add_resource(string{ oss.str() }, & buffer[0], buffer.size());
-                    }
-                }
+                // map rather than read the file; copy-on-write so data() stays writable without modifying the file
+                auto mapping = std::make_shared<mapped_file>(uri.path());
+                iMappedData = mapping->region.get_address();
+                iMapping = mapping;
+                iSize = fileSize;
             }
         }
     }
@@ -86,6 +65,11 @@ namespace neogfx
     {
     }
 
+    resource::resource(i_resource_manager& aManager, std::string const& aUri, data_type&& aData) :
+        iManager{aManager}, iUri{aUri}, iSize{aData.size()}, iData{std::move(aData)}
+    {
+    }
+
     resource::~resource()
     {
         iManager.cleanup();
@@ -93,12 +77,12 @@ namespace neogfx
 
     bool resource::available() const
     {
-        return iSize != 0 && iData.size() == iSize;
+        return iSize != 0 && (iMappedData != nullptr || iData.size() == iSize);
     }
 
     bool resource::downloading() const
     {
-        if (iSize == 0)
+        if (iSize == 0 || iMappedData != nullptr)
             return false;
         else if (iData.size() != iSize)
             return true;
@@ -110,6 +94,8 @@ namespace neogfx
     {
         if (iSize == 0)
             return 0.0;
+        else if (iMappedData != nullptr)
+            return 100.0;
         else if (iData.size() != iSize)
             return 100.0 * iData.size() / iSize;
         else
@@ -136,11 +122,13 @@ namespace neogfx
 
     bool resource::is_empty() const
     {
-        return iData.empty();
+        return size() == 0;
     }
     
     const void* resource::cdata() const
     {
+        if (iMappedData != nullptr)
+            return iMappedData;
         if (iData.empty())
             throw no_data();
         return &iData[0];
@@ -158,6 +146,8 @@ namespace neogfx
 
     std::size_t resource::size() const
     {
+        if (iMappedData != nullptr)
+            return iSize;
         return iData.size();
     }
 
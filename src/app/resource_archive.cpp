@@ -0,0 +1,57 @@
+// resource_archive.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/app/resource_archive.hpp>
+
+namespace neogfx
+{
+    resource_archive::resource_archive(ref_ptr<i_resource> const& aArchive) :
+        iArchive{ aArchive }, iZip{ aArchive->cdata(), aArchive->size() }
+    {
+        iIndex.reserve(iZip.file_count());
+        for (std::size_t i = 0; i < iZip.file_count(); ++i)
+            iIndex.emplace(iZip.file_path(i), i);
+    }
+
+    i_resource const& resource_archive::archive() const
+    {
+        return *iArchive;
+    }
+
+    std::size_t resource_archive::entry_count() const
+    {
+        return iIndex.size();
+    }
+
+    bool resource_archive::contains(std::string const& aEntryPath) const
+    {
+        return iIndex.find(aEntryPath) != iIndex.end();
+    }
+
+    void resource_archive::extract(std::string const& aEntryPath, buffer_type& aBuffer) const
+    {
+        auto existing = iIndex.find(aEntryPath);
+        if (existing == iIndex.end())
+            throw entry_not_found(aEntryPath);
+        // entries may be extracted from several loader threads at once
+        std::scoped_lock<std::mutex> lock{ iMutex };
+        iZip.extract_to(existing->second, aBuffer);
+    }
+}
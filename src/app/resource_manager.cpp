@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <zlib.h>
 #include <neolib/io/uri.hpp>
 #include <neogfx/app/resource_manager.hpp>
 #include <neogfx/app/module_resource.hpp>
@@ -28,10 +29,27 @@ template<> neogfx::i_resource_manager& services::start_service<neogfx::i_resourc
     return neogfx::resource_manager::instance();
 }
 
+template<> void services::teardown_service<neogfx::i_resource_manager>()
+{
+    neogfx::resource_manager::instance().stop_loading();
+}
+
 namespace neogfx
 {    
-    resource_manager::resource_manager()
+    namespace
+    {
+        std::size_t const kDefaultArchiveEntryCacheCapacity = 32u * 1024u * 1024u;
+    }
+
+    resource_manager::resource_manager() :
+        iArchiveEntryCacheCapacity{ kDefaultArchiveEntryCacheCapacity }
+    {
+    }
+
+    resource_manager::~resource_manager()
     {
+        stop_loading();
+        clean();
     }
     
     resource_manager& resource_manager::instance()
@@ -42,6 +60,7 @@ namespace neogfx
 
     void resource_manager::merge(i_resource_manager& aResourceManager)
     {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
         for (auto const& r : aResourceManager.resources())
             iResources.insert(r.first(), r.second());
         for (auto const& ra : aResourceManager.resource_archives())
@@ -50,15 +69,61 @@ namespace neogfx
 
     void resource_manager::add_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize)
     {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
         iResources.insert(aUri, decltype(iResources)::mapped_type{ ref_ptr<i_resource>{ make_ref<resource>(*this, aUri, aResourceData, aResourceSize) } });
     }
 
     void resource_manager::add_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize)
     {
-        iResources.insert(aUri, decltype(iResources)::mapped_type{ ref_ptr<i_resource>{ make_ref<resource>(*this, aUri, aResourceData, aResourceSize) } });
+        // module resources live for the lifetime of the module so no copy of the data is required
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        iResources.insert(aUri, decltype(iResources)::mapped_type{ ref_ptr<i_resource>{ make_ref<module_resource>(aUri.to_std_string(), aResourceData, aResourceSize) } });
+    }
+
+    void resource_manager::add_compressed_module_resource(i_string const& aUri, const void* aResourceData, std::size_t aResourceSize, std::size_t aUncompressedSize)
+    {
+        std::vector<uint8_t> uncompressed(aUncompressedSize);
+        uLongf uncompressedSize = static_cast<uLongf>(aUncompressedSize);
+        if (::uncompress(uncompressed.data(), &uncompressedSize, static_cast<const Bytef*>(aResourceData), static_cast<uLong>(aResourceSize)) != Z_OK ||
+            uncompressedSize != aUncompressedSize)
+            throw bad_compressed_resource(aUri.to_std_string());
+        add_resource(aUri, uncompressed.data(), uncompressed.size());
     }
 
     void resource_manager::load_resource(i_string const& aUri, i_ref_ptr<i_resource>& aResult)
+    {
+        // the lock is only held to look up and insert; files are mapped and archive entries extracted without it
+        {
+            std::lock_guard<std::recursive_mutex> lock{ iMutex };
+            if (find_resource(aUri, aResult))
+                return;
+            if (neolib::uri{ aUri }.scheme().empty() && iResources.as_std_map().find(aUri.to_std_string_view().substr(0, aUri.to_std_string_view().rfind('#'))) == iResources.as_std_map().end())
+                throw embedded_resource_not_found(aUri);
+        }
+        neolib::uri const uri{ aUri };
+        bool const archiveEntry = !uri.fragment().empty() && (uri.scheme() == "file" || uri.scheme().empty());
+        ref_ptr<i_resource> newResource;
+        if (archiveEntry)
+        {
+            auto& entryArchive = archive(aUri.to_std_string().substr(0, aUri.to_std_string_view().rfind('#')));
+            resource::data_type entryData;
+            if (entryArchive.contains(uri.fragment()))
+                entryArchive.extract(uri.fragment(), entryData.as_std_vector());
+            newResource = make_ref<resource>(*this, aUri, std::move(entryData));
+        }
+        else
+            newResource = make_ref<resource>(*this, aUri);
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        // another thread may have loaded the same resource in the meantime
+        if (find_resource(aUri, aResult))
+            return;
+        iResources[aUri] = decltype(iResources)::mapped_type{ weak_ref_ptr<i_resource>{ newResource } };
+        if (archiveEntry)
+            cache_archive_entry(newResource);
+        aResult = newResource;
+    }
+
+    bool resource_manager::find_resource(i_string const& aUri, i_ref_ptr<i_resource>& aResult)
     {
         auto existing = iResources.as_std_map().find(aUri);
         if (existing != iResources.as_std_map().end())
@@ -66,27 +131,40 @@ namespace neogfx
             if (std::holds_alternative<ref_ptr<i_resource>>(existing->second.second()))
             {
                 aResult = std::get<ref_ptr<i_resource>>(existing->second.second());
-                return;
+                return true;
             }
             else if (std::holds_alternative<weak_ref_ptr<i_resource>>(existing->second.second()))
             {
                 weak_ref_ptr<i_resource> ptr = std::get<weak_ref_ptr<i_resource>>(existing->second.second());
                 if (!ptr.expired())
                 {
+                    auto cachedEntry = iArchiveEntryCacheIndex.find(aUri.to_std_string());
+                    if (cachedEntry != iArchiveEntryCacheIndex.end())
+                        iArchiveEntryCache.splice(iArchiveEntryCache.begin(), iArchiveEntryCache, cachedEntry->second);
                     aResult = ptr;
-                    return;
+                    return true;
                 }
             }
         }
-        if (neolib::uri{ aUri }.scheme().empty() && iResources.as_std_map().find(aUri.to_std_string_view().substr(0, aUri.to_std_string_view().rfind('#'))) == iResources.as_std_map().end())
-            throw embedded_resource_not_found(aUri);
-        auto newResource = make_ref<resource>(*this, aUri);
-        iResources[aUri] = decltype(iResources)::mapped_type{ weak_ref_ptr<i_resource>{ newResource } };
-        aResult = newResource;
+        return false;
+    }
+
+    std::size_t resource_manager::archive_entry_cache_capacity() const
+    {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        return iArchiveEntryCacheCapacity;
+    }
+
+    void resource_manager::set_archive_entry_cache_capacity(std::size_t aCapacity)
+    {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        iArchiveEntryCacheCapacity = aCapacity;
+        trim_archive_entry_cache();
     }
 
     void resource_manager::cleanup()
     {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
         for (auto i = iResources.as_std_map().begin(); i != iResources.as_std_map().end();)
         {
             if (std::holds_alternative<weak_ref_ptr<i_resource>>(i->second.second()) && std::get<weak_ref_ptr<i_resource>>(i->second.second()).expired())
@@ -98,6 +176,13 @@ namespace neogfx
 
     void resource_manager::clean()
     {
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        iArchiveEntryCacheIndex.clear();
+        iArchiveEntryCacheSize = 0;
+        decltype(iArchiveEntryCache) archiveEntryCache;
+        archiveEntryCache.swap(iArchiveEntryCache);
+        decltype(iArchives) archives;
+        archives.swap(iArchives);
         decltype(iResources) resources;
         resources.as_std_map().swap(iResources.as_std_map());
         decltype(iResourceArchives) resourceArchives;
@@ -113,4 +198,92 @@ namespace neogfx
     {
         return iResourceArchives;
     }
+
+    void resource_manager::queue_load(std::function<void()> aLoad)
+    {
+        {
+            std::unique_lock<std::mutex> lock{ iLoadMutex };
+            if (iStopping)
+            {
+                lock.unlock();
+                aLoad();
+                return;
+            }
+            iLoads.push_back(std::move(aLoad));
+            // loader threads are only started once something is loaded asynchronously
+            if (iLoaders.empty())
+            {
+                auto const loaderCount = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+                for (auto i = 0u; i < loaderCount; ++i)
+                    iLoaders.emplace_back([this]() { load_work(); });
+            }
+        }
+        iLoadAvailable.notify_one();
+    }
+
+    void resource_manager::stop_loading()
+    {
+        // queued loads are finished by the loader threads before they exit
+        std::vector<std::thread> loaders;
+        {
+            std::scoped_lock<std::mutex> lock{ iLoadMutex };
+            iStopping = true;
+            loaders.swap(iLoaders);
+        }
+        iLoadAvailable.notify_all();
+        for (auto& loader : loaders)
+            loader.join();
+    }
+
+    resource_archive& resource_manager::archive(std::string const& aArchiveUri)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock{ iMutex };
+            auto existing = iArchives.find(aArchiveUri);
+            if (existing != iArchives.end())
+                return *existing->second;
+        }
+        auto newArchive = std::make_unique<resource_archive>(load_resource(aArchiveUri));
+        std::lock_guard<std::recursive_mutex> lock{ iMutex };
+        // if another thread indexed the archive first its index is kept
+        return *iArchives.emplace(aArchiveUri, std::move(newArchive)).first->second;
+    }
+
+    void resource_manager::cache_archive_entry(ref_ptr<i_resource> const& aEntry)
+    {
+        iArchiveEntryCache.push_front(aEntry);
+        iArchiveEntryCacheIndex[aEntry->uri().to_std_string()] = iArchiveEntryCache.begin();
+        iArchiveEntryCacheSize += aEntry->size();
+        trim_archive_entry_cache();
+    }
+
+    void resource_manager::trim_archive_entry_cache()
+    {
+        // the most recently used entry is always kept; evicted entries remain alive while referenced elsewhere
+        while (iArchiveEntryCacheSize > iArchiveEntryCacheCapacity && iArchiveEntryCache.size() > 1)
+        {
+            ref_ptr<i_resource> evicted = iArchiveEntryCache.back();
+            iArchiveEntryCache.pop_back();
+            iArchiveEntryCacheIndex.erase(evicted->uri().to_std_string());
+            iArchiveEntryCacheSize -= evicted->size();
+        }
+    }
+
+    void resource_manager::load_work()
+    {
+        for (;;)
+        {
+            std::function<void()> nextLoad;
+            {
+                std::unique_lock<std::mutex> lock{ iLoadMutex };
+                iLoadAvailable.wait(lock, [this]() { return iStopping || !iLoads.empty(); });
+                // queued loads are finished before stopping so that no future is left without a result
+                if (iLoads.empty())
+                    return;
+                nextLoad = std::move(iLoads.front());
+                iLoads.pop_front();
+            }
+            nextLoad();
+        }
+    }
 }
\ No newline at end of file
@@ -17,70 +17,498 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 #include <neogfx/neogfx.hpp>
 #include <string>
-#include <neolib/file/lexer.hpp>
+#include <sstream>
+#include <charconv>
 #include <neogfx/core/html.hpp>
 
 namespace neogfx
 {
     namespace
     {
-        enum class token
+        // longest entity reference recognised, including the leading '&': "&#x10FFFF;"
+        constexpr std::size_t kMaxEntityLength = 10u;
+        // unterminated markup is cut off at this length rather than carried over indefinitely
+        constexpr std::size_t kMaxTokenLength = 0x100000u;
+
+        inline bool is_space(char aCharacter)
+        {
+            return aCharacter == ' ' || aCharacter == '\t' || aCharacter == '\n' || aCharacter == '\r' || aCharacter == '\f';
+        }
+
+        inline char to_lower(char aCharacter)
+        {
+            return aCharacter >= 'A' && aCharacter <= 'Z' ? static_cast<char>(aCharacter - 'A' + 'a') : aCharacter;
+        }
+
+        inline bool iequals(std::string_view aLhs, std::string_view aRhs)
+        {
+            return std::equal(aLhs.begin(), aLhs.end(), aRhs.begin(), aRhs.end(), [](char aLeft, char aRight) { return to_lower(aLeft) == to_lower(aRight); });
+        }
+
+        void append_utf8(std::string& aOutput, char32_t aCodePoint)
+        {
+            if (aCodePoint < 0x80u)
+                aOutput += static_cast<char>(aCodePoint);
+            else if (aCodePoint < 0x800u)
+            {
+                aOutput += static_cast<char>(0xC0u | (aCodePoint >> 6u));
+                aOutput += static_cast<char>(0x80u | (aCodePoint & 0x3Fu));
+            }
+            else if (aCodePoint < 0x10000u)
+            {
+                aOutput += static_cast<char>(0xE0u | (aCodePoint >> 12u));
+                aOutput += static_cast<char>(0x80u | ((aCodePoint >> 6u) & 0x3Fu));
+                aOutput += static_cast<char>(0x80u | (aCodePoint & 0x3Fu));
+            }
+            else
+            {
+                aOutput += static_cast<char>(0xF0u | (aCodePoint >> 18u));
+                aOutput += static_cast<char>(0x80u | ((aCodePoint >> 12u) & 0x3Fu));
+                aOutput += static_cast<char>(0x80u | ((aCodePoint >> 6u) & 0x3Fu));
+                aOutput += static_cast<char>(0x80u | (aCodePoint & 0x3Fu));
+            }
+        }
+
+        bool decode_entity(std::string_view aEntity, std::string& aOutput)
+        {
+            static const std::pair<std::string_view, std::string_view> sNamedEntities[] =
+            {
+                { "amp", "&" },
+                { "lt", "<" },
+                { "gt", ">" },
+                { "quot", "\"" },
+                { "apos", "'" },
+                { "nbsp", "\xC2\xA0" }
+            };
+            if (!aEntity.empty() && aEntity[0] == '#')
+            {
+                bool const hex = aEntity.size() > 1u && (aEntity[1] == 'x' || aEntity[1] == 'X');
+                auto const digits = aEntity.substr(hex ? 2u : 1u);
+                uint32_t codePoint = 0u;
+                auto const result = std::from_chars(digits.data(), digits.data() + digits.size(), codePoint, hex ? 16 : 10);
+                if (digits.empty() || result.ec != std::errc{} || result.ptr != digits.data() + digits.size() || codePoint == 0u || codePoint > 0x10FFFFu)
+                    return false;
+                append_utf8(aOutput, static_cast<char32_t>(codePoint));
+                return true;
+            }
+            for (auto const& entity : sNamedEntities)
+                if (entity.first == aEntity)
+                {
+                    aOutput += entity.second;
+                    return true;
+                }
+            return false;
+        }
+
+        void decode_entities(std::string_view aInput, std::string& aOutput)
+        {
+            aOutput.clear();
+            std::size_t position = 0u;
+            while (position < aInput.size())
+            {
+                auto const ampersand = aInput.find('&', position);
+                aOutput.append(aInput.substr(position, ampersand - position));
+                if (ampersand == std::string_view::npos)
+                    break;
+                auto const semicolon = aInput.find(';', ampersand + 1u);
+                if (semicolon != std::string_view::npos && semicolon - ampersand < kMaxEntityLength &&
+                    decode_entity(aInput.substr(ampersand + 1u, semicolon - ampersand - 1u), aOutput))
+                    position = semicolon + 1u;
+                else
+                {
+                    aOutput += '&';
+                    position = ampersand + 1u;
+                }
+            }
+        }
+
+        bool is_void_element(std::string_view aName)
+        {
+            static const std::string_view sVoidElements[] =
+            {
+                "area", "base", "br", "col", "embed", "hr", "img", "input", "link", "meta", "param", "source", "track", "wbr"
+            };
+            return std::find(std::begin(sVoidElements), std::end(sVoidElements), aName) != std::end(sVoidElements);
+        }
+    }
+
+    html_tokenizer::html_tokenizer(std::istream& aInput, i_html_handler& aHandler, std::size_t aChunkSize) :
+        iInput{ aInput }, iHandler{ aHandler }, iChunkSize{ aChunkSize }, iBufferPosition{ 0u }, iResume{ 0u }, iQuote{ '\0' }, iFinished{ false }
+    {
+    }
+
+    bool html_tokenizer::finished() const
+    {
+        return iFinished;
+    }
+
+    bool html_tokenizer::tokenize_chunk()
+    {
+        if (iFinished)
+            return false;
+        iBuffer.erase(0u, iBufferPosition);
+        iBufferPosition = 0u;
+        auto const carried = iBuffer.size();
+        iBuffer.resize(carried + iChunkSize);
+        iInput.read(&iBuffer[carried], static_cast<std::streamsize>(iChunkSize));
+        iBuffer.resize(carried + static_cast<std::size_t>(iInput.gcount()));
+        bool const endOfInput = !iInput;
+        scan(endOfInput);
+        if (endOfInput)
         {
-            OpenTag,
-            CloseTag,
-            Comment,
-            Whitespace
-        };
+            iFinished = true;
+            std::string{}.swap(iBuffer);
+            iBufferPosition = 0u;
+        }
+        return !iFinished;
+    }
 
-        enum class scope
+    void html_tokenizer::tokenize()
+    {
+        while (tokenize_chunk())
+            ;
+    }
+
+    void html_tokenizer::scan(bool aEndOfInput)
+    {
+        auto position = iBufferPosition;
+        while (position < iBuffer.size())
         {
-            Document,
-            ElementTag,
-            ElementContents
-        };
+            std::size_t next;
+            if (!iRawTextElement.empty())
+                next = scan_raw_text(position, aEndOfInput);
+            else if (iBuffer[position] == '<')
+            {
+                next = scan_markup(position, aEndOfInput);
+                if (next != std::string::npos)
+                {
+                    iResume = 0u;
+                    iQuote = '\0';
+                }
+            }
+            else
+                next = scan_text(position, aEndOfInput);
+            if (next == std::string::npos)
+                break;
+            position = next;
+        }
+        iBufferPosition = position;
+    }
 
-        typedef neolib::lexer_token<token> lexer_token;
-        typedef neolib::lexer_atom<token, scope> lexer_atom;
-        typedef neolib::lexer_rule<lexer_atom> lexer_rule;
-        const lexer_rule sLexerRules[] =
+    std::size_t html_tokenizer::scan_text(std::size_t aPosition, bool aEndOfInput)
+    {
+        auto end = iBuffer.find('<', aPosition);
+        if (end == std::string::npos)
         {
-            { token::OpenTag, {{ '<' }} },
-            { token::CloseTag, {{ '>' }} },
-            { lexer_rule::enter_scope(scope::ElementTag), {{ scope::Document, token::OpenTag }} },
-            { lexer_rule::leave_scope(scope::ElementTag), {{ scope::Document, token::CloseTag }} },
-        };
+            end = iBuffer.size();
+            // hold back an entity reference that may continue in the next chunk
+            auto const ampersand = iBuffer.rfind('&');
+            if (!aEndOfInput && ampersand != std::string::npos && ampersand >= aPosition &&
+                iBuffer.find(';', ampersand) == std::string::npos && end - ampersand < kMaxEntityLength)
+                end = ampersand;
+        }
+        if (end == aPosition)
+            return std::string::npos;
+        emit_text(std::string_view{ iBuffer }.substr(aPosition, end - aPosition));
+        return end;
     }
 
-    html::html(std::string const& aStyle) :
-        iDocument{std::make_shared<std::istringstream>(aStyle)}
+    std::size_t html_tokenizer::scan_raw_text(std::size_t aPosition, bool aEndOfInput)
     {
+        // the contents of script and style elements are not markup; they end at the matching end tag
+        auto const closingLength = iRawTextElement.size() + 2u;
+        auto const buffer = std::string_view{ iBuffer };
+        auto search = aPosition;
+        for (;;)
+        {
+            auto const candidate = buffer.find("</", search);
+            if (candidate != std::string_view::npos && buffer.size() - candidate >= closingLength)
+            {
+                if (!iequals(buffer.substr(candidate + 2u, iRawTextElement.size()), iRawTextElement))
+                {
+                    search = candidate + 2u;
+                    continue;
+                }
+                if (candidate != aPosition)
+                    iHandler.character_data(buffer.substr(aPosition, candidate - aPosition));
+                iRawTextElement.clear();
+                return candidate;
+            }
+            auto end = buffer.size();
+            if (!aEndOfInput)
+                end = candidate != std::string_view::npos ? candidate : std::max(aPosition, end - 1u);
+            if (end == aPosition)
+                return std::string::npos;
+            iHandler.character_data(buffer.substr(aPosition, end - aPosition));
+            return end;
+        }
+    }
+
+    std::size_t html_tokenizer::scan_markup(std::size_t aPosition, bool aEndOfInput)
+    {
+        auto const buffer = std::string_view{ iBuffer };
+        auto const available = buffer.size() - aPosition;
+        if (available < 2u)
+        {
+            if (!aEndOfInput)
+                return std::string::npos;
+            emit_text("<");
+            return aPosition + 1u;
+        }
+        // a token carried over from the previous chunk is scanned from where the last scan stopped rather than from its start
+        bool const endOfToken = aEndOfInput || available > kMaxTokenLength;
+        auto const next = buffer[aPosition + 1u];
+        if (next == '!')
+        {
+            if (available < 4u && !aEndOfInput)
+                return std::string::npos;
+            if (buffer.substr(aPosition, 4u) == "<!--")
+            {
+                auto const end = buffer.find("-->", aPosition + std::max<std::size_t>(4u, iResume));
+                if (end == std::string_view::npos && !endOfToken)
+                {
+                    // the last two characters may begin "-->"
+                    iResume = std::max<std::size_t>(4u, available - 2u);
+                    return std::string::npos;
+                }
+                auto const contentEnd = end != std::string_view::npos ? end : buffer.size();
+                iHandler.comment(buffer.substr(aPosition + 4u, contentEnd - aPosition - 4u));
+                return end != std::string_view::npos ? end + 3u : buffer.size();
+            }
+        }
+        if (next == '!' || next == '?' || next == '/')
+        {
+            auto const end = buffer.find('>', aPosition + std::max<std::size_t>(2u, iResume));
+            if (end == std::string_view::npos && !endOfToken)
+            {
+                iResume = available;
+                return std::string::npos;
+            }
+            auto const contentEnd = end != std::string_view::npos ? end : buffer.size();
+            auto const content = buffer.substr(aPosition + 2u, contentEnd - aPosition - 2u);
+            if (next == '/')
+            {
+                iName.clear();
+                for (auto ch : content)
+                {
+                    if (is_space(ch))
+                        break;
+                    iName += to_lower(ch);
+                }
+                if (!iName.empty())
+                    iHandler.end_element(iName);
+            }
+            else if (next == '!' && content.size() >= 7u && iequals(content.substr(0u, 7u), "doctype"))
+            {
+                auto declaration = content.substr(7u);
+                while (!declaration.empty() && is_space(declaration.front()))
+                    declaration.remove_prefix(1u);
+                while (!declaration.empty() && is_space(declaration.back()))
+                    declaration.remove_suffix(1u);
+                iHandler.doctype(declaration);
+            }
+            else
+                iHandler.comment(content);
+            return end != std::string_view::npos ? end + 1u : buffer.size();
+        }
+        if (!((next >= 'a' && next <= 'z') || (next >= 'A' && next <= 'Z')))
+        {
+            emit_text("<");
+            return aPosition + 1u;
+        }
+        // a '>' inside a quoted attribute value does not end the tag
+        char quote = iQuote;
+        auto end = aPosition + std::max<std::size_t>(2u, iResume);
+        for (; end < buffer.size(); ++end)
+        {
+            auto const ch = buffer[end];
+            if (quote != '\0')
+            {
+                if (ch == quote)
+                    quote = '\0';
+            }
+            else if (ch == '"' || ch == '\'')
+                quote = ch;
+            else if (ch == '>')
+                break;
+        }
+        if (end == buffer.size() && !endOfToken)
+        {
+            iResume = available;
+            iQuote = quote;
+            return std::string::npos;
+        }
+        emit_start_element(buffer.substr(aPosition + 1u, end - aPosition - 1u));
+        return std::min(end + 1u, buffer.size());
+    }
+
+    void html_tokenizer::emit_text(std::string_view aText)
+    {
+        if (aText.find('&') == std::string_view::npos)
+            iHandler.character_data(aText);
+        else
+        {
+            decode_entities(aText, iDecoded);
+            iHandler.character_data(iDecoded);
+        }
+    }
+
+    void html_tokenizer::emit_start_element(std::string_view aTag)
+    {
+        std::size_t position = 0u;
+        iName.clear();
+        while (position < aTag.size() && !is_space(aTag[position]) && aTag[position] != '/')
+            iName += to_lower(aTag[position++]);
+        std::size_t attributeCount = 0u;
+        bool selfClosing = false;
+        while (position < aTag.size())
+        {
+            if (is_space(aTag[position]))
+            {
+                ++position;
+                continue;
+            }
+            if (aTag[position] == '/')
+            {
+                selfClosing = true;
+                ++position;
+                continue;
+            }
+            selfClosing = false;
+            if (attributeCount == iAttributeStorage.size())
+                iAttributeStorage.emplace_back();
+            auto& attribute = iAttributeStorage[attributeCount++];
+            attribute.first.clear();
+            attribute.second.clear();
+            while (position < aTag.size() && !is_space(aTag[position]) && aTag[position] != '=' && aTag[position] != '/')
+                attribute.first += to_lower(aTag[position++]);
+            while (position < aTag.size() && is_space(aTag[position]))
+                ++position;
+            if (position == aTag.size() || aTag[position] != '=')
+                continue;
+            ++position;
+            while (position < aTag.size() && is_space(aTag[position]))
+                ++position;
+            std::size_t valueStart = position;
+            std::size_t valueEnd;
+            if (position < aTag.size() && (aTag[position] == '"' || aTag[position] == '\''))
+            {
+                valueStart = position + 1u;
+                valueEnd = std::min(aTag.find(aTag[position], valueStart), aTag.size());
+                position = std::min(valueEnd + 1u, aTag.size());
+            }
+            else
+            {
+                while (position < aTag.size() && !is_space(aTag[position]))
+                    ++position;
+                valueEnd = position;
+            }
+            decode_entities(aTag.substr(valueStart, valueEnd - valueStart), attribute.second);
+        }
+        // views are taken only once all attributes are stored as storage may reallocate
+        iAttributes.clear();
+        for (std::size_t attributeIndex = 0u; attributeIndex < attributeCount; ++attributeIndex)
+            iAttributes.emplace_back(iAttributeStorage[attributeIndex].first, iAttributeStorage[attributeIndex].second);
+        iHandler.start_element(iName, iAttributes, selfClosing);
+        if (!selfClosing && (iName == "script" || iName == "style"))
+            iRawTextElement = iName;
+    }
+
+    html::html(std::string const& aFragment) :
+        iDocument{ std::make_shared<std::istringstream>(aFragment) }
+    {
+        iTokenizer.emplace(*iDocument, static_cast<i_html_handler&>(*this));
         parse();
     }
 
-    html::html(std::istream& aDocument) :
+    html::html(std::istream& aDocument, bool aIncremental) :
         iDocument{ std::shared_ptr<std::istream>{ std::shared_ptr<std::istream>{}, &aDocument } }
     {
-        parse();
+        if (!*iDocument)
+            throw failed_to_open_html();
+        iTokenizer.emplace(*iDocument, static_cast<i_html_handler&>(*this));
+        if (!aIncremental)
+            parse();
+    }
+
+    const html::node& html::document() const
+    {
+        return iRoot;
+    }
+
+    bool html::finished() const
+    {
+        return iTokenizer->finished();
+    }
+
+    bool html::parse_chunk()
+    {
+        if (finished())
+            return false;
+        bool const more = iTokenizer->tokenize_chunk();
+        ChunkParsed.trigger();
+        if (!more)
+        {
+            iOpenElements.clear();
+            Parsed.trigger();
+        }
+        return more;
     }
 
     void html::parse()
     {
-        static const neolib::lexer<lexer_atom> sLexer{ scope::Document, std::cbegin(sLexerRules), std::cend(sLexerRules) };
-        neolib::lexer<lexer_atom>::context lexerContext = sLexer.use(*iDocument);
-        if (!lexerContext)
-            throw failed_to_open_html();
-        std::vector<lexer_token> tokens;
-        lexer_token token;
-        while (lexerContext >> token)
-            tokens.push_back(token);
-        tokens.erase(
-            std::remove_if(tokens.begin(), tokens.end(), 
-                [](const lexer_token& aToken) 
-                { 
-                    return aToken.first == token::Whitespace || aToken.first == token::Comment; 
-                }), 
-            tokens.end());
+        while (parse_chunk())
+            ;
+    }
+
+    void html::doctype(std::string_view aDeclaration)
+    {
+        auto& parent = current_node();
+        parent.push_back(new element{ "!doctype" });
+        if (!aDeclaration.empty())
+            static_cast<element&>(parent.back()).append_text(element::string{ aDeclaration });
+    }
+
+    void html::start_element(std::string_view aName, const html_attributes& aAttributes, bool aSelfClosing)
+    {
+        auto& parent = current_node();
+        parent.push_back(new element{ element::string{ aName } });
+        auto& newElement = static_cast<element&>(parent.back());
+        for (auto const& attribute : aAttributes)
+            newElement.set_attribute(element::string{ attribute.first }, element::string{ attribute.second });
+        if (!aSelfClosing && !is_void_element(aName))
+            iOpenElements.push_back(&newElement);
+    }
+
+    void html::end_element(std::string_view aName)
+    {
+        // an end tag closes its most recently opened namesake and any elements left open inside it; a stray one is ignored
+        auto const open = std::find_if(iOpenElements.rbegin(), iOpenElements.rend(), [&](element const* aElement) { return aElement->name() == aName; });
+        if (open != iOpenElements.rend())
+            iOpenElements.erase(std::next(open).base(), iOpenElements.end());
+    }
+
+    void html::character_data(std::string_view aText)
+    {
+        auto& parent = current_node();
+        if (!parent.empty() && parent.back().type() == node::Text)
+            static_cast<text_node&>(parent.back()).content() += aText;
+        else
+            parent.push_back(new text_node{ text_node::string{ aText } });
+    }
+
+    void html::comment(std::string_view aText)
+    {
+        current_node().push_back(new comment_node{ comment_node::string{ aText } });
+    }
+
+    html::node& html::current_node()
+    {
+        if (iOpenElements.empty())
+            return iRoot;
+        return *iOpenElements.back();
     }
 }
@@ -21,6 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <neolib/core/scoped.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
 #include <neogfx/core/transition_animator.hpp>
 
 template<> neogfx::i_animator& services::start_service<neogfx::i_animator>()
@@ -39,6 +40,8 @@ namespace neogfx
     transition::transition(i_animator& aAnimator, easing aEasingFunction, double aDuration, bool aEnabled) :
         iAnimator{ aAnimator }, iId{ aAnimator.add_transition(*this) }, iEnabled{ aEnabled }, iDisableWhenFinished{ false }, iEasingFunction{ aEasingFunction }, iDuration{ aDuration }, iPaused{ false }
     {
+        if (iEnabled)
+            changed();
     }
 
     transition::~transition()
@@ -75,11 +78,13 @@ namespace neogfx
     {
         iEnabled = true;
         iDisableWhenFinished = aDisableWhenFinished;
+        changed();
     }
 
     void transition::disable()
     {
         iEnabled = false;
+        changed();
     }
 
     easing transition::easing_function() const
@@ -125,11 +130,13 @@ namespace neogfx
     void transition::pause()
     {
         iPaused = true;
+        changed();
     }
 
     void transition::resume()
     {
         iPaused = false;
+        changed();
     }
 
     void transition::reset(bool aEnable, bool aDisableWhenFinished, bool aResetStartTime)
@@ -138,6 +145,8 @@ namespace neogfx
             iStartTime = std::nullopt;
         if (aEnable)
             enable(aDisableWhenFinished);
+        else
+            changed();
     }
 
     void transition::reset(easing aNewEasingFunction, bool aEnable, bool aDisableWhenFinished, bool aResetStartTime)
@@ -148,12 +157,32 @@ namespace neogfx
             apply();
     }
 
+    bool transition::mix_handle(scalar_mix_handle&) const
+    {
+        return false;
+    }
+
+    void transition::changed()
+    {
+        animator().transition_changed(id());
+    }
+
     animator::animator() :
         iTimer { service<i_async_task>(), [this](neolib::callback_timer& aTimer)
         {
-            aTimer.again();
             next_frame();
-        }, std::chrono::milliseconds{ 10 } },
+            if (!iActiveTransitions.empty() && !iStopped)
+            {
+                aTimer.set_duration(until_next_frame(), true);
+                aTimer.again();
+            }
+            else
+                iTicking = false;
+        }, std::chrono::milliseconds{ 16 }, false },
+        iBatchesDirty{ false },
+        iChanges{ 0u },
+        iTicking{ false },
+        iStopped{ false },
         iZeroHour{ std::chrono::high_resolution_clock::now() },
         iAnimationTime{ 0.0 }
     {
@@ -171,29 +200,140 @@ namespace neogfx
 
     void animator::remove_transition(transition_id aTransitionId)
     {
+        if (iActiveTransitions.erase(aTransitionId) != 0u)
+        {
+            iBatchesDirty = true;
+            ++iChanges;
+        }
         iTransitions.remove(aTransitionId);
     }
 
     void animator::stop()
     {
+        iStopped = true;
         iTimer.disable();
     }
 
-    void animator::next_frame()
+    double animator::animation_time() const
     {
-        iAnimationTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - iZeroHour).count();
-        for (auto& t : iTransitions)
-            if (t->can_apply())
-                t->apply();
+        return iAnimationTime;
     }
 
-    double animator::animation_time() const
+    bool animator::idle() const
     {
-        return iAnimationTime;
+        return !iTicking;
     }
 
     transition_id animator::allocate_id()
     {
         return iTransitions.next_cookie();
     }
+
+    void animator::transition_changed(transition_id aTransitionId)
+    {
+        iActiveTransitions.insert(aTransitionId);
+        iBatchesDirty = true;
+        ++iChanges;
+        // enabled() rather than can_apply() as this is also called while a transition is being constructed;
+        // the first frame drops the transition again if it cannot be applied
+        if (!iTicking && !iStopped && iTransitions[aTransitionId]->enabled())
+        {
+            iTicking = true;
+            iTimer.set_duration(until_next_frame(), true);
+            iTimer.again();
+        }
+    }
+
+    std::chrono::milliseconds animator::until_next_frame() const
+    {
+        auto const frameRate = std::max(1u, service<i_rendering_engine>().frame_rate_limit());
+        auto const frameDuration = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>{ 1.0 / frameRate });
+        auto const sinceZeroHour = std::chrono::high_resolution_clock::now() - iZeroHour;
+        auto const untilNextFrame = frameDuration - sinceZeroHour % frameDuration;
+        return std::max(std::chrono::milliseconds{ 1 }, std::chrono::duration_cast<std::chrono::milliseconds>(untilNextFrame));
+    }
+
+    void animator::update_batches()
+    {
+        iBatchesDirty = false;
+        for (auto& batch : iBatches)
+        {
+            batch.ids.clear();
+            batch.transitions.clear();
+            batch.startTimes.clear();
+            batch.durations.clear();
+            batch.targets.clear();
+            batch.assigns.clear();
+            batch.froms.clear();
+            batch.tos.clear();
+        }
+        for (auto id = iActiveTransitions.begin(); id != iActiveTransitions.end();)
+        {
+            auto& t = *iTransitions[*id];
+            if (!t.can_apply())
+            {
+                id = iActiveTransitions.erase(id);
+                continue;
+            }
+            auto batch = std::find_if(iBatches.begin(), iBatches.end(), [&](transition_batch const& aBatch) { return aBatch.easingFunction == t.easing_function(); });
+            if (batch == iBatches.end())
+                batch = iBatches.insert(iBatches.end(), transition_batch{ t.easing_function() });
+            batch->ids.push_back(*id);
+            batch->transitions.push_back(&t);
+            batch->startTimes.push_back(t.start_time());
+            batch->durations.push_back(t.duration());
+            // transitions without a handle mix from 0.0 to 1.0 so their mixed value is the eased mix value
+            i_transition::scalar_mix_handle handle{ nullptr, nullptr, 0.0, 1.0 };
+            t.mix_handle(handle);
+            batch->targets.push_back(handle.target);
+            batch->assigns.push_back(handle.assign);
+            batch->froms.push_back(handle.from);
+            batch->tos.push_back(handle.to);
+            ++id;
+        }
+        iBatches.erase(std::remove_if(iBatches.begin(), iBatches.end(), [](transition_batch const& aBatch) { return aBatch.ids.empty(); }), iBatches.end());
+        for (auto& batch : iBatches)
+            batch.mixValues.resize(batch.ids.size());
+    }
+
+    void animator::next_frame()
+    {
+        iAnimationTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - iZeroHour).count();
+        if (iBatchesDirty)
+            update_batches();
+        for (auto& batch : iBatches)
+        {
+            auto const count = batch.ids.size();
+            auto const startTimes = batch.startTimes.data();
+            auto const durations = batch.durations.data();
+            auto const mixValues = batch.mixValues.data();
+            auto const froms = batch.froms.data();
+            auto const tos = batch.tos.data();
+            for (std::size_t i = 0u; i < count; ++i)
+                mixValues[i] = std::min(1.0, std::max(0.0, (iAnimationTime - startTimes[i]) / durations[i]));
+            ease(batch.easingFunction, mixValues, mixValues + count, mixValues);
+            for (std::size_t i = 0u; i < count; ++i)
+                mixValues[i] = froms[i] * (1.0 - mixValues[i]) + tos[i] * mixValues[i];
+        }
+        // applying a transition can change or remove others; if that happens the remaining batch entries are rechecked
+        auto const changes = iChanges;
+        for (auto& batch : iBatches)
+            for (std::size_t i = 0u; i < batch.ids.size(); ++i)
+            {
+                if (iChanges != changes && (iActiveTransitions.find(batch.ids[i]) == iActiveTransitions.end() || !batch.transitions[i]->can_apply()))
+                    continue;
+                auto& t = *batch.transitions[i];
+                if (iAnimationTime - batch.startTimes[i] > batch.durations[i])
+                {
+                    t.apply();
+                    iBatchesDirty = true;
+                }
+                else if (batch.assigns[i] != nullptr)
+                    batch.assigns[i](batch.targets[i], batch.mixValues[i]);
+                else
+                    t.apply(batch.mixValues[i]);
+            }
+        if (iBatchesDirty)
+            update_batches();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+// buffer_ring.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2024 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/buffer_ring.hpp>
+
+namespace neogfx
+{
+    buffer_ring::buffer_ring(i_fence_source& aFenceSource, size_type aCapacity, size_type aRegionCount) :
+        iFenceSource{ aFenceSource },
+        iCapacity{ aCapacity },
+        iRegionSize{ 0u },
+        iCurrentRegion{ 0u },
+        iRegionBegin{ 0u },
+        iRegionEnd{ 0u },
+        iFences(aRegionCount, nullptr),
+        iResized{ false },
+        iAdvances{ 0u },
+        iStalls{ 0u }
+    {
+        if (aRegionCount == 0u)
+            throw bad_region_count();
+        iRegionSize = iCapacity / region_count();
+        update_current_region();
+    }
+
+    buffer_ring::~buffer_ring()
+    {
+        for (auto& fence : iFences)
+            if (fence != nullptr)
+                iFenceSource.delete_fence(fence);
+    }
+
+    buffer_ring::size_type buffer_ring::capacity() const
+    {
+        return iCapacity;
+    }
+
+    buffer_ring::size_type buffer_ring::region_count() const
+    {
+        return iFences.size();
+    }
+
+    buffer_ring::size_type buffer_ring::region_size() const
+    {
+        return iRegionSize;
+    }
+
+    buffer_ring::size_type buffer_ring::current_region() const
+    {
+        return iCurrentRegion;
+    }
+
+    buffer_ring::size_type buffer_ring::region_begin() const
+    {
+        return iRegionBegin;
+    }
+
+    buffer_ring::size_type buffer_ring::region_end() const
+    {
+        return iRegionEnd;
+    }
+
+    buffer_ring::size_type buffer_ring::advances() const
+    {
+        return iAdvances;
+    }
+
+    buffer_ring::size_type buffer_ring::stalls() const
+    {
+        return iStalls;
+    }
+
+    void buffer_ring::advance()
+    {
+        ++iAdvances;
+        if (iResized)
+        {
+            // the span written since a resize can overlap any region so wait for it before resuming the ring
+            auto const fence = iFenceSource.insert_fence();
+            if (!iFenceSource.fence_signalled(fence))
+            {
+                ++iStalls;
+                iFenceSource.wait_fence(fence);
+            }
+            iFenceSource.delete_fence(fence);
+            iResized = false;
+            iCurrentRegion = 0u;
+            update_current_region();
+            return;
+        }
+        iFences[iCurrentRegion] = iFenceSource.insert_fence();
+        iCurrentRegion = (iCurrentRegion + 1u) % region_count();
+        auto& next = iFences[iCurrentRegion];
+        if (next != nullptr)
+        {
+            if (!iFenceSource.fence_signalled(next))
+            {
+                ++iStalls;
+                iFenceSource.wait_fence(next);
+            }
+            iFenceSource.delete_fence(next);
+            next = nullptr;
+        }
+        update_current_region();
+    }
+
+    void buffer_ring::resize(size_type aCapacity)
+    {
+        wait_all();
+        iCapacity = aCapacity;
+        iRegionSize = iCapacity / region_count();
+        // carry on writing the current span up to the new end; advance() then restarts at region 0
+        iRegionEnd = iCapacity;
+        iResized = true;
+    }
+
+    void buffer_ring::wait_all()
+    {
+        for (auto& fence : iFences)
+            if (fence != nullptr)
+            {
+                if (!iFenceSource.fence_signalled(fence))
+                {
+                    ++iStalls;
+                    iFenceSource.wait_fence(fence);
+                }
+                iFenceSource.delete_fence(fence);
+                fence = nullptr;
+            }
+    }
+
+    void buffer_ring::update_current_region()
+    {
+        iRegionBegin = iCurrentRegion * iRegionSize;
+        iRegionEnd = (iCurrentRegion + 1u == region_count() ? iCapacity : iRegionBegin + iRegionSize);
+    }
+}
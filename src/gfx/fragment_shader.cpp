@@ -550,6 +550,15 @@ namespace neogfx
                 "                }\n"
                 "            }\n"
                 "        }\n"
+                "        else if (uGlyphSdf)\n"
+                "        {\n"
+                "            float d = texture(tex, TexCoord).r;\n"
+                "            float w = max(fwidth(d) * 0.5, 1.0 / 255.0);\n"
+                "            a = smoothstep(0.5 - w, 0.5 + w, d);\n"
+                "            if (a == 0)\n"
+                "                discard;\n"
+                "            color = vec4(color.xyz, color.a * a);\n"
+                "        }\n"
                 "        else\n"
                 "        {\n"
                 "            a = texture(tex, TexCoord).r;\n"
@@ -582,6 +591,7 @@ namespace neogfx
         uGlyphRenderOutput = sampler2DMS{ 7 };
         uGlyphSubpixel = aText.glyph_texture(aGlyph).subpixel();
         uGlyphSubpixelFormat = subpixelRender ? aContext.subpixel_format() : subpixel_format::None;
+        uGlyphSdf = aText.glyph_texture(aGlyph).sdf();
         uGlyphEnabled = true;
     }
 
@@ -604,7 +614,7 @@ namespace neogfx
                 "    {\n"
                 "        float d = 0.0;\n"
                 "        if (!uShapeEnabled)\n"
-                "            d = distance(uStippleVertex, Coord);\n"
+                "            d = function3.w;\n"
                 "        else if (uShape == SHAPE_Circle)\n"
                 "        {\n"
                 "            float y = Coord.y - function1.y;\n"
@@ -642,21 +652,9 @@ namespace neogfx
         uStippleFactor = static_cast<float>(aFactor);
         uStipplePattern = aPattern;
         uStipplePosition = static_cast<float>(iPosition);
-        uStippleVertex = vec3f{};
         uStippleEnabled = true;
     }
 
-    void standard_stipple_shader::start(const i_rendering_context& aContext, const vec3& aFrom)
-    {
-        next(aContext, aFrom, 0.0);
-    }
-    
-    void standard_stipple_shader::next(const i_rendering_context& aContext, const vec3& aFrom, scalar aPositionOffset)
-    {
-        uStipplePosition = static_cast<float>(iPosition + aPositionOffset);
-        uStippleVertex = aFrom.as<float>();
-    }
-
     standard_shape_shader::standard_shape_shader(std::string const& aName) :
         standard_fragment_shader<i_shape_shader>{ aName }
     {
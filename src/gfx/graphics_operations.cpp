@@ -117,6 +117,8 @@ namespace neogfx
             const i_glyph_texture& rightGlyphTexture = rhsText.glyph_texture(rhs);
             if (leftGlyphTexture.subpixel() != rightGlyphTexture.subpixel())
                 return false;
+            if (leftGlyphTexture.sdf() != rightGlyphTexture.sdf())
+                return false;
             return true;
         };
 
@@ -25,8 +25,73 @@
 #include <neogfx/gfx/image.hpp>
 #include <neogfx/app/resource_manager.hpp>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <tmmintrin.h>
+#define NEOGFX_SSSE3_PIXEL_CONVERSION
+#define NEOGFX_SSSE3_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define NEOGFX_SSSE3_PIXEL_CONVERSION
+#define NEOGFX_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
 namespace neogfx
 {
+    namespace
+    {
+        void expand_rgb_to_rgba_scalar(const uint8_t* aSource, uint8_t* aDestination, std::size_t aPixelCount)
+        {
+            for (std::size_t pixel = 0; pixel < aPixelCount; ++pixel, aSource += 3, aDestination += 4)
+            {
+                aDestination[0] = aSource[0];
+                aDestination[1] = aSource[1];
+                aDestination[2] = aSource[2];
+                aDestination[3] = 0xFF;
+            }
+        }
+
+#ifdef NEOGFX_SSSE3_PIXEL_CONVERSION
+        bool has_ssse3()
+        {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#else
+            return __builtin_cpu_supports("ssse3");
+#endif
+        }
+
+        NEOGFX_SSSE3_TARGET void expand_rgb_to_rgba_ssse3(const uint8_t* aSource, uint8_t* aDestination, std::size_t aPixelCount)
+        {
+            __m128i const shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            std::size_t pixel = 0;
+            // four pixels per iteration; each 16 byte load uses 12 so stop while the load would overrun the source
+            for (; pixel + 6 <= aPixelCount; pixel += 4, aSource += 12, aDestination += 16)
+            {
+                __m128i const rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+            }
+            expand_rgb_to_rgba_scalar(aSource, aDestination, aPixelCount - pixel);
+        }
+#endif
+
+        void expand_rgb_to_rgba(const uint8_t* aSource, uint8_t* aDestination, std::size_t aPixelCount)
+        {
+#ifdef NEOGFX_SSSE3_PIXEL_CONVERSION
+            static bool const sHasSsse3 = has_ssse3();
+            if (sHasSsse3)
+            {
+                expand_rgb_to_rgba_ssse3(aSource, aDestination, aPixelCount);
+                return;
+            }
+#endif
+            expand_rgb_to_rgba_scalar(aSource, aDestination, aPixelCount);
+        }
+    }
+
     image::image(dimension aDpiScaleFactor, texture_sampling aSampling, neogfx::color_space aColorSpace) :
         iDpiScaleFactor{ aDpiScaleFactor }, 
         iColorSpace{ aColorSpace },
@@ -158,6 +223,14 @@ namespace neogfx
     {
     }
 
+    std::future<ref_ptr<i_image>> image::load_async(std::string const& aUri, dimension aDpiScaleFactor, texture_sampling aSampling, neogfx::color_space aColorSpace)
+    {
+        auto load = std::make_shared<std::packaged_task<ref_ptr<i_image>()>>([=]() -> ref_ptr<i_image> { return make_ref<image>(aUri, aDpiScaleFactor, aSampling, aColorSpace); });
+        auto result = load->get_future();
+        service<i_resource_manager>().queue_load([load]() { (*load)(); });
+        return result;
+    }
+
     bool image::available() const
     {
         if (has_resource())
@@ -376,11 +449,22 @@ namespace neogfx
         image.version = PNG_IMAGE_VERSION;
         if (png_image_begin_read_from_memory(&image, resource().data(), resource().size()) != 0)
         {
-            image.format = PNG_FORMAT_RGBA;
-            iData.resize(PNG_IMAGE_SIZE(image));
-            if (png_image_finish_read(&image, NULL, data(), 0, NULL) != 0)
+            // opaque images are decoded as RGB and expanded here as that is cheaper than libpng adding the alpha channel
+            bool const opaque = (image.format & PNG_FORMAT_FLAG_ALPHA) == 0;
+            image.format = opaque ? PNG_FORMAT_RGB : PNG_FORMAT_RGBA;
+            std::vector<uint8_t> rgb;
+            if (opaque)
+                rgb.resize(PNG_IMAGE_SIZE(image));
+            else
+                iData.resize(PNG_IMAGE_SIZE(image));
+            if (png_image_finish_read(&image, NULL, opaque ? rgb.data() : data(), 0, NULL) != 0)
             {
                 iSize = neogfx::size(image.width, image.height);
+                if (opaque)
+                {
+                    iData.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+                    expand_rgb_to_rgba(rgb.data(), static_cast<uint8_t*>(data()), static_cast<std::size_t>(image.width) * image.height);
+                }
                 png_image_free(&image);
                 return true;
             }
@@ -58,4 +58,75 @@ namespace neogfx
             iCurrentProgram.as<i_standard_shader_program>().shape_shader().clear_shape();
         }
     }
+
+    opengl_pixel_reader::~opengl_pixel_reader()
+    {
+        for (auto& read : iPending)
+        {
+            iFenceSource.delete_fence(read.fence);
+            glCheck(glDeleteBuffers(1, &read.buffer.handle));
+        }
+        for (auto& buffer : iFreeBuffers)
+            glCheck(glDeleteBuffers(1, &buffer.handle));
+    }
+
+    bool opengl_pixel_reader::empty() const
+    {
+        return iPending.empty();
+    }
+
+    void opengl_pixel_reader::read(const rect_i32& aSource, const rect& aRect, const i_render_target::read_pixels_callback& aCallback)
+    {
+        auto const size = static_cast<GLsizeiptr>(static_cast<GLsizeiptr>(aSource.cx) * aSource.cy * sizeof(avec4u8));
+        pending_read read{ { 0, 0 }, nullptr, aSource.extents(), aRect, aCallback };
+        if (!iFreeBuffers.empty())
+        {
+            read.buffer = iFreeBuffers.back();
+            iFreeBuffers.pop_back();
+        }
+        else
+            glCheck(glGenBuffers(1, &read.buffer.handle));
+        glCheck(glBindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer.handle));
+        if (read.buffer.capacity < size)
+        {
+            glCheck(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+            read.buffer.capacity = size;
+        }
+        glCheck(glReadPixels(aSource.x, aSource.y, aSource.cx, aSource.cy, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+        glCheck(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        read.fence = iFenceSource.insert_fence();
+        iPending.push_back(std::move(read));
+    }
+
+    void opengl_pixel_reader::poll(bool aWait)
+    {
+        // callbacks are invoked only once iPending is no longer being iterated as they may read pixels again
+        std::vector<completed_read> completed;
+        for (auto read = iPending.begin(); read != iPending.end();)
+        {
+            if (!aWait && !iFenceSource.fence_signalled(read->fence))
+            {
+                ++read;
+                continue;
+            }
+            iFenceSource.wait_fence(read->fence);
+            iFenceSource.delete_fence(read->fence);
+            // the pixel count is that of the integer extents passed to glReadPixels rather than of the (fractional) rect
+            auto const pixelCount = static_cast<std::size_t>(read->extents.cx) * static_cast<std::size_t>(read->extents.cy);
+            auto const rect = neogfx::rect{ read->rect.top_left(), size{ static_cast<dimension>(read->extents.cx), static_cast<dimension>(read->extents.cy) } };
+            auto& result = completed.emplace_back(completed_read{ rect, std::move(read->callback) });
+            glCheck(glBindBuffer(GL_PIXEL_PACK_BUFFER, read->buffer.handle));
+            auto const mapped = static_cast<const avec4u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixelCount * sizeof(avec4u8)), GL_MAP_READ_BIT));
+            if (mapped != nullptr)
+            {
+                result.pixels.emplace(mapped, mapped + pixelCount);
+                glCheck(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+            glCheck(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            iFreeBuffers.push_back(read->buffer);
+            read = iPending.erase(read);
+        }
+        for (auto& read : completed)
+            read.callback(read.rect, read.pixels ? read.pixels->data() : nullptr);
+    }
 }
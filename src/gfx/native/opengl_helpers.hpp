@@ -26,6 +26,8 @@
 #include <neogfx/gfx/i_rendering_context.hpp>
 #include <neogfx/gfx/i_shader_program.hpp>
 #include <neogfx/gfx/vertex_buffer.hpp>
+#include <neogfx/gfx/range_allocator.hpp>
+#include <neogfx/gfx/buffer_ring.hpp>
 #include "opengl.hpp"
 
 namespace neogfx
@@ -54,6 +56,68 @@ namespace neogfx
         GLuint iHandle;
     };
 
+    class opengl_fence_source : public i_fence_source
+    {
+    public:
+        fence insert_fence() override
+        {
+            GLsync sync;
+            glCheck(sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            return sync;
+        }
+        bool fence_signalled(fence aFence) override
+        {
+            GLenum result;
+            glCheck(result = glClientWaitSync(static_cast<GLsync>(aFence), 0, 0));
+            return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+        }
+        void wait_fence(fence aFence) override
+        {
+            glCheck(glClientWaitSync(static_cast<GLsync>(aFence), GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull));
+        }
+        void delete_fence(fence aFence) override
+        {
+            glCheck(glDeleteSync(static_cast<GLsync>(aFence)));
+        }
+    };
+
+    // Asynchronous framebuffer readback: pixels are packed into a pixel-pack buffer and the callback is
+    // invoked from poll() once the GPU has signalled the fence that follows the read. Pixel-pack buffers
+    // are recycled for later reads.
+    class opengl_pixel_reader
+    {
+    private:
+        struct pack_buffer
+        {
+            GLuint handle;
+            GLsizeiptr capacity;
+        };
+        struct pending_read
+        {
+            pack_buffer buffer;
+            i_fence_source::fence fence;
+            size_i32 extents;
+            neogfx::rect rect;
+            i_render_target::read_pixels_callback callback;
+        };
+        struct completed_read
+        {
+            neogfx::rect rect;
+            i_render_target::read_pixels_callback callback;
+            std::optional<std::vector<avec4u8>> pixels;
+        };
+    public:
+        ~opengl_pixel_reader();
+    public:
+        bool empty() const;
+        void read(const rect_i32& aSource, const rect& aRect, const i_render_target::read_pixels_callback& aCallback);
+        void poll(bool aWait = false);
+    private:
+        opengl_fence_source iFenceSource;
+        std::vector<pending_read> iPending;
+        std::vector<pack_buffer> iFreeBuffers;
+    };
+
     class opengl_buffer_owner
     {
     public:
@@ -155,16 +219,9 @@ namespace neogfx
         }
         std::size_t find_space_for(std::size_t aCount)
         {
-             // todo: optimize
-            for (auto space = iReclaimedSpace.begin(); space != iReclaimedSpace.end(); ++space)
-                if (space->second - space->first >= aCount)
-                {
-                    auto result = space->first;
-                    space->first += aCount;
-                    if (space->first == space->second)
-                        iReclaimedSpace.erase(space);
-                    return result;
-                }
+            auto const space = iReclaimedSpace.allocate(aCount);
+            if (space)
+                return *space;
             return size();
         }
         void push_back(const_reference aValue)
@@ -172,6 +229,7 @@ namespace neogfx
             need(1);
             new (map() + iSize) value_type{ aValue };
             ++iSize;
+            iHighWaterMark = std::max(iHighWaterMark, iSize);
         }
         template <typename... Args>
         void emplace_back(Args&&... aArgs)
@@ -179,6 +237,7 @@ namespace neogfx
             need(1);
             new (map() + iSize) value_type{ std::forward<Args>(aArgs)... };
             ++iSize;
+            iHighWaterMark = std::max(iHighWaterMark, iSize);
         }
         void pop_back()
         {
@@ -186,7 +245,7 @@ namespace neogfx
         }
         void clear()
         {
-            iSize = 0;
+            iSize = (iRing ? iRing->region_begin() : 0);
         }
     public:
         GLuint handle() const
@@ -224,7 +283,7 @@ namespace neogfx
     public:
         size_type room() const
         {
-            return capacity() - size();
+            return (iRing ? iRing->region_end() : capacity()) - size();
         }
         bool room_for(size_type aExtra) const
         {
@@ -232,14 +291,46 @@ namespace neogfx
         }
         void need(size_type aExtra)
         {
-            if (!room_for(aExtra))
-                grow(std::max<size_type>(static_cast<size_type>((capacity() + aExtra) * 1.5), 16384));
+            if (room_for(aExtra))
+                return;
+            // a full ring region is not a reason to grow: callers draw what they have written before asking for more room so moving on to the next fenced region is safe; grow only if a single request would not fit in a region
+            if (iRing && aExtra <= iRing->region_size())
+            {
+                next_region();
+                if (room_for(aExtra))
+                    return;
+            }
+            auto const regions = (iRing ? iRing->region_count() : 1);
+            grow(std::max<size_type>(static_cast<size_type>((capacity() + aExtra * regions) * 1.5), 16384 * regions));
+        }
+    public:
+        std::optional<buffer_ring> const& ring() const
+        {
+            return iRing;
+        }
+        void enable_ring(i_fence_source& aFenceSource, size_type aRegionCount)
+        {
+            iRing.emplace(aFenceSource, capacity(), aRegionCount);
+            iSize = iRing->region_begin();
+        }
+        // fences the region written so far and continues in the next one; only waits if the GPU is still reading that region
+        void next_region()
+        {
+            iRing->advance();
+            iSize = iRing->region_begin();
         }
     public:
         void reclaim(std::size_t aStartIndex, std::size_t aEndIndex)
         {
-            if (aEndIndex != aStartIndex)
-                iReclaimedSpace.push_back(std::make_pair(aStartIndex, aEndIndex));
+            iReclaimedSpace.deallocate(aStartIndex, aEndIndex);
+        }
+        range_allocator const& reclaimed_space() const
+        {
+            return iReclaimedSpace;
+        }
+        size_type high_water_mark() const
+        {
+            return iHighWaterMark;
         }
     private:
         void grow(size_type aCapacity)
@@ -255,7 +346,9 @@ namespace neogfx
             std::swap(iCapacity, temp.iCapacity);
             std::swap(iSize, temp.iSize);
             std::swap(iMemory, temp.iMemory);
-            std::swap(iReclaimedSpace, temp.iReclaimedSpace);
+            // contents are copied to the same indices so reclaimed ranges remain valid in the new buffer
+            if (iRing)
+                iRing->resize(capacity());
             iOwner->buffer_grown();
         }
     private:
@@ -263,8 +356,10 @@ namespace neogfx
         size_type iCapacity = 0;
         size_type iSize = 0;
         mutable pointer iMemory = nullptr;
+        size_type iHighWaterMark = 0;
         opengl_buffer_owner* iOwner = nullptr;
-        std::vector<std::pair<std::size_t, std::size_t>> iReclaimedSpace;
+        range_allocator iReclaimedSpace;
+        std::optional<buffer_ring> iRing;
     };
 
     template <typename T>
@@ -396,13 +491,22 @@ namespace neogfx
             {
                 iParent.execute();
             }
+            void recycle()
+            {
+                iParent.recycle();
+            }
         private:
             opengl_vertex_buffer<vertex_type>& iParent;
         };
+    public:
+        static constexpr std::size_t RingRegionCount = 3u;
     public:
         opengl_vertex_buffer(i_vertex_provider& aProvider, vertex_buffer_type aType) :
             vertex_buffer{ aProvider, aType }, iBuffer{ *this }
         {
+            // non-persistent (per-frame) vertex data is streamed through a fenced ring of regions
+            if ((aType & vertex_buffer_type::Persist) != vertex_buffer_type::Persist)
+                iBuffer.enable_ring(iFenceSource, RingRegionCount);
         }
     public:
         void attach_shader(i_rendering_context& aContext, i_shader_program& aShaderProgram) override
@@ -483,6 +587,33 @@ namespace neogfx
             glCheck(glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull));
             glCheck(glDeleteSync(sync));
         }
+        // make the buffer's space available for new vertices once what has been written so far has been drawn
+        void recycle()
+        {
+            if (iBuffer.ring())
+            {
+                flush();
+                iBuffer.next_region();
+            }
+            else
+            {
+                execute();
+                iBuffer.clear();
+            }
+        }
+        // called at the end of a frame and when another provider's buffer is about to be used: a ring fences what
+        // has been written to its current region (if anything) and moves on to the next one rather than waiting
+        void submit()
+        {
+            flush();
+            if (iBuffer.ring())
+            {
+                if (iBuffer.size() != iBuffer.ring()->region_begin())
+                    iBuffer.next_region();
+            }
+            else
+                execute();
+        }
         void flush()
         {
             flush(vertices().size());
@@ -524,6 +655,7 @@ namespace neogfx
                 iVertexFunction3AttribArray->update(iBuffer);
         }
     private:
+        opengl_fence_source iFenceSource;
         opengl_buffer<vertex_type> iBuffer;
         optional_mat44 iTransformation;
         std::optional<opengl_vertex_array> iVao;
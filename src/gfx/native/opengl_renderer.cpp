@@ -109,6 +109,9 @@ namespace neogfx
     {
         // We explictly destroy these OpenGL objects here when context should still exist
         iVertexBuffers.clear();
+        if (iPixelReader)
+            iPixelReader->poll(true);
+        iPixelReader = std::nullopt;
         iFontManager = std::nullopt;
         iPingPongBuffer1s = std::nullopt;
         iPingPongBuffer2s = std::nullopt;
@@ -266,11 +269,7 @@ namespace neogfx
         if (existing != iVertexBuffers.end())
         {
             if (iLastVertexBufferUsed && iLastVertexBufferUsed != existing)
-            {
-                auto& currentBuffer = (**iLastVertexBufferUsed).second;
-                currentBuffer.flush();
-                currentBuffer.execute();
-            }
+                (**iLastVertexBufferUsed).second.submit();
             iLastVertexBufferUsed = existing;
             return existing->second;
         }
@@ -287,9 +286,22 @@ namespace neogfx
         for (auto& vb : iVertexBuffers)
         {
             auto& buffer = vb.second;
-            buffer.flush();
-            buffer.execute();
+            buffer.submit();
         }
+        poll_pixel_reads();
+    }
+
+    opengl_pixel_reader& opengl_renderer::pixel_reader() const
+    {
+        if (!iPixelReader)
+            iPixelReader.emplace();
+        return *iPixelReader;
+    }
+
+    void opengl_renderer::poll_pixel_reads()
+    {
+        if (iPixelReader && !iPixelReader->empty())
+            iPixelReader->poll();
     }
 
     i_texture& opengl_renderer::ping_pong_buffer1(const size& aExtents, size& aPreviousExtents, texture_sampling aSampling)
@@ -123,6 +123,10 @@ namespace neogfx
         void unregister_frame_counter(i_widget& aWidget, uint32_t aDuration) override;
         uint32_t frame_counter(uint32_t aDuration) const override;
         i_texture& create_ping_pong_buffer(ping_pong_buffers_t& aBufferList, const size& aExtents, size& aPreviousExtents, texture_sampling aSampling);
+    public:
+        opengl_pixel_reader& pixel_reader() const;
+    protected:
+        void poll_pixel_reads();
     private:
         neogfx::renderer iRenderer;
         mutable std::optional<opengl_texture_manager> iTextureManager;
@@ -138,5 +142,6 @@ namespace neogfx
         mutable std::optional<ping_pong_buffers_t> iPingPongBuffer1s;
         mutable std::optional<ping_pong_buffers_t> iPingPongBuffer2s;
         ref_ptr<i_standard_shader_program> iDefaultShaderProgram;
+        mutable std::optional<opengl_pixel_reader> iPixelReader;
     };
 }
\ No newline at end of file
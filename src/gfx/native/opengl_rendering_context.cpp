@@ -28,6 +28,9 @@
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include <neogfx/gfx/text/i_glyph_texture.hpp>
 #include <neogfx/gfx/shapes.hpp>
+#include <neogfx/gfx/line_geometry.hpp>
+#include <neogfx/gfx/path_tessellator.hpp>
+#include <neogfx/gfx/path_stroker.hpp>
 #include <neogfx/gui/widget/i_widget.hpp>
 #include <neogfx/game/rectangle.hpp>
 #include <neogfx/game/text_mesh.hpp>
@@ -107,63 +110,6 @@ namespace neogfx
             std::size_t iPass;
         };
 
-        inline vertices line_loop_to_lines(const vertices& aLineLoop, bool aClosed = true)
-        {
-            vertices result;
-            result.reserve(aLineLoop.size() * 2);
-            for (auto v = aLineLoop.begin(); v != aLineLoop.end(); ++v)
-            {
-                result.push_back(*v);
-                if (v != aLineLoop.begin() && (aClosed || v != std::prev(aLineLoop.end())))
-                    result.push_back(*v);
-            }
-            if (aClosed)
-                result.push_back(*aLineLoop.begin());
-            return result;
-        }
-
-        inline vertices line_strip_to_lines(const vertices& aLineStrip, bool aClosed = true)
-        {
-            return line_loop_to_lines(aLineStrip, false);
-        }
-
-        inline quad line_to_quad(const vec3& aStart, const vec3& aEnd, double aLineWidth)
-        {
-            auto const vecLine = aEnd - aStart;
-            auto const length = vecLine.magnitude();
-            auto const halfWidth = aLineWidth / 2.0;
-            auto const v1 = vec3{ -halfWidth, -halfWidth, 0.0 };
-            auto const v2 = vec3{ -halfWidth, halfWidth, 0.0 };
-            auto const v3 = vec3{ length + halfWidth, halfWidth, 0.0 };
-            auto const v4 = vec3{ length + halfWidth, -halfWidth, 0.0 };
-            auto const r = rotation_matrix(vec3{ 1.0, 0.0, 0.0 }, vecLine);
-            return quad{ aStart + r * v1, aStart + r * v2, aStart + r * v3, aStart + r * v4 };
-        }
-
-        template <typename VerticesIn, typename VerticesOut>
-        inline void lines_to_quads(const VerticesIn& aLines, double aLineWidth, VerticesOut& aQuads)
-        {
-            for (auto v = aLines.begin(); v != aLines.end(); v += 2)
-            {
-                quad const q = line_to_quad(v[0], v[1], aLineWidth);
-                aQuads.insert(aQuads.end(), q.begin(), q.end());
-            }
-        }
-
-        template <typename VerticesIn, typename VerticesOut>
-        inline void quads_to_triangles(const VerticesIn& aQuads, VerticesOut& aTriangles)
-        {
-            for (auto v = aQuads.begin(); v != aQuads.end(); v += 4)
-            {
-                aTriangles.push_back(v[0]);
-                aTriangles.push_back(v[1]);
-                aTriangles.push_back(v[2]);
-                aTriangles.push_back(v[0]);
-                aTriangles.push_back(v[3]);
-                aTriangles.push_back(v[2]);
-            }
-        }
-
         inline GLenum path_shape_to_gl_mode(path_shape aShape)
         {
             switch (aShape)
@@ -210,30 +156,6 @@ namespace neogfx
             return vertices;
         }
 
-        void emit_any_stipple(i_rendering_context& aContext, use_vertex_arrays& aInstance, bool aLoop = false)
-        {
-            // assumes vertices are quads (as two triangles) created with quads_to_triangles above.
-            auto& stippleShader = aContext.rendering_engine().default_shader_program().stipple_shader();
-            if (stippleShader.stipple_active())
-            {
-                auto start = midpoint(aInstance.begin()->xyz, std::next(aInstance.begin())->xyz);
-                auto end = midpoint(std::next(aInstance.begin(), 4)->xyz, std::next(aInstance.begin(), 2)->xyz);
-                stippleShader.start(aContext, start);
-                aInstance.draw(6u);
-                auto positionOffset = 0.0;
-                while (!aInstance.empty())
-                {
-                    positionOffset += start.distance(end);
-                    start = midpoint(aInstance.begin()->xyz, std::next(aInstance.begin())->xyz);
-                    if (aLoop)
-                        positionOffset += start.distance(end);
-                    end = midpoint(std::next(aInstance.begin(), 4)->xyz, std::next(aInstance.begin(), 2)->xyz);
-                    stippleShader.next(aContext, start, positionOffset);
-                    aInstance.draw(6u);
-                }
-            }
-        }
-
         template <typename ColorContainer, typename T>
         inline vec4f to_function(ColorContainer const& aColor, T const& aValue)
         {
@@ -651,8 +573,7 @@ namespace neogfx
                 fill_arcs(opBatch);
                 break;
             case graphics_operation::operation_type::FillPath:
-                for (auto op = opBatch.first; op != opBatch.second; ++op)
-                    fill_path(static_variant_cast<const graphics_operation::fill_path&>(*op).path, static_variant_cast<const graphics_operation::fill_path&>(*op).fill);
+                fill_paths(opBatch);
                 break;
             case graphics_operation::operation_type::FillShape:
                 fill_shapes(opBatch);
@@ -959,12 +880,17 @@ namespace neogfx
         vec3_array<6> triangles;
         quads_to_triangles(quad, triangles);
 
+        thread_local std::vector<float> distances;
+        distances.clear();
+        if (rendering_engine().default_shader_program().stipple_shader().stipple_active())
+            stipple_distances(triangles, distances);
+
         use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, GL_TRIANGLES, triangles.size() };
 
         auto const function = to_function(aPen.color(), basic_rect<float>{ aFrom, aTo });
 
-        for (auto const& v : triangles)
-            vertexArrays.push_back({ v, std::holds_alternative<color>(aPen.color()) ?
+        for (std::size_t i = 0; i < triangles.size(); ++i)
+            vertexArrays.push_back({ triangles[i], std::holds_alternative<color>(aPen.color()) ?
                 vec4f{{
                     static_variant_cast<color>(aPen.color()).red<float>(),
                     static_variant_cast<color>(aPen.color()).green<float>(),
@@ -972,9 +898,10 @@ namespace neogfx
                     static_variant_cast<color>(aPen.color()).alpha<float>() * static_cast<float>(iOpacity)}} :
                 vec4f{},
                 {},
-                function });
-
-        emit_any_stipple(*this, vertexArrays);
+                function,
+                {},
+                {},
+                vec4f{ 0.0f, 0.0f, 0.0f, distances.empty() ? 0.0f : distances[i] } });
     }
 
     void opengl_rendering_context::draw_triangles(const graphics_operation::batch& aDrawTriangleOps)
@@ -1050,12 +977,17 @@ namespace neogfx
         vec3_array<4 * 6> triangles;
         quads_to_triangles(quads, triangles);
 
+        thread_local std::vector<float> distances;
+        distances.clear();
+        if (rendering_engine().default_shader_program().stipple_shader().stipple_active())
+            stipple_distances(triangles, distances);
+
         use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, GL_TRIANGLES, triangles.size() };
 
         auto const function = to_function(aPen.color(), aRect);
 
-        for (auto const& v : triangles)
-            vertexArrays.push_back({ v, std::holds_alternative<color>(aPen.color()) ?
+        for (std::size_t i = 0; i < triangles.size(); ++i)
+            vertexArrays.push_back({ triangles[i], std::holds_alternative<color>(aPen.color()) ?
                 vec4f{{
                     static_variant_cast<color>(aPen.color()).red<float>(),
                     static_variant_cast<color>(aPen.color()).green<float>(),
@@ -1063,9 +995,10 @@ namespace neogfx
                     static_variant_cast<color>(aPen.color()).alpha<float>() * static_cast<float>(iOpacity)}} :
                 vec4f{},
                 {},
-                function });
-
-        emit_any_stipple(*this, vertexArrays);
+                function,
+                {},
+                {},
+                vec4f{ 0.0f, 0.0f, 0.0f, distances.empty() ? 0.0f : distances[i] } });
     }
 
     void opengl_rendering_context::draw_rounded_rects(const graphics_operation::batch& aDrawRoundedRectOps)
@@ -1316,6 +1249,28 @@ namespace neogfx
             rendering_engine().default_shader_program().gradient_shader().set_gradient(*this, static_variant_cast<const neogfx::gradient&>(aPen.color()), iOpacity);
 
         auto const function = to_function(aPen.color(), aPath.bounding_rect());
+        auto const penColor = std::holds_alternative<color>(aPen.color()) ?
+            vec4f{{
+                static_variant_cast<color>(aPen.color()).red<float>(),
+                static_variant_cast<color>(aPen.color()).green<float>(),
+                static_variant_cast<color>(aPen.color()).blue<float>(),
+                static_variant_cast<color>(aPen.color()).alpha<float>() * static_cast<float>(iOpacity)}} :
+            vec4f{};
+
+        if (path_stroker::strokable(aPath))
+        {
+            thread_local path_stroker stroker;
+            auto const stroke = stroker(aPath, aPen);
+            auto const& vertices = stroke->vertices;
+            auto const& distances = stroke->distances;
+            bool const stipple = rendering_engine().default_shader_program().stipple_shader().stipple_active();
+            auto const position = aPath.position().to_vec3();
+            use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, GL_TRIANGLE_STRIP, vertices.size() };
+            for (std::size_t i = 0; i < vertices.size(); ++i)
+                vertexArrays.push_back({ vertices[i] + position, penColor, {}, function, {}, {},
+                    vec4f{ 0.0f, 0.0f, 0.0f, stipple ? distances[i] : 0.0f } });
+            return;
+        }
 
         for (auto const& subPath : aPath.sub_paths())
         {
@@ -1327,15 +1282,7 @@ namespace neogfx
                 {
                     use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, mode, vertices.size() };
                     for (auto const& v : vertices)
-                        vertexArrays.push_back({ v, std::holds_alternative<color>(aPen.color()) ?
-                            vec4f{{
-                                static_variant_cast<color>(aPen.color()).red<float>(),
-                                static_variant_cast<color>(aPen.color()).green<float>(),
-                                static_variant_cast<color>(aPen.color()).blue<float>(),
-                                static_variant_cast<color>(aPen.color()).alpha<float>() * static_cast<float>(iOpacity)}} :
-                            vec4f{},
-                            {},
-                            function });
+                        vertexArrays.push_back({ v, penColor, {}, function });
                 }
             }
         }
@@ -1790,39 +1737,44 @@ namespace neogfx
         }
     }
 
-    void opengl_rendering_context::fill_path(const path& aPath, const brush& aFill)
+    void opengl_rendering_context::fill_paths(const graphics_operation::batch& aFillPathOps)
     {
         use_shader_program usp{ *this, rendering_engine().default_shader_program() };
 
         neolib::scoped_flag snap{ iSnapToPixel, false };
 
-        for (auto const& subPath : aPath.sub_paths())
-        {
-            if (subPath.size() > 2)
-            {
-                if (std::holds_alternative<gradient>(aFill))
-                    rendering_engine().default_shader_program().gradient_shader().set_gradient(*this, static_variant_cast<const gradient&>(aFill), iOpacity);
+        thread_local path_tessellator tessellator;
 
-                GLenum mode;
-                auto vertices = path_vertices(aPath, subPath, 0.0, mode);
+        auto& firstOp = static_variant_cast<const graphics_operation::fill_path&>(*aFillPathOps.first);
 
-                {
-                    use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, mode, vertices.size() };
+        if (std::holds_alternative<gradient>(firstOp.fill))
+            rendering_engine().default_shader_program().gradient_shader().set_gradient(*this, static_variant_cast<const gradient&>(firstOp.fill), iOpacity);
 
-                    auto const function = to_function(aFill, aPath.bounding_rect());
+        {
+            use_vertex_arrays vertexArrays{ as_vertex_provider(), *this, GL_TRIANGLES };
 
-                    for (auto const& v : vertices)
-                    {
-                        vertexArrays.push_back({v, std::holds_alternative<color>(aFill) ?
+            for (auto op = aFillPathOps.first; op != aFillPathOps.second; ++op)
+            {
+                auto& drawOp = static_variant_cast<const graphics_operation::fill_path&>(*op);
+                auto const tessellation = tessellator(drawOp.path);
+                auto const& vertices = tessellation->vertices;
+                auto const position = drawOp.path.position().to_vec3();
+                auto const function = to_function(drawOp.fill, drawOp.path.bounding_rect());
+                if (!vertexArrays.room_for(tessellation->indices.size()))
+                    vertexArrays.draw_and_execute();
+                for (auto vi : tessellation->indices)
+                {
+                    vertexArrays.push_back({
+                        vertices[vi] + position,
+                        std::holds_alternative<color>(drawOp.fill) ?
                             vec4f{{
-                                static_variant_cast<const color&>(aFill).red<float>(),
-                                static_variant_cast<const color&>(aFill).green<float>(),
-                                static_variant_cast<const color&>(aFill).blue<float>(),
-                                static_variant_cast<const color&>(aFill).alpha<float>() * static_cast<float>(iOpacity)}} :
+                                static_variant_cast<const color&>(drawOp.fill).red<float>(),
+                                static_variant_cast<const color&>(drawOp.fill).green<float>(),
+                                static_variant_cast<const color&>(drawOp.fill).blue<float>(),
+                                static_variant_cast<const color&>(drawOp.fill).alpha<float>() * static_cast<float>(iOpacity)}} :
                             vec4f{},
-                            {},
-                            function });
-                    }
+                        {},
+                        function });
                 }
             }
         }
@@ -1976,10 +1928,10 @@ namespace neogfx
                         drawOp.point.x + glyphTexture.placement().x,
                         logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGame ?
                             drawOp.point.y + (glyphTexture.placement().y + -glyphFont.descender()) :
-                            drawOp.point.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.texture().extents().cy
+                            drawOp.point.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.extents().cy
                     } + glyph.offset.as<scalar>();
                     vec3 const glyphOrigin{ glyphOrigin2D.x, glyphOrigin2D.y, drawOp.point.z };
-                    glyphRect = rect{ point{ glyphOrigin }, glyphTexture.texture().extents() };
+                    glyphRect = rect{ point{ glyphOrigin }, glyphTexture.extents() };
                 }
 
                 if (result == std::nullopt)
@@ -2136,7 +2088,7 @@ namespace neogfx
                             drawOp.point.x + glyphTexture.placement().x,
                             logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGame ?
                                 drawOp.point.y + (glyphTexture.placement().y + -glyphFont.descender()) :
-                                drawOp.point.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.texture().extents().cy,
+                                drawOp.point.y + glyphFont.height() - (glyphTexture.placement().y + -glyphFont.descender()) - glyphTexture.extents().cy,
                             drawOp.point.z
                         } + glyph.offset.as<scalar>();
 
@@ -2170,7 +2122,7 @@ namespace neogfx
                                 {
                                     rect const outputRect = {
                                             point{ glyphOrigin } + offsetOrigin + point{ static_cast<coordinate>(offset % scanlineOffsets), static_cast<coordinate>(offset / scanlineOffsets) },
-                                            glyphTexture.texture().extents() };
+                                            glyphTexture.extents() };
                                     auto mesh = logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGui ?
                                         to_ecs_component(
                                             outputRect,
@@ -2199,7 +2151,7 @@ namespace neogfx
                             continue;
                         }
 
-                        rect const outputRect = { point{ glyphOrigin }, glyphTexture.texture().extents() };
+                        rect const outputRect = { point{ glyphOrigin }, glyphTexture.extents() };
                         auto mesh = logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGui ?
                             to_ecs_component(
                                 outputRect,
@@ -2335,8 +2287,8 @@ namespace neogfx
         auto& vertices = vertexBuffer.vertices();
         if (!vertices.room_for(vertexCount - cachedVertexCount))
         {
-            vertexBuffer.execute();
-            vertices.clear();
+            vertexBuffer.recycle();
+            vertices.need(vertexCount - cachedVertexCount);
             for (auto md = aFirst; md != aLast; ++md)
             {
                 auto& meshDrawable = *md;
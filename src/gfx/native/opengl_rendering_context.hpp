@@ -328,7 +328,7 @@ namespace neogfx
         void fill_ellipses(const graphics_operation::batch& aFillEllipseOps);
         void fill_pies(const graphics_operation::batch& aFillPieOps);
         void fill_arcs(const graphics_operation::batch& aFillArcOps);
-        void fill_path(const path& aPath, const brush& aFill);
+        void fill_paths(const graphics_operation::batch& aFillPathOps);
         void fill_shapes(const graphics_operation::batch& aFillShapeOps);
         void draw_glyphs(const graphics_operation::batch& aDrawGlyphOps);
         void draw_glyphs(const draw_glyph* aBegin, const draw_glyph* aEnd);
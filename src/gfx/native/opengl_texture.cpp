@@ -23,6 +23,7 @@
 #include "opengl_error.hpp"
 #include "opengl_helpers.hpp"
 #include "opengl_rendering_context.hpp"
+#include "opengl_renderer.hpp"
 #include "opengl_texture.hpp"
 
 namespace neogfx
@@ -72,6 +73,11 @@ namespace neogfx
             }
         }
 
+        inline std::size_t bytes_per_pixel(texture_data_format aDataFormat, texture_data_type aDataType)
+        {
+            return (aDataFormat == texture_data_format::Red ? 1u : 4u) * (aDataType == texture_data_type::Float ? sizeof(float) : sizeof(uint8_t));
+        }
+
         inline GLenum to_gl_binding_enum(texture_sampling aSampling)
         {
             switch (aSampling)
@@ -103,7 +109,9 @@ namespace neogfx
         iHandle{ 0 },
         iLogicalCoordinateSystem{ neogfx::logical_coordinate_system::AutomaticGame },
         iFrameBuffer{ 0 },
-        iDepthStencilBuffer{ 0 }
+        iDepthStencilBuffer{ 0 },
+        iUploadQueue{ bytes_per_pixel(aDataFormat, kDataType) },
+        iUnpackBuffer{ 0 }
     {
         try
         {
@@ -195,7 +203,9 @@ namespace neogfx
         iHandle{ 0 },
         iLogicalCoordinateSystem{ neogfx::logical_coordinate_system::AutomaticGame },
         iFrameBuffer{ 0 },
-        iDepthStencilBuffer{ 0 }
+        iDepthStencilBuffer{ 0 },
+        iUploadQueue{ bytes_per_pixel(aDataFormat, kDataType) },
+        iUnpackBuffer{ 0 }
     {
         try
         {
@@ -276,6 +286,10 @@ namespace neogfx
             glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
             glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
         }
+        if (iUnpackBuffer != 0)
+        {
+            glCheck(glDeleteBuffers(1, &iUnpackBuffer));
+        }
         glCheck(glDeleteTextures(1, &iHandle));
     }
 
@@ -403,23 +417,70 @@ namespace neogfx
         auto const adjustedRect = aRect + (sampling() != texture_sampling::Data ? point{ 1.0, 1.0 } : point{ 0.0, 0.0 });
         if (sampling() != texture_sampling::Multisample)
         {
-            GLint previousTexture = bind(1);
-            GLint previousPackAlignment;
-            glCheck(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousPackAlignment))
-            glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, aPackAlignment));
-            glCheck(glTexSubImage2D(to_gl_enum(sampling()), 0,
-                static_cast<GLint>(adjustedRect.x), static_cast<GLint>(adjustedRect.y), 
-                static_cast<GLsizei>(adjustedRect.cx), static_cast<GLsizei>(adjustedRect.cy),
-                std::get<1>(to_gl_enum(iDataFormat, kDataType)), std::get<2>(to_gl_enum(iDataFormat, kDataType)), aPixelData));
-            if (sampling() == texture_sampling::NormalMipmap)
+            // staged; applied in one pass (and mipmaps regenerated once) before the texture is next used
+            iUploadQueue.enqueue(adjustedRect.as<uint32_t>(), aPixelData, aPackAlignment);
+            if (iUploadQueue.pending_bytes() >= kMaxPendingUploadBytes)
+                flush_uploads();
+        }
+        else
+            throw unsupported_sampling_type_for_function();
+    }
+
+    template <typename T>
+    void opengl_texture<T>::flush_uploads() const
+    {
+        if (iUploadQueue.empty())
+            return;
+        GLint previousActiveTexture;
+        glCheck(glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture));
+        GLint previousTexture = bind_texture(1);
+        GLint previousUnpackAlignment;
+        glCheck(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment));
+        glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        if (iUnpackBuffer == 0)
+        {
+            glCheck(glGenBuffers(1, &iUnpackBuffer));
+        }
+        glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, iUnpackBuffer));
+        glCheck(glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(iUploadQueue.pending_bytes()), nullptr, GL_STREAM_DRAW));
+        auto const staging = static_cast<std::byte*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(iUploadQueue.pending_bytes()), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (staging != nullptr)
+        {
+            std::size_t offset = 0u;
+            for (auto const& upload : iUploadQueue.uploads())
             {
-                glCheck(glGenerateMipmap(to_gl_enum(sampling())));
+                std::copy(upload.pixels.begin(), upload.pixels.end(), staging + offset);
+                offset += upload.pixels.size();
             }
-            glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, previousPackAlignment));
-            glCheck(glBindTexture(to_gl_enum(sampling()), static_cast<GLuint>(previousTexture)));
+            glCheck(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
         }
         else
-            throw unsupported_sampling_type_for_function();
+        {
+            // no mapping available: upload directly from client memory
+            glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+        std::size_t offset = 0u;
+        for (auto const& upload : iUploadQueue.uploads())
+        {
+            void const* source = staging != nullptr ? reinterpret_cast<void const*>(offset) : upload.pixels.data();
+            glCheck(glTexSubImage2D(to_gl_enum(sampling()), 0,
+                static_cast<GLint>(upload.rect.x), static_cast<GLint>(upload.rect.y),
+                static_cast<GLsizei>(upload.rect.cx), static_cast<GLsizei>(upload.rect.cy),
+                std::get<1>(to_gl_enum(iDataFormat, kDataType)), std::get<2>(to_gl_enum(iDataFormat, kDataType)), source));
+            offset += upload.pixels.size();
+        }
+        if (staging != nullptr)
+        {
+            glCheck(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+        if (sampling() == texture_sampling::NormalMipmap)
+        {
+            glCheck(glGenerateMipmap(to_gl_enum(sampling())));
+        }
+        glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment));
+        glCheck(glBindTexture(to_gl_enum(sampling()), static_cast<GLuint>(previousTexture)));
+        glCheck(glActiveTexture(static_cast<GLenum>(previousActiveTexture)));
+        iUploadQueue.clear();
     }
 
     template <typename T>
@@ -523,6 +584,13 @@ namespace neogfx
 
     template <typename T>
     int32_t opengl_texture<T>::bind(const std::optional<uint32_t>& aTextureUnit) const
+    {
+        flush_uploads();
+        return bind_texture(aTextureUnit);
+    }
+
+    template <typename T>
+    int32_t opengl_texture<T>::bind_texture(const std::optional<uint32_t>& aTextureUnit) const
     {
         if (aTextureUnit != std::nullopt)
             glCheck(glActiveTexture(GL_TEXTURE0 + *aTextureUnit));
@@ -535,6 +603,7 @@ namespace neogfx
     template <typename T>
     intptr_t opengl_texture<T>::native_handle() const
     {
+        flush_uploads();
         return reinterpret_cast<intptr_t>(handle());
     }
 
@@ -652,7 +721,8 @@ namespace neogfx
             TargetActivating.trigger();
             service<i_rendering_engine>().activate_context(*this);
         }
-        bind(10);
+        flush_uploads();
+        bind_texture(10);
         if (iFrameBuffer == 0)
         {
             glCheck(glEnable(GL_MULTISAMPLE));
@@ -736,16 +806,36 @@ namespace neogfx
     template <typename T>
     color opengl_texture<T>::read_pixel(const point& aPosition) const
     {
-        if (sampling() != neogfx::texture_sampling::Multisample)
-        {
-            scoped_render_target srt{ *this };
-            avec4u8 pixel;
-            basic_point<GLint> pos{ aPosition };
-            glCheck(glReadPixels(pos.x + 1, pos.y + 1, 1, 1, std::get<1>(to_gl_enum(iDataFormat, kDataType)), std::get<2>(to_gl_enum(iDataFormat, kDataType)), &pixel));
-            return color{ pixel[0], pixel[1], pixel[2], pixel[3] };
-        }
-        else
-            throw std::logic_error("neogfx::opengl_texture::read_pixel: not yet implemented for multisample render targets");
+        avec4u8 pixel;
+        read_pixels(rect{ aPosition, size{ 1.0, 1.0 } }, &pixel);
+        return color{ pixel[0], pixel[1], pixel[2], pixel[3] };
+    }
+
+    template <typename T>
+    void opengl_texture<T>::read_pixels(const rect& aRect, avec4u8* aPixels) const
+    {
+        if (sampling() == neogfx::texture_sampling::Multisample)
+            throw std::logic_error("neogfx::opengl_texture::read_pixels: not yet implemented for multisample render targets");
+        flush_uploads();
+        scoped_render_target srt{ *this };
+        basic_rect<GLint> const source{ aRect };
+        GLint previousPackAlignment;
+        glCheck(glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment));
+        glCheck(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        glCheck(glReadPixels(source.x + 1, source.y + 1, source.cx, source.cy, GL_RGBA, GL_UNSIGNED_BYTE, aPixels));
+        glCheck(glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment));
+    }
+
+    template <typename T>
+    void opengl_texture<T>::read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const
+    {
+        if (sampling() == neogfx::texture_sampling::Multisample)
+            throw std::logic_error("neogfx::opengl_texture::read_pixels_async: not yet implemented for multisample render targets");
+        flush_uploads();
+        scoped_render_target srt{ *this };
+        basic_rect<GLint> const source{ aRect };
+        static_cast<opengl_renderer&>(service<i_rendering_engine>()).pixel_reader().read(
+            rect_i32{ point_i32{ source.x + 1, source.y + 1 }, size_i32{ source.cx, source.cy } }, aRect, aCallback);
     }
 
     template class opengl_texture<uint8_t>;
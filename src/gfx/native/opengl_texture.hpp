@@ -25,6 +25,7 @@
 #include "i_native_texture.hpp"
 #include <neogfx/gfx/i_image.hpp>
 #include <neogfx/gfx/shader_array.hpp>
+#include <neogfx/gfx/texture_upload_queue.hpp>
 
 namespace neogfx
 {
@@ -46,6 +47,7 @@ namespace neogfx
     public:
         typedef T value_type;
         static constexpr texture_data_type kDataType = crack_shader_array_data_type<value_type>::DATA_TYPE;
+        static constexpr std::size_t kMaxPendingUploadBytes = 16u * 1024u * 1024u;
     public:
         opengl_texture(i_texture_manager& aManager, texture_id aId, const neogfx::size& aExtents, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap, texture_data_format aDataFormat = texture_data_format::RGBA, neogfx::color_space aColorSpace = neogfx::color_space::sRGB, const optional_color& aColor = optional_color());
         opengl_texture(i_texture_manager& aManager, texture_id aId, const i_image& aImage, const rect& aImagePart, texture_data_format aDataFormat = texture_data_format::RGBA);
@@ -111,6 +113,12 @@ namespace neogfx
     public:
         neogfx::color_space color_space() const override;
         color read_pixel(const point& aPosition) const override;
+        void read_pixels(const rect& aRect, avec4u8* aPixels) const override;
+        void read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const override;
+    public:
+        void flush_uploads() const;
+    private:
+        int32_t bind_texture(const std::optional<uint32_t>& aTextureUnit) const;
     private:
         i_texture_manager& iManager;
         texture_id iId;
@@ -127,5 +135,7 @@ namespace neogfx
         std::optional<neogfx::logical_coordinates> iLogicalCoordinates;
         mutable GLuint iFrameBuffer;
         mutable GLuint iDepthStencilBuffer;
+        mutable texture_upload_queue iUploadQueue;
+        mutable GLuint iUnpackBuffer;
     };
 }
\ No newline at end of file
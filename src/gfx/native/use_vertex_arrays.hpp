@@ -229,9 +229,8 @@ namespace neogfx
             void draw_and_execute()
             {
                 draw();
-                execute();
-                vertices().clear();
-				iStart = 0;
+                iUse.recycle();
+                iStart = static_cast<GLint>(vertices().size());
             }
             void execute()
             {
@@ -435,7 +435,10 @@ namespace neogfx
 
         void renderer::render_now()
         {
+            font_manager().trim_glyph_cache();
             service<i_surface_manager>().render_surfaces();
+            // called on every pass of the event loop so pending pixel reads complete even if nothing is rendered
+            poll_pixel_reads();
         }
 
         bool renderer::use_rendering_priority() const
@@ -0,0 +1,373 @@
+// path_stroker.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <neogfx/neogfx.hpp>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <boost/math/constants/constants.hpp>
+#include <neogfx/gfx/path_stroker.hpp>
+
+namespace neogfx
+{
+    namespace
+    {
+        struct direction
+        {
+            scalar x;
+            scalar y;
+            direction normal() const { return direction{ -y, x }; }
+            direction operator-() const { return direction{ -x, -y }; }
+            direction operator*(scalar aScale) const { return direction{ x * aScale, y * aScale }; }
+            direction operator+(const direction& aOther) const { return direction{ x + aOther.x, y + aOther.y }; }
+            scalar dot(const direction& aOther) const { return x * aOther.x + y * aOther.y; }
+            scalar cross(const direction& aOther) const { return x * aOther.y - y * aOther.x; }
+            scalar magnitude() const { return std::sqrt(x * x + y * y); }
+            direction rotated(scalar aAngle) const
+            {
+                auto const c = std::cos(aAngle);
+                auto const s = std::sin(aAngle);
+                return direction{ x * c - y * s, x * s + y * c };
+            }
+        };
+
+        inline point operator+(const point& aPoint, const direction& aOffset)
+        {
+            return point{ aPoint.x + aOffset.x, aPoint.y + aOffset.y };
+        }
+
+        inline direction unit_direction(const point& aFrom, const point& aTo)
+        {
+            direction const d{ aTo.x - aFrom.x, aTo.y - aFrom.y };
+            return d * (1.0 / d.magnitude());
+        }
+
+        // number of segments for an arc of the given angle that keeps within a quarter of a pixel of a true arc
+        inline uint32_t arc_steps(scalar aAngle, scalar aRadius)
+        {
+            auto const step = aRadius > 0.25 ? 2.0 * std::acos(1.0 - 0.25 / aRadius) : boost::math::constants::half_pi<scalar>();
+            return std::max<uint32_t>(1u, static_cast<uint32_t>(std::ceil(aAngle / step)));
+        }
+
+        class strip_builder
+        {
+        public:
+            strip_builder(stroked_path& aResult) :
+                iResult{ aResult },
+                iBridge{ false }
+            {
+            }
+        public:
+            void begin()
+            {
+                if (!iResult.vertices.empty())
+                {
+                    push(iResult.vertices.back(), iResult.distances.back());
+                    iBridge = true;
+                }
+                iFirstPair = std::nullopt;
+            }
+            void add_pair(const point& aLeft, const point& aRight, scalar aDistance)
+            {
+                if (!iFirstPair)
+                    iFirstPair.emplace(aLeft, aRight);
+                push(xyz{ aLeft.x, aLeft.y }, static_cast<float>(aDistance));
+                if (iBridge)
+                {
+                    push(iResult.vertices.back(), iResult.distances.back());
+                    iBridge = false;
+                }
+                push(xyz{ aRight.x, aRight.y }, static_cast<float>(aDistance));
+            }
+            void close(scalar aDistance)
+            {
+                auto const firstPair = *iFirstPair;
+                add_pair(firstPair.first, firstPair.second, aDistance);
+            }
+        private:
+            void push(const vertices::value_type& aVertex, float aDistance)
+            {
+                iResult.vertices.push_back(aVertex);
+                iResult.distances.push_back(aDistance);
+            }
+        private:
+            stroked_path& iResult;
+            bool iBridge;
+            std::optional<std::pair<point, point>> iFirstPair;
+        };
+
+        class line_stroker
+        {
+        public:
+            line_stroker(strip_builder& aStrip, const pen& aPen) :
+                iStrip{ aStrip },
+                iHalfWidth{ aPen.width() / 2.0 },
+                iJoin{ aPen.join() },
+                iCap{ aPen.cap() }
+            {
+            }
+        public:
+            // returns the length of the line
+            scalar stroke(const point* aBegin, const point* aEnd, bool aClosed, scalar aDistance)
+            {
+                thread_local std::vector<point> points;
+                thread_local std::vector<direction> directions;
+                thread_local std::vector<scalar> lengths;
+                points.clear();
+                for (auto p = aBegin; p != aEnd; ++p)
+                    if (points.empty() || points.back() != *p)
+                        points.push_back(*p);
+                if (aClosed && points.size() > 1u && points.front() == points.back())
+                    points.pop_back();
+                if (points.size() < 2u)
+                    return 0.0;
+                if (points.size() < 3u)
+                    aClosed = false;
+                auto const pointCount = points.size();
+                auto const segmentCount = aClosed ? pointCount : pointCount - 1u;
+                directions.clear();
+                lengths.clear();
+                for (std::size_t i = 0u; i < segmentCount; ++i)
+                {
+                    auto const& from = points[i];
+                    auto const& to = points[(i + 1u) % pointCount];
+                    directions.push_back(unit_direction(from, to));
+                    lengths.push_back(std::hypot(to.x - from.x, to.y - from.y));
+                }
+
+                iStrip.begin();
+                auto distance = aDistance;
+                if (aClosed)
+                    join(points[0], directions.back(), directions[0], lengths.back(), lengths[0], distance);
+                else
+                    start_cap(points[0], directions[0], distance);
+                for (std::size_t i = 1u; i < pointCount; ++i)
+                {
+                    auto const& to = points[i];
+                    distance += lengths[i - 1u];
+                    if (aClosed || i + 1u < pointCount)
+                        join(to, directions[i - 1u], directions[i], lengths[i - 1u], lengths[i], distance);
+                    else
+                        end_cap(to, directions[i - 1u], distance);
+                }
+                if (aClosed)
+                {
+                    distance += lengths.back();
+                    iStrip.close(distance);
+                }
+                return distance - aDistance;
+            }
+        private:
+            void start_cap(const point& aPoint, const direction& aDirection, scalar aDistance)
+            {
+                auto const n = aDirection.normal() * iHalfWidth;
+                switch (iCap)
+                {
+                case line_cap::Butt:
+                    iStrip.add_pair(aPoint + n, aPoint + -n, aDistance);
+                    break;
+                case line_cap::Square:
+                    {
+                        auto const p = aPoint + -(aDirection * iHalfWidth);
+                        iStrip.add_pair(p + n, p + -n, aDistance);
+                    }
+                    break;
+                case line_cap::Round:
+                    {
+                        auto const steps = arc_steps(boost::math::constants::half_pi<scalar>(), iHalfWidth);
+                        for (uint32_t step = 0u; step <= steps; ++step)
+                        {
+                            auto const angle = boost::math::constants::half_pi<scalar>() * step / steps;
+                            auto const p = aPoint + -(aDirection * (iHalfWidth * std::cos(angle)));
+                            auto const side = n * std::sin(angle);
+                            iStrip.add_pair(p + side, p + -side, aDistance);
+                        }
+                    }
+                    break;
+                }
+            }
+            void end_cap(const point& aPoint, const direction& aDirection, scalar aDistance)
+            {
+                auto const n = aDirection.normal() * iHalfWidth;
+                switch (iCap)
+                {
+                case line_cap::Butt:
+                    iStrip.add_pair(aPoint + n, aPoint + -n, aDistance);
+                    break;
+                case line_cap::Square:
+                    {
+                        auto const p = aPoint + aDirection * iHalfWidth;
+                        iStrip.add_pair(p + n, p + -n, aDistance);
+                    }
+                    break;
+                case line_cap::Round:
+                    {
+                        auto const steps = arc_steps(boost::math::constants::half_pi<scalar>(), iHalfWidth);
+                        for (uint32_t step = steps + 1u; step-- > 0u;)
+                        {
+                            auto const angle = boost::math::constants::half_pi<scalar>() * step / steps;
+                            auto const p = aPoint + aDirection * (iHalfWidth * std::cos(angle));
+                            auto const side = n * std::sin(angle);
+                            iStrip.add_pair(p + side, p + -side, aDistance);
+                        }
+                    }
+                    break;
+                }
+            }
+            void join(const point& aPoint, const direction& aIn, const direction& aOut, scalar aLengthIn, scalar aLengthOut, scalar aDistance)
+            {
+                auto const nIn = aIn.normal();
+                auto const nOut = aOut.normal();
+                auto const turn = aIn.cross(aOut);
+                if (std::abs(turn) < 1.0e-9 && aIn.dot(aOut) > 0.0)
+                {
+                    iStrip.add_pair(aPoint + nIn * iHalfWidth, aPoint + -(nIn * iHalfWidth), aDistance);
+                    return;
+                }
+                auto const bisector = nIn + nOut;
+                auto const bisectorLength = bisector.magnitude();
+                auto const miter = bisectorLength >= 1.0e-9 ? bisector * (1.0 / bisectorLength) : -aIn;
+                auto const miterLength = bisectorLength >= 1.0e-9 ? iHalfWidth / miter.dot(nIn) : std::numeric_limits<scalar>::infinity();
+                // a bevel or arc too small to see (e.g. between the segments of a dense plot) is mitred instead
+                auto const outsideChord = (nIn + -nOut).magnitude() * iHalfWidth;
+                bool const miterJoin = (iJoin == line_join::Miter && miterLength <= path_stroker::MiterLimit * iHalfWidth) || outsideChord < 0.0625;
+                // the inner offset lines meet within both segments unless the turn is sharp relative to their lengths;
+                // if they don't the join pivots about the point itself, with the segment ends butted
+                auto const innerOffset = miter * miterLength;
+                bool const innerMeets = miterLength < std::numeric_limits<scalar>::infinity() &&
+                    std::abs(innerOffset.dot(aIn)) <= aLengthIn && std::abs(innerOffset.dot(aOut)) <= aLengthOut;
+                if (miterJoin && innerMeets)
+                {
+                    iStrip.add_pair(aPoint + innerOffset, aPoint + -innerOffset, aDistance);
+                    return;
+                }
+                // the inside of the turn is on the left (+normal) side if turning towards it
+                bool const insideLeft = turn > 0.0;
+                scalar const side = insideLeft ? 1.0 : -1.0;
+                auto const inside = innerMeets ? aPoint + innerOffset * side : aPoint;
+                auto const outside = [&](const point& aOutside)
+                {
+                    if (insideLeft)
+                        iStrip.add_pair(inside, aOutside, aDistance);
+                    else
+                        iStrip.add_pair(aOutside, inside, aDistance);
+                };
+                auto const outsideIn = nIn * (-side);
+                if (!innerMeets)
+                    iStrip.add_pair(aPoint + nIn * iHalfWidth, aPoint + -(nIn * iHalfWidth), aDistance);
+                outside(aPoint + outsideIn * iHalfWidth);
+                if (miterJoin)
+                    outside(aPoint + innerOffset * -side);
+                else if (iJoin == line_join::Round)
+                {
+                    auto const angle = std::acos(std::max(-1.0, std::min(1.0, aIn.dot(aOut))));
+                    auto const steps = arc_steps(angle, iHalfWidth);
+                    for (uint32_t step = 1u; step < steps; ++step)
+                        outside(aPoint + outsideIn.rotated((turn > 0.0 ? angle : -angle) * step / steps) * iHalfWidth);
+                }
+                outside(aPoint + nOut * (-side * iHalfWidth));
+                if (!innerMeets)
+                    iStrip.add_pair(aPoint + nOut * iHalfWidth, aPoint + -(nOut * iHalfWidth), aDistance);
+            }
+        private:
+            strip_builder& iStrip;
+            scalar iHalfWidth;
+            line_join iJoin;
+            line_cap iCap;
+        };
+    }
+
+    path_stroker::path_stroker(std::size_t aCacheCapacity) :
+        iCache{ aCacheCapacity }
+    {
+    }
+
+    bool path_stroker::strokable(const path& aPath)
+    {
+        switch (aPath.shape())
+        {
+        case path_shape::Lines:
+        case path_shape::LineStrip:
+        case path_shape::LineLoop:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    stroked_path path_stroker::stroke(const path& aPath, const pen& aPen)
+    {
+        stroked_path result;
+        if (!strokable(aPath))
+            return result;
+        std::size_t pathSize = 0u;
+        for (auto const& subPath : aPath.sub_paths())
+            pathSize += subPath.size();
+        result.vertices.reserve(pathSize * 2u + 8u);
+        result.distances.reserve(pathSize * 2u + 8u);
+        strip_builder strip{ result };
+        line_stroker stroker{ strip, aPen };
+        for (auto const& subPath : aPath.sub_paths())
+        {
+            if (subPath.size() < 2u)
+                continue;
+            auto const begin = &subPath[0];
+            auto const end = begin + subPath.size();
+            if (aPath.shape() == path_shape::Lines)
+            {
+                scalar distance = 0.0;
+                for (auto line = begin; line + 1 < end; line += 2)
+                    distance += stroker.stroke(line, line + 2, false, distance);
+            }
+            else
+                stroker.stroke(begin, end, aPath.shape() == path_shape::LineLoop, 0.0);
+        }
+        return result;
+    }
+
+    path_stroker::result_type path_stroker::operator()(const path& aPath, const pen& aPen)
+    {
+        std::size_t pathSize = 0u;
+        for (auto const& subPath : aPath.sub_paths())
+            pathSize += subPath.size();
+        if (iCache.capacity() == 0u || pathSize > MaxCachedPathSize)
+            return std::make_shared<const stroked_path>(stroke(aPath, aPen));
+        auto pathHash = aPath.outline_hash();
+        pathHash ^= std::hash<dimension>{}(aPen.width()) + 0x9e3779b9u + (pathHash << 6) + (pathHash >> 2);
+        pathHash ^= (static_cast<std::size_t>(aPath.shape()) << 8) ^ (static_cast<std::size_t>(aPen.join()) << 4) ^ static_cast<std::size_t>(aPen.cap());
+        auto const existing = iCache.find(pathHash, [&](const cache_key& aKey)
+        {
+            return aKey.shape == aPath.shape() && aKey.width == aPen.width() && aKey.join == aPen.join() && aKey.cap == aPen.cap() &&
+                aPath.same_outline(aKey.subPaths);
+        });
+        if (existing != nullptr)
+            return *existing;
+        return iCache.insert(pathHash, cache_key{ aPath.shape(), aPen.width(), aPen.join(), aPen.cap(), aPath.sub_paths() },
+            std::make_shared<const stroked_path>(stroke(aPath, aPen)));
+    }
+
+    std::size_t path_stroker::cache_size() const
+    {
+        return iCache.size();
+    }
+
+    void path_stroker::clear_cache()
+    {
+        iCache.clear();
+    }
+}
@@ -0,0 +1,264 @@
+// path_tessellator.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <neogfx/gfx/path_tessellator.hpp>
+
+namespace neogfx
+{
+    namespace
+    {
+        struct edge
+        {
+            point top;
+            point bottom;
+            int32_t winding;
+            scalar x_at(scalar aY) const
+            {
+                if (aY <= top.y)
+                    return top.x;
+                if (aY >= bottom.y)
+                    return bottom.x;
+                return top.x + (bottom.x - top.x) * (aY - top.y) / (bottom.y - top.y);
+            }
+        };
+
+        struct span_edge
+        {
+            edge const* e;
+            scalar xTop;
+            scalar xBottom;
+        };
+
+        inline void hash_combine(std::size_t& aSeed, scalar aValue)
+        {
+            aSeed ^= std::hash<scalar>{}(aValue) + 0x9e3779b9u + (aSeed << 6) + (aSeed >> 2);
+        }
+
+        // closing point of a sub-path is implied
+        inline std::size_t polygon_size(const path::sub_path_type& aSubPath)
+        {
+            auto size = aSubPath.size();
+            if (size > 1u && aSubPath[0] == aSubPath[size - 1u])
+                --size;
+            return size;
+        }
+
+        class trapezoid_sink
+        {
+        public:
+            trapezoid_sink(tessellated_path& aResult) :
+                iResult{ aResult }
+            {
+            }
+        public:
+            void add(scalar aTop, scalar aBottom, scalar aTopLeft, scalar aTopRight, scalar aBottomLeft, scalar aBottomRight)
+            {
+                bool const topWidth = aTopRight > aTopLeft;
+                bool const bottomWidth = aBottomRight > aBottomLeft;
+                if (!topWidth && !bottomWidth)
+                    return;
+                auto const topLeft = index(aTopLeft, aTop);
+                auto const bottomRight = index(aBottomRight, aBottom);
+                if (topWidth)
+                    add_triangle(topLeft, index(aTopRight, aTop), bottomRight);
+                if (bottomWidth)
+                    add_triangle(topLeft, bottomRight, index(aBottomLeft, aBottom));
+            }
+        private:
+            uint32_t index(scalar aX, scalar aY)
+            {
+                auto const key = std::make_pair(aX, aY);
+                auto existing = iVertexIndex.find(key);
+                if (existing != iVertexIndex.end())
+                    return existing->second;
+                auto const newIndex = static_cast<uint32_t>(iResult.vertices.size());
+                iResult.vertices.push_back(xyz{ aX, aY });
+                iVertexIndex.emplace(key, newIndex);
+                return newIndex;
+            }
+            void add_triangle(uint32_t aV0, uint32_t aV1, uint32_t aV2)
+            {
+                iResult.indices.push_back(aV0);
+                iResult.indices.push_back(aV1);
+                iResult.indices.push_back(aV2);
+            }
+        private:
+            struct key_hash
+            {
+                std::size_t operator()(const std::pair<scalar, scalar>& aKey) const
+                {
+                    std::size_t seed = 0u;
+                    hash_combine(seed, aKey.first);
+                    hash_combine(seed, aKey.second);
+                    return seed;
+                }
+            };
+        private:
+            tessellated_path& iResult;
+            std::unordered_map<std::pair<scalar, scalar>, uint32_t, key_hash> iVertexIndex;
+        };
+    }
+
+    path_tessellator::path_tessellator(std::size_t aCacheCapacity) :
+        iCache{ aCacheCapacity }
+    {
+    }
+
+    tessellated_path path_tessellator::tessellate(const path& aPath)
+    {
+        tessellated_path result;
+
+        thread_local std::vector<edge> edges;
+        thread_local std::vector<scalar> ys;
+        edges.clear();
+        ys.clear();
+        for (auto const& subPath : aPath.sub_paths())
+        {
+            auto const size = polygon_size(subPath);
+            if (size < 3u)
+                continue;
+            for (std::size_t i = 0u; i < size; ++i)
+            {
+                auto const& from = subPath[i];
+                auto const& to = subPath[(i + 1u) % size];
+                ys.push_back(from.y);
+                if (from.y == to.y)
+                    continue;
+                if (from.y < to.y)
+                    edges.push_back(edge{ from, to, 1 });
+                else
+                    edges.push_back(edge{ to, from, -1 });
+            }
+        }
+        if (edges.empty())
+            return result;
+
+        std::sort(edges.begin(), edges.end(), [](const edge& lhs, const edge& rhs) { return lhs.top.y < rhs.top.y; });
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+        auto const inside = [&](int32_t aWinding)
+        {
+            return aPath.fill_rule() == fill_rule::EvenOdd ? (aWinding & 1) != 0 : aWinding != 0;
+        };
+        scalar const epsilon = (ys.back() - ys.front()) * 1.0e-9;
+
+        trapezoid_sink sink{ result };
+        thread_local std::vector<edge const*> active;
+        thread_local std::vector<span_edge> spans;
+        active.clear();
+        auto nextEdge = edges.begin();
+        for (std::size_t slab = 0u; slab + 1u < ys.size(); ++slab)
+        {
+            scalar y0 = ys[slab];
+            scalar const y1 = ys[slab + 1u];
+            active.erase(std::remove_if(active.begin(), active.end(), [y0](edge const* e) { return e->bottom.y <= y0; }), active.end());
+            for (; nextEdge != edges.end() && nextEdge->top.y <= y0; ++nextEdge)
+                active.push_back(&*nextEdge);
+            if (active.empty())
+                continue;
+            // split the slab at edge crossings so that within each part the edge order does not change
+            while (y0 < y1)
+            {
+                spans.clear();
+                for (auto e : active)
+                    spans.push_back(span_edge{ e, e->x_at(y0), e->x_at(y1) });
+                std::sort(spans.begin(), spans.end(), [](const span_edge& lhs, const span_edge& rhs)
+                {
+                    return lhs.xTop < rhs.xTop || (lhs.xTop == rhs.xTop && lhs.xBottom < rhs.xBottom);
+                });
+                auto const crossing = [&](std::size_t aLeft) -> std::optional<scalar>
+                {
+                    auto const& left = spans[aLeft];
+                    auto const& right = spans[aLeft + 1u];
+                    if (left.xBottom <= right.xBottom)
+                        return {};
+                    auto const dTop = right.xTop - left.xTop;
+                    auto const dBottom = left.xBottom - right.xBottom;
+                    return y0 + (y1 - y0) * dTop / (dTop + dBottom);
+                };
+                // edges that cross at y0 itself (e.g. where the previous part was split) may be out of order by rounding
+                for (bool swapped = true; swapped;)
+                {
+                    swapped = false;
+                    for (std::size_t i = 0u; i + 1u < spans.size(); ++i)
+                    {
+                        auto const yCross = crossing(i);
+                        if (yCross && *yCross <= y0 + epsilon)
+                        {
+                            std::swap(spans[i], spans[i + 1u]);
+                            swapped = true;
+                        }
+                    }
+                }
+                scalar yBottom = y1;
+                for (std::size_t i = 0u; i + 1u < spans.size(); ++i)
+                {
+                    auto const yCross = crossing(i);
+                    if (yCross && *yCross < yBottom - epsilon)
+                        yBottom = *yCross;
+                }
+                if (yBottom != y1)
+                    for (auto& s : spans)
+                        s.xBottom = s.e->x_at(yBottom);
+                int32_t winding = 0;
+                span_edge const* spanStart = nullptr;
+                for (auto const& s : spans)
+                {
+                    bool const wasInside = inside(winding);
+                    winding += s.e->winding;
+                    bool const isInside = inside(winding);
+                    if (!wasInside && isInside)
+                        spanStart = &s;
+                    else if (wasInside && !isInside)
+                        sink.add(y0, yBottom, spanStart->xTop, s.xTop, spanStart->xBottom, s.xBottom);
+                }
+                y0 = yBottom;
+            }
+        }
+        return result;
+    }
+
+    path_tessellator::result_type path_tessellator::operator()(const path& aPath)
+    {
+        auto const pathHash = aPath.outline_hash() ^ static_cast<std::size_t>(aPath.fill_rule());
+        auto const existing = iCache.find(pathHash, [&](const cache_key& aKey)
+        {
+            return aKey.fillRule == aPath.fill_rule() && aPath.same_outline(aKey.subPaths);
+        });
+        if (existing != nullptr)
+            return *existing;
+        if (iCache.capacity() == 0u)
+            return std::make_shared<const tessellated_path>(tessellate(aPath));
+        return iCache.insert(pathHash, cache_key{ aPath.fill_rule(), aPath.sub_paths() }, std::make_shared<const tessellated_path>(tessellate(aPath)));
+    }
+
+    std::size_t path_tessellator::cache_size() const
+    {
+        return iCache.size();
+    }
+
+    void path_tessellator::clear_cache()
+    {
+        iCache.clear();
+    }
+}
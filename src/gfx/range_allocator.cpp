@@ -0,0 +1,208 @@
+// range_allocator.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2024 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/range_allocator.hpp>
+
+namespace neogfx
+{
+    namespace
+    {
+        // ranges examined in the largest class too small to guarantee a fit before giving up on it
+        std::size_t const kGoodFitScanLimit = 8u;
+
+        inline std::size_t floor_log2(std::size_t aValue)
+        {
+            std::size_t result = 0u;
+            while (aValue >>= 1u)
+                ++result;
+            return result;
+        }
+
+        inline std::size_t lowest_set_bit(std::uint64_t aValue)
+        {
+            std::size_t result = 0u;
+            while ((aValue & 1u) == 0u)
+            {
+                aValue >>= 1u;
+                ++result;
+            }
+            return result;
+        }
+    }
+
+    range_allocator::range_allocator() :
+        iNonEmptyClasses{ 0u }, iFreeSize{ 0u }
+    {
+        iClassHeads.fill(npos);
+    }
+
+    bool range_allocator::empty() const
+    {
+        return iFreeSize == 0u;
+    }
+
+    range_allocator::size_type range_allocator::free_size() const
+    {
+        return iFreeSize;
+    }
+
+    range_allocator::size_type range_allocator::free_range_count() const
+    {
+        return iByStart.size();
+    }
+
+    range_allocator::size_type range_allocator::largest_free_range() const
+    {
+        if (iNonEmptyClasses == 0u)
+            return 0u;
+        size_type result = 0u;
+        for (auto r = iClassHeads[floor_log2(static_cast<std::size_t>(iNonEmptyClasses))]; r != npos; r = iRanges[r].next)
+            result = std::max(result, iRanges[r].end - iRanges[r].start);
+        return result;
+    }
+
+    double range_allocator::fragmentation() const
+    {
+        if (iFreeSize == 0u)
+            return 0.0;
+        return 1.0 - static_cast<double>(largest_free_range()) / static_cast<double>(iFreeSize);
+    }
+
+    range_allocator::statistics range_allocator::stats() const
+    {
+        return statistics{ free_size(), free_range_count(), largest_free_range(), fragmentation() };
+    }
+
+    std::optional<range_allocator::size_type> range_allocator::allocate(size_type aCount)
+    {
+        if (aCount == 0u || iNonEmptyClasses == 0u)
+            return {};
+        auto const exactClass = size_class(aCount);
+        // every range in a class above the request's own class is large enough
+        auto const firstFitClass = exactClass + ((aCount & (aCount - 1u)) != 0u ? 1u : 0u);
+        size_type found = npos;
+        if (firstFitClass < kClassCount)
+        {
+            auto const candidates = iNonEmptyClasses & ~((std::uint64_t{ 1u } << firstFitClass) - 1u);
+            if (candidates != 0u)
+                found = iClassHeads[lowest_set_bit(candidates)];
+        }
+        if (found == npos && firstFitClass != exactClass)
+        {
+            std::size_t scanned = 0u;
+            for (auto r = iClassHeads[exactClass]; r != npos && scanned < kGoodFitScanLimit; r = iRanges[r].next, ++scanned)
+                if (iRanges[r].end - iRanges[r].start >= aCount)
+                {
+                    found = r;
+                    break;
+                }
+        }
+        if (found == npos)
+            return {};
+        auto const start = iRanges[found].start;
+        auto const end = iRanges[found].end;
+        remove(found);
+        if (end - start > aCount)
+            insert(start + aCount, end);
+        return start;
+    }
+
+    void range_allocator::deallocate(size_type aStart, size_type aEnd)
+    {
+        if (aStart > aEnd)
+            throw bad_range();
+        if (aStart == aEnd)
+            return;
+        auto const left = iByEnd.find(aStart);
+        if (left != iByEnd.end())
+        {
+            auto const leftRange = left->second;
+            aStart = iRanges[leftRange].start;
+            remove(leftRange);
+        }
+        auto const right = iByStart.find(aEnd);
+        if (right != iByStart.end())
+        {
+            auto const rightRange = right->second;
+            aEnd = iRanges[rightRange].end;
+            remove(rightRange);
+        }
+        insert(aStart, aEnd);
+    }
+
+    void range_allocator::clear()
+    {
+        iRanges.clear();
+        iUnusedRanges.clear();
+        iClassHeads.fill(npos);
+        iNonEmptyClasses = 0u;
+        iByStart.clear();
+        iByEnd.clear();
+        iFreeSize = 0u;
+    }
+
+    std::size_t range_allocator::size_class(size_type aSize)
+    {
+        return floor_log2(aSize);
+    }
+
+    range_allocator::size_type range_allocator::insert(size_type aStart, size_type aEnd)
+    {
+        size_type range;
+        if (!iUnusedRanges.empty())
+        {
+            range = iUnusedRanges.back();
+            iUnusedRanges.pop_back();
+        }
+        else
+        {
+            range = iRanges.size();
+            iRanges.emplace_back();
+        }
+        auto const sizeClass = size_class(aEnd - aStart);
+        iRanges[range] = free_range{ aStart, aEnd, npos, iClassHeads[sizeClass] };
+        if (iClassHeads[sizeClass] != npos)
+            iRanges[iClassHeads[sizeClass]].previous = range;
+        iClassHeads[sizeClass] = range;
+        iNonEmptyClasses |= (std::uint64_t{ 1u } << sizeClass);
+        iByStart[aStart] = range;
+        iByEnd[aEnd] = range;
+        iFreeSize += (aEnd - aStart);
+        return range;
+    }
+
+    void range_allocator::remove(size_type aRange)
+    {
+        auto const& r = iRanges[aRange];
+        auto const sizeClass = size_class(r.end - r.start);
+        if (r.previous != npos)
+            iRanges[r.previous].next = r.next;
+        else
+            iClassHeads[sizeClass] = r.next;
+        if (r.next != npos)
+            iRanges[r.next].previous = r.previous;
+        if (iClassHeads[sizeClass] == npos)
+            iNonEmptyClasses &= ~(std::uint64_t{ 1u } << sizeClass);
+        iByStart.erase(r.start);
+        iByEnd.erase(r.end);
+        iFreeSize -= (r.end - r.start);
+        iUnusedRanges.push_back(aRange);
+    }
+}
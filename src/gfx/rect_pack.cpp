@@ -1,6 +1,7 @@
 // rect_pack.cpp
 /*
- *  Based on public domain code @ http://blackpawn.com/texts/lightmaps/default.html.
+ *  Originally based on public domain code @ http://blackpawn.com/texts/lightmaps/default.html;
+ *  now a MaxRects packer as described in "A Thousand Ways to Pack the Bin" (Jukka Jylanki).
  *
  *  This implementation written by Leigh Johnston.
  *
@@ -34,56 +35,186 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <optional>
+#include <limits>
 #include <neogfx/gfx/rect_pack.hpp>
 
 namespace neogfx
 {
-    rect_pack::node* rect_pack::node::insert(const size& aElementSize)
+    namespace
     {
-        if (!is_leaf())
+        inline bool contained_in(const rect& aInner, const rect& aOuter)
         {
-            auto result = iChildren[0]->insert(aElementSize);
-            if (result != nullptr)
-                return result;
-            return iChildren[1]->insert(aElementSize);
+            return aInner.x >= aOuter.x && aInner.y >= aOuter.y &&
+                aInner.x + aInner.cx <= aOuter.x + aOuter.cx && aInner.y + aInner.cy <= aOuter.y + aOuter.cy;
         }
-        if (iInUse)
-            return nullptr;
-        if (iRect.extents().cx < aElementSize.cx || iRect.extents().cy < aElementSize.cy)
-            return nullptr;
-        else if (iRect.extents() == aElementSize)
+
+        inline bool overlaps(const rect& aLhs, const rect& aRhs)
         {
-            iInUse = true;
-            return this;
+            return aLhs.x < aRhs.x + aRhs.cx && aRhs.x < aLhs.x + aLhs.cx &&
+                aLhs.y < aRhs.y + aRhs.cy && aRhs.y < aLhs.y + aLhs.cy;
         }
-        auto dw = iRect.width() - aElementSize.cx;
-        auto dh = iRect.height() - aElementSize.cy;
-        neogfx::rect rcChild0 = dw > dh ?
-            neogfx::rect{ iRect.left(), iRect.top(), iRect.left() + aElementSize.cx, iRect.bottom() } :
-            neogfx::rect{ iRect.left(), iRect.top(), iRect.right(), iRect.top() + aElementSize.cy };
-        neogfx::rect rcChild1 = dw > dh ?
-            neogfx::rect{ iRect.left() + aElementSize.cx, iRect.top(), iRect.right(), iRect.bottom() } :
-            neogfx::rect{ iRect.left(), iRect.top() + aElementSize.cy, iRect.right(), iRect.bottom() };
-        iChildren[0] = iAllocator.allocate(1);
-        iChildren[1] = iAllocator.allocate(1);
-        iAllocator.construct(iChildren[0], rcChild0, iAllocator);
-        iAllocator.construct(iChildren[1], rcChild1, iAllocator);
-        return iChildren[0]->insert(aElementSize);
     }
 
     rect_pack::rect_pack(const size& aDimensions) :
-        iRoot{ rect{ point{}, aDimensions }, iAllocator }
+        iDimensions{ aDimensions }, iCount{ 0u }, iUsedArea{ 0.0 }
+    {
+        clear();
+    }
+
+    const size& rect_pack::dimensions() const
+    {
+        return iDimensions;
+    }
+
+    bool rect_pack::empty() const
+    {
+        return iCount == 0u;
+    }
+
+    std::size_t rect_pack::count() const
     {
+        return iCount;
+    }
+
+    dimension rect_pack::used_area() const
+    {
+        return iUsedArea;
+    }
+
+    double rect_pack::occupancy() const
+    {
+        auto const totalArea = iDimensions.cx * iDimensions.cy;
+        return totalArea != 0.0 ? iUsedArea / totalArea : 0.0;
     }
 
     bool rect_pack::insert(const size& aElementSize, rect& aResult)
     {
-        auto result = iRoot.insert(aElementSize);
-        if (result != nullptr)
+        std::optional<free_list::size_type> best;
+        dimension bestShortSide = std::numeric_limits<dimension>::max();
+        dimension bestLongSide = std::numeric_limits<dimension>::max();
+        for (free_list::size_type i = 0; i < iFree.size(); ++i)
+        {
+            auto const& candidate = iFree[i];
+            if (candidate.cx < aElementSize.cx || candidate.cy < aElementSize.cy)
+                continue;
+            auto const dw = candidate.cx - aElementSize.cx;
+            auto const dh = candidate.cy - aElementSize.cy;
+            auto const shortSide = std::min(dw, dh);
+            auto const longSide = std::max(dw, dh);
+            if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                best = i;
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+            }
+        }
+        if (best == std::nullopt)
+            return false;
+        aResult = rect{ iFree[*best].top_left(), aElementSize };
+        prune_free_rects(split_free_rects(aResult));
+        ++iCount;
+        iUsedArea += aElementSize.cx * aElementSize.cy;
+        return true;
+    }
+
+    void rect_pack::remove(const rect& aElement)
+    {
+        if (iCount == 0u)
+            return;
+        --iCount;
+        iUsedArea -= aElement.cx * aElement.cy;
+        if (iCount == 0u)
+        {
+            clear();
+            return;
+        }
+        iFree.push_back(aElement);
+        merge_last_free_rect();
+        prune_free_rects(iFree.size() - 1u);
+    }
+
+    void rect_pack::clear()
+    {
+        iFree.clear();
+        iFree.push_back(rect{ point{}, iDimensions });
+        iCount = 0u;
+        iUsedArea = 0.0;
+    }
+
+    rect_pack::free_list::size_type rect_pack::split_free_rects(const rect& aUsed)
+    {
+        thread_local free_list split;
+        split.clear();
+        iFree.erase(std::remove_if(iFree.begin(), iFree.end(), [&](const rect& aFree)
         {
-            aResult = result->rect();
+            if (!overlaps(aFree, aUsed))
+                return false;
+            if (aUsed.x > aFree.x)
+                split.emplace_back(aFree.x, aFree.y, aUsed.x, aFree.y + aFree.cy);
+            if (aUsed.x + aUsed.cx < aFree.x + aFree.cx)
+                split.emplace_back(aUsed.x + aUsed.cx, aFree.y, aFree.x + aFree.cx, aFree.y + aFree.cy);
+            if (aUsed.y > aFree.y)
+                split.emplace_back(aFree.x, aFree.y, aFree.x + aFree.cx, aUsed.y);
+            if (aUsed.y + aUsed.cy < aFree.y + aFree.cy)
+                split.emplace_back(aFree.x, aUsed.y + aUsed.cy, aFree.x + aFree.cx, aFree.y + aFree.cy);
             return true;
+        }), iFree.end());
+        auto const firstNew = iFree.size();
+        iFree.insert(iFree.end(), split.begin(), split.end());
+        return firstNew;
+    }
+
+    void rect_pack::merge_last_free_rect()
+    {
+        // grow the rectangle just given back by coalescing it with free rectangles that share a complete edge
+        // so that freed space can satisfy requests larger than any of the individual rectangles...
+        for (bool merged = true; merged;)
+        {
+            merged = false;
+            for (free_list::size_type i = 0; i + 1u < iFree.size(); ++i)
+            {
+                auto& last = iFree.back();
+                auto const& other = iFree[i];
+                if (last.y == other.y && last.cy == other.cy && (last.x + last.cx == other.x || other.x + other.cx == last.x))
+                    last = rect{ std::min(last.x, other.x), last.y, std::max(last.x + last.cx, other.x + other.cx), last.y + last.cy };
+                else if (last.x == other.x && last.cx == other.cx && (last.y + last.cy == other.y || other.y + other.cy == last.y))
+                    last = rect{ last.x, std::min(last.y, other.y), last.x + last.cx, std::max(last.y + last.cy, other.y + other.cy) };
+                else
+                    continue;
+                iFree.erase(std::next(iFree.begin(), i));
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    void rect_pack::prune_free_rects(free_list::size_type aFirstNew)
+    {
+        // rectangles before aFirstNew do not contain one another so only pairs involving a new rectangle are checked
+        for (auto i = aFirstNew; i < iFree.size();)
+        {
+            bool redundant = false;
+            for (free_list::size_type j = 0; j < iFree.size();)
+            {
+                if (j != i && contained_in(iFree[i], iFree[j]))
+                {
+                    redundant = true;
+                    break;
+                }
+                if (j != i && contained_in(iFree[j], iFree[i]))
+                {
+                    iFree.erase(std::next(iFree.begin(), j));
+                    if (j < i)
+                        --i;
+                    continue;
+                }
+                ++j;
+            }
+            if (redundant)
+                iFree.erase(std::next(iFree.begin(), i));
+            else
+                ++i;
         }
-        return false;
     }
 }
\ No newline at end of file
@@ -1084,6 +1084,62 @@ namespace neogfx
         return iEmojiAtlas;
     }
 
+    glyph_rendering_mode font_manager::glyph_rendering_mode() const
+    {
+        return iGlyphRenderingMode;
+    }
+
+    void font_manager::set_glyph_rendering_mode(neogfx::glyph_rendering_mode aMode)
+    {
+        iGlyphRenderingMode = aMode;
+    }
+
+    void font_manager::trim_glyph_cache()
+    {
+        // glyphs beyond the cache capacities are released least recently used first; this is only done between frames
+        // as atlas space given back during a frame could be reused while still referenced by glyphs waiting to be drawn
+        if (iGlyphCount > GlyphCacheCapacity)
+        {
+            thread_local std::vector<std::tuple<uint64_t, native_font_face*, glyph_index_t>> byAge;
+            byAge.clear();
+            for (auto const& cacheEntry : iIdCache)
+            {
+                auto& face = static_cast<native_font_face&>(cacheEntry.native_font_face());
+                for (auto const& glyph : face.iGlyphs)
+                    byAge.emplace_back(glyph.second.second, &face, glyph.first);
+            }
+            auto const excess = static_cast<std::ptrdiff_t>(std::min(byAge.size(), iGlyphCount - GlyphCacheCapacity));
+            std::nth_element(byAge.begin(), byAge.begin() + excess, byAge.end(),
+                [](auto const& lhs, auto const& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
+            for (auto glyph = byAge.begin(); glyph != byAge.begin() + excess; ++glyph)
+            {
+                auto& faceGlyphs = std::get<1>(*glyph)->iGlyphs;
+                auto existing = faceGlyphs.find(std::get<2>(*glyph));
+                iGlyphAtlas.destroy_sub_texture(iGlyphAtlas.sub_texture(existing->second.first.texture().atlas_id()));
+                faceGlyphs.erase(existing);
+                --iGlyphCount;
+            }
+            byAge.clear();
+        }
+        if (iSdfGlyphs.size() <= SdfGlyphCacheCapacity)
+            return;
+        thread_local std::vector<sdf_glyph_cache::iterator> byAge;
+        byAge.clear();
+        for (auto glyph = iSdfGlyphs.begin(); glyph != iSdfGlyphs.end(); ++glyph)
+            byAge.push_back(glyph);
+        auto const excess = static_cast<std::ptrdiff_t>(iSdfGlyphs.size() - SdfGlyphCacheCapacity);
+        std::nth_element(byAge.begin(), byAge.begin() + excess, byAge.end(),
+            [](auto const& lhs, auto const& rhs) { return lhs->second.lastUsed < rhs->second.lastUsed; });
+        for (auto glyph = byAge.begin(); glyph != byAge.begin() + excess; ++glyph)
+        {
+            for (auto user : (*glyph)->second.users)
+                user->iSdfGlyphs.erase(std::get<2>((*glyph)->first));
+            iGlyphAtlas.destroy_sub_texture(iGlyphAtlas.sub_texture((*glyph)->second.texture->atlas_id()));
+            iSdfGlyphs.erase(*glyph);
+        }
+        byAge.clear();
+    }
+
     void font_manager::add_ref(font_id aId)
     {
         font_from_id(aId).native_font_face().add_ref();
@@ -22,8 +22,8 @@
 
 namespace neogfx
 {
-    glyph_texture::glyph_texture(const i_sub_texture& aTexture, bool aSubpixel, const point& aPlacement, glyph_pixel_mode aPixelMode) :
-        iTexture(aTexture), iSubpixel{ aSubpixel }, iPlacement{ aPlacement }, iPixelMode{ aPixelMode }
+    glyph_texture::glyph_texture(const i_sub_texture& aTexture, bool aSubpixel, const point& aPlacement, glyph_pixel_mode aPixelMode, scalar aScale) :
+        iTexture(aTexture), iSubpixel{ aSubpixel }, iPlacement{ aPlacement }, iPixelMode{ aPixelMode }, iScale{ aScale }
     {
     }
 
@@ -50,4 +50,9 @@ namespace neogfx
     {
         return iPixelMode;
     }
+
+    scalar glyph_texture::scale() const
+    {
+        return iScale;
+    }
 }
\ No newline at end of file
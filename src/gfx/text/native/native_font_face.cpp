@@ -27,11 +27,12 @@
 #include FT_BITMAP_H
 #include FT_LCD_FILTER_H
 #include FT_ADVANCES_H
+#include FT_SIZES_H
 #include "../../native/opengl.hpp"
 #include "../../native/i_native_texture.hpp"
 #include "native_font_face.hpp"
 #include <neogfx/gfx/text/glyph.hpp>
-#include <neogfx/gfx/text/i_font_manager.hpp>
+#include <neogfx/gfx/text/font_manager.hpp>
 #include <neogfx/gfx/i_texture_atlas.hpp>
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include <neogfx/gfx/graphics_context.hpp>
@@ -43,6 +44,7 @@ namespace neogfx
         typedef std::unordered_map<std::pair<FT_UInt, FT_Int32>, FT_Fixed, boost::hash<std::pair<FT_UInt, FT_Int32>>> get_advance_cache_face;
         typedef std::unordered_map<FT_Face, get_advance_cache_face> get_advance_cache;
         get_advance_cache sGetAdvanceCache;
+        uint64_t sGlyphUse;
     }
 
     bool& kerning_enabled_flag()
@@ -67,7 +69,7 @@ namespace neogfx
     }
 
     native_font_face::native_font_face(FT_Library aFontLib, font_id aId, i_native_font& aFont, font_style aStyle, font::point_size aSize, neogfx::size aDpiResolution, FT_Face aFreetypeFace, hb_face_t* aHarfbuzzFace) :
-        iFontLib{ aFontLib }, iId { aId }, iFont{ aFont }, iStyle{ aStyle }, iStyleName{ aFreetypeFace->style_name }, iSize{ aSize }, iPixelDensityDpi{ aDpiResolution }, iHandle{ *this, aFreetypeFace, aHarfbuzzFace }, iHasKerning{ !!FT_HAS_KERNING(iHandle.freetypeFace) }
+        iFontLib{ aFontLib }, iGlyphAtlas{ service<i_font_manager>().glyph_atlas() }, iId { aId }, iFont{ aFont }, iStyle{ aStyle }, iStyleName{ aFreetypeFace->style_name }, iSize{ aSize }, iPixelDensityDpi{ aDpiResolution }, iHandle{ *this, aFreetypeFace, aHarfbuzzFace }, iHasKerning{ !!FT_HAS_KERNING(iHandle.freetypeFace) }
     {
         switch (aStyle)
         {
@@ -87,6 +89,28 @@ namespace neogfx
 
     native_font_face::~native_font_face()
     {
+        // give the glyphs' atlas space back for reuse; distance field glyphs are shared by all sizes of the font so
+        // their space is only given back once no face of the font uses them (or by font_manager::trim_glyph_cache())
+        for (auto const& glyph : iGlyphs)
+            iGlyphAtlas.destroy_sub_texture(iGlyphAtlas.sub_texture(glyph.second.first.texture().atlas_id()));
+        if (!iGlyphs.empty() || !iSdfGlyphs.empty())
+        {
+            auto& fontManager = static_cast<font_manager&>(service<i_font_manager>());
+            fontManager.iGlyphCount -= iGlyphs.size();
+            for (auto const& glyph : iSdfGlyphs)
+            {
+                auto& users = glyph.second.second->users;
+                users.erase(std::find(users.begin(), users.end(), this));
+                if (users.empty())
+                {
+                    auto sharedGlyph = fontManager.iSdfGlyphs.find(font_manager::sdf_glyph_key{ &iFont, style(), glyph.first });
+                    iGlyphAtlas.destroy_sub_texture(iGlyphAtlas.sub_texture(sharedGlyph->second.texture->atlas_id()));
+                    fontManager.iSdfGlyphs.erase(sharedGlyph);
+                }
+            }
+        }
+        if (iInvalidGlyph != std::nullopt)
+            iGlyphAtlas.destroy_sub_texture(iGlyphAtlas.sub_texture(iInvalidGlyph->texture().atlas_id()));
         if (iHandle.freetypeFace != nullptr)
             sGetAdvanceCache.erase(sGetAdvanceCache.find(iHandle.freetypeFace));
         FT_Done_Face(iHandle.freetypeFace);
@@ -302,9 +326,19 @@ namespace neogfx
         // todo: investigate why turning off sub-pixel doesn't produce same grayscale bitmap as Windows with ClearType disabled
         bool useSubpixelFiltering = true;
 
+        if (service<i_font_manager>().glyph_rendering_mode() == glyph_rendering_mode::SignedDistanceField && !is_bitmap_font())
+        {
+            auto sdfGlyph = sdf_glyph_texture(aGlyph);
+            if (sdfGlyph)
+                return *sdfGlyph;
+        }
+
         auto existingGlyph = iGlyphs.find(aGlyph.value);
         if (existingGlyph != iGlyphs.end())
-            return existingGlyph->second;
+        {
+            existingGlyph->second.second = ++sGlyphUse;
+            return existingGlyph->second.first;
+        }
         try
         {
             try
@@ -371,19 +405,23 @@ namespace neogfx
         if (subTextureWidth == 0)
             return invalid_glyph();
 
-        auto& subTexture = service<i_font_manager>().glyph_atlas().create_sub_texture(
+        auto& fontManager = static_cast<font_manager&>(service<i_font_manager>());
+        auto& subTexture = fontManager.glyph_atlas().create_sub_texture(
             neogfx::size{ static_cast<dimension>(subTextureWidth), static_cast<dimension>(bitmap.rows) }.ceil(),
             1.0, texture_sampling::Normal, pixelMode == glyph_pixel_mode::LCD ? texture_data_format::SubPixel : texture_data_format::Red);
 
         rect glyphRect{ subTexture.atlas_location() };
         i_glyph_texture& glyphTexture = iGlyphs.insert(std::make_pair(aGlyph.value,
-            neogfx::glyph_texture{
-                subTexture,
-                useSubpixelFiltering,
-                point{
-                    iHandle.freetypeFace->glyph->metrics.horiBearingX / 64.0,
-                    (iHandle.freetypeFace->glyph->metrics.horiBearingY - iHandle.freetypeFace->glyph->metrics.height) / 64.0 },
-                pixelMode })).first->second;
+            std::make_pair(
+                neogfx::glyph_texture{
+                    subTexture,
+                    useSubpixelFiltering,
+                    point{
+                        iHandle.freetypeFace->glyph->metrics.horiBearingX / 64.0,
+                        (iHandle.freetypeFace->glyph->metrics.horiBearingY - iHandle.freetypeFace->glyph->metrics.height) / 64.0 },
+                    pixelMode },
+                ++sGlyphUse))).first->second.first;
+        ++fontManager.iGlyphCount;
 
         thread_local std::vector<GLubyte> glyphTextureData;
         thread_local std::vector<std::array<GLubyte, 4>> subpixelGlyphTextureData;
@@ -440,6 +478,86 @@ namespace neogfx
         return glyphTexture;
     }
 
+    i_glyph_texture* native_font_face::sdf_glyph_texture(const glyph& aGlyph) const
+    {
+        auto existingGlyph = iSdfGlyphs.find(aGlyph.value);
+        if (existingGlyph != iSdfGlyphs.end())
+        {
+            existingGlyph->second.second->lastUsed = ++sGlyphUse;
+            return &existingGlyph->second.first;
+        }
+
+        auto& fontManager = static_cast<font_manager&>(service<i_font_manager>());
+
+        // distance fields are shared by every size of this font face; they are rasterised once at a
+        // reference size using a separate FT_Size object so this face's own size is left untouched...
+        auto const activeSize = iHandle.freetypeFace->size;
+        if (iSdfSize == nullptr)
+        {
+            freetypeCheck(FT_New_Size(iHandle.freetypeFace, &iSdfSize));
+            freetypeCheck(FT_Activate_Size(iSdfSize));
+            freetypeCheck(FT_Set_Pixel_Sizes(iHandle.freetypeFace, 0, font_manager::SdfReferencePixelSize));
+            freetypeCheck(FT_Activate_Size(activeSize));
+        }
+
+        font_manager::sdf_glyph_key const key{ &iFont, style(), aGlyph.value };
+        auto sharedGlyph = fontManager.iSdfGlyphs.find(key);
+        if (sharedGlyph == fontManager.iSdfGlyphs.end())
+        {
+            try
+            {
+                freetypeCheck(FT_Activate_Size(iSdfSize));
+                freetypeCheck(FT_Load_Glyph(iHandle.freetypeFace, aGlyph.value, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP));
+                if ((style() & (font_style::EmulatedBold)) == font_style::EmulatedBold)
+                    FT_Outline_Embolden(&iHandle.freetypeFace->glyph->outline, static_cast<FT_Pos>(font_manager::SdfReferencePixelSize * 64 / 16));
+                freetypeCheck(FT_Render_Glyph(iHandle.freetypeFace->glyph, FT_RENDER_MODE_SDF));
+                freetypeCheck(FT_Activate_Size(activeSize));
+            }
+            catch (freetype_error)
+            {
+                FT_Activate_Size(activeSize);
+                return nullptr;
+            }
+
+            FT_GlyphSlot const slot = iHandle.freetypeFace->glyph;
+            FT_Bitmap const& bitmap = slot->bitmap;
+            if (bitmap.width == 0 || bitmap.rows == 0)
+                return nullptr;
+
+            auto& subTexture = fontManager.glyph_atlas().create_sub_texture(
+                neogfx::size{ static_cast<dimension>(bitmap.width), static_cast<dimension>(bitmap.rows) },
+                1.0, texture_sampling::Normal, texture_data_format::Red);
+
+            rect const glyphRect{ subTexture.atlas_location() };
+            thread_local std::vector<GLubyte> glyphTextureData;
+            glyphTextureData.clear();
+            glyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
+            for (uint32_t y = 0; y < bitmap.rows; y++)
+                for (uint32_t x = 0; x < bitmap.width; x++)
+                    glyphTextureData[x + (bitmap.rows - 1 - y) * static_cast<std::size_t>(glyphRect.cx)] = bitmap.buffer[x + bitmap.pitch * y];
+            static_cast<i_native_texture&>(subTexture.native_texture()).set_pixels(glyphRect, &glyphTextureData[0], 1u);
+
+            sharedGlyph = fontManager.iSdfGlyphs.emplace(key, font_manager::sdf_glyph{
+                &subTexture,
+                point{ static_cast<coordinate>(slot->bitmap_left), static_cast<coordinate>(slot->bitmap_top) - static_cast<coordinate>(bitmap.rows) },
+                {},
+                0u }).first;
+        }
+        sharedGlyph->second.users.push_back(this);
+        sharedGlyph->second.lastUsed = ++sGlyphUse;
+
+        scalar const scale = static_cast<scalar>(activeSize->metrics.y_scale) / static_cast<scalar>(iSdfSize->metrics.y_scale);
+        return &iSdfGlyphs.emplace(aGlyph.value,
+            std::make_pair(
+                neogfx::glyph_texture{
+                    *sharedGlyph->second.texture,
+                    false,
+                    sharedGlyph->second.placement * scale,
+                    glyph_pixel_mode::SDF,
+                    scale },
+                &sharedGlyph->second)).first->second.first;
+    }
+
     i_glyph_texture& native_font_face::invalid_glyph() const
     {
         if (iInvalidGlyph == std::nullopt)
@@ -40,6 +40,7 @@
 #include <neogfx/core/geometrical.hpp>
 #include <neogfx/hid/i_surface.hpp>
 #include <neogfx/gfx/text/font.hpp>
+#include <neogfx/gfx/text/font_manager.hpp>
 #include "glyph_texture.hpp"
 #include "i_native_font.hpp"
 #include "i_native_font_face.hpp"
@@ -68,6 +69,7 @@ namespace neogfx
 namespace neogfx
 {
     class i_rendering_engine;
+    class i_texture_atlas;
 
     hb_position_t hb_kerning_func(hb_font_t* font, void* font_data, hb_codepoint_t first_glyph, hb_codepoint_t second_glyph, void* user_data);
 
@@ -104,8 +106,10 @@ namespace neogfx
 
     class native_font_face : public neolib::reference_counted<i_native_font_face>
     {
+        friend class font_manager;
     private:
-        typedef std::unordered_map<glyph_index_t, neogfx::glyph_texture> glyph_map;
+        typedef std::unordered_map<glyph_index_t, std::pair<neogfx::glyph_texture, uint64_t>> glyph_map; // with last use
+        typedef std::unordered_map<glyph_index_t, std::pair<neogfx::glyph_texture, font_manager::sdf_glyph*>> sdf_glyph_map;
         typedef std::pair<glyph_index_t, glyph_index_t> kerning_pair;
         typedef std::unordered_map<kerning_pair, dimension, boost::hash<kerning_pair>, std::equal_to<kerning_pair>,
             boost::fast_pool_allocator<std::pair<const kerning_pair, dimension>>> kerning_table;
@@ -145,10 +149,12 @@ namespace neogfx
         glyph_index_t glyph_index(char32_t aCodePoint) const final;
         i_glyph_texture& glyph_texture(const glyph& aGlyph) const final;
     private:
+        i_glyph_texture* sdf_glyph_texture(const glyph& aGlyph) const;
         i_glyph_texture& invalid_glyph() const;
         void set_metrics();
     private:
         FT_Library iFontLib;
+        i_texture_atlas& iGlyphAtlas;
         font_id iId;
         i_native_font& iFont;
         font_style iStyle;
@@ -159,6 +165,8 @@ namespace neogfx
         std::optional<FT_Size_Metrics> iMetrics;
         mutable ref_ptr<i_native_font_face> iFallbackFont;
         mutable glyph_map iGlyphs;
+        mutable sdf_glyph_map iSdfGlyphs;
+        mutable FT_Size iSdfSize = nullptr;
         bool iHasKerning = false;
         neogfx::kerning_method iKerningMethod = neogfx::kerning_method::Harfbuzz;
         mutable kerning_table iKerningTable;
@@ -80,13 +80,33 @@ namespace neogfx
         auto iterEntry = iEntries.find(aSubTexture.atlas_id());
         if (iterEntry == iEntries.end() || &aSubTexture != &iterEntry->second.second)
             throw sub_texture_not_found();
-        auto rectEntry = iterEntry->second.second.atlas_location();
-        auto space = iterEntry->second.first->second.used.find(rectEntry);
-        if (space != iterEntry->second.first->second.used.end())
-            iterEntry->second.first->second.used.erase(space);
-        iterEntry->second.first->second.freed.insert(rectEntry);
+        auto const page = iterEntry->second.first;
+        auto const& location = iterEntry->second.second.atlas_location();
+        page->second.remove(rect{ location.top_left() - point{ 1.0, 1.0 }, location.extents() + size{ 2.0, 2.0 } });
         iTextureManager.remove_sub_texture(aSubTexture);
         iEntries.erase(iterEntry);
+        if (page->second.empty() && iPages.size() > 1u)
+            iPages.erase(page);
+    }
+
+    uint32_t texture_atlas::page_count() const
+    {
+        return static_cast<uint32_t>(iPages.size());
+    }
+
+    uint32_t texture_atlas::sub_texture_count() const
+    {
+        return static_cast<uint32_t>(iEntries.size());
+    }
+
+    double texture_atlas::occupancy() const
+    {
+        if (iPages.empty())
+            return 0.0;
+        dimension usedArea = 0.0;
+        for (auto const& page : iPages)
+            usedArea += page.second.used_area();
+        return usedArea / (page_size().cx * page_size().cy * iPages.size());
     }
 
     const size& texture_atlas::page_size() const
@@ -96,7 +116,7 @@ namespace neogfx
 
     texture_atlas::pages::iterator texture_atlas::create_page(dimension aDpiScaleFactor, texture_sampling aSampling, texture_data_format aDataFormat)
     {
-        return iPages.insert(iPages.end(), page{ texture{ page_size(), aDpiScaleFactor, aSampling, aDataFormat }, fragments{ page_size() } });
+        return iPages.insert(iPages.end(), page{ texture{ page_size(), aDpiScaleFactor, aSampling, aDataFormat }, rect_pack{ page_size() } });
     }
 
     std::pair<texture_atlas::pages::iterator, rect> texture_atlas::allocate_space(const size& aSize, dimension aDpiScaleFactor, texture_sampling aSampling, texture_data_format aDataFormat)
@@ -0,0 +1,145 @@
+// texture_upload_queue.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2015, 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <neogfx/neogfx.hpp>
+#include <cstring>
+#include <neogfx/gfx/texture_upload_queue.hpp>
+
+namespace neogfx
+{
+    namespace
+    {
+        inline bool contains(rect_u32 const& aOuter, rect_u32 const& aInner)
+        {
+            return aInner.x >= aOuter.x && aInner.y >= aOuter.y &&
+                aInner.x + aInner.cx <= aOuter.x + aOuter.cx && aInner.y + aInner.cy <= aOuter.y + aOuter.cy;
+        }
+
+        inline bool intersects(rect_u32 const& aLhs, rect_u32 const& aRhs)
+        {
+            return aLhs.x < aRhs.x + aRhs.cx && aRhs.x < aLhs.x + aLhs.cx &&
+                aLhs.y < aRhs.y + aRhs.cy && aRhs.y < aLhs.y + aLhs.cy;
+        }
+    }
+
+    texture_upload_queue::texture_upload_queue(size_type aBytesPerPixel) :
+        iBytesPerPixel{ aBytesPerPixel }, iPendingBytes{ 0u }
+    {
+    }
+
+    texture_upload_queue::size_type texture_upload_queue::bytes_per_pixel() const
+    {
+        return iBytesPerPixel;
+    }
+
+    bool texture_upload_queue::empty() const
+    {
+        return iUploads.empty();
+    }
+
+    texture_upload_queue::size_type texture_upload_queue::pending_bytes() const
+    {
+        return iPendingBytes;
+    }
+
+    texture_upload_queue::upload_list const& texture_upload_queue::uploads() const
+    {
+        return iUploads;
+    }
+
+    void texture_upload_queue::enqueue(rect_u32 const& aRect, void const* aPixels, uint32_t aUnpackAlignment)
+    {
+        if (aRect.cx == 0u || aRect.cy == 0u)
+            return;
+        size_type const rowBytes = aRect.cx * iBytesPerPixel;
+        size_type const sourcePitch = (rowBytes + aUnpackAlignment - 1u) / aUnpackAlignment * aUnpackAlignment;
+        upload newUpload{ aRect, std::vector<std::byte>(rowBytes * aRect.cy) };
+        auto const source = static_cast<std::byte const*>(aPixels);
+        for (size_type row = 0u; row < aRect.cy; ++row)
+            std::memcpy(&newUpload.pixels[row * rowBytes], source + row * sourcePitch, rowBytes);
+        for (auto existing = iUploads.begin(); existing != iUploads.end();)
+        {
+            if (contains(aRect, existing->rect))
+            {
+                iPendingBytes -= existing->pixels.size();
+                existing = iUploads.erase(existing);
+            }
+            else
+                ++existing;
+        }
+        iPendingBytes += newUpload.pixels.size();
+        for (auto existing = iUploads.rbegin(); existing != iUploads.rend(); ++existing)
+        {
+            if (merge(*existing, newUpload))
+                return;
+            // merging any further back would reorder this upload before one it overlaps
+            if (intersects(existing->rect, aRect))
+                break;
+        }
+        iUploads.push_back(std::move(newUpload));
+    }
+
+    void texture_upload_queue::clear()
+    {
+        iUploads.clear();
+        iPendingBytes = 0u;
+    }
+
+    bool texture_upload_queue::merge(upload& aTarget, upload& aAddition) const
+    {
+        auto& target = aTarget.rect;
+        auto const& addition = aAddition.rect;
+        if (target.x == addition.x && target.cx == addition.cx)
+        {
+            if (addition.y == target.y + target.cy)
+                aTarget.pixels.insert(aTarget.pixels.end(), aAddition.pixels.begin(), aAddition.pixels.end());
+            else if (addition.y + addition.cy == target.y)
+            {
+                aTarget.pixels.insert(aTarget.pixels.begin(), aAddition.pixels.begin(), aAddition.pixels.end());
+                target.y = addition.y;
+            }
+            else
+                return false;
+            target.cy += addition.cy;
+            return true;
+        }
+        if (target.y == addition.y && target.cy == addition.cy)
+        {
+            bool const append = (addition.x == target.x + target.cx);
+            if (!append && addition.x + addition.cx != target.x)
+                return false;
+            auto const& left = append ? aTarget : aAddition;
+            auto const& right = append ? aAddition : aTarget;
+            size_type const leftRowBytes = left.rect.cx * iBytesPerPixel;
+            size_type const rightRowBytes = right.rect.cx * iBytesPerPixel;
+            std::vector<std::byte> merged(aTarget.pixels.size() + aAddition.pixels.size());
+            for (size_type row = 0u; row < target.cy; ++row)
+            {
+                auto const destination = &merged[row * (leftRowBytes + rightRowBytes)];
+                std::memcpy(destination, &left.pixels[row * leftRowBytes], leftRowBytes);
+                std::memcpy(destination + leftRowBytes, &right.pixels[row * rightRowBytes], rightRowBytes);
+            }
+            aTarget.pixels = std::move(merged);
+            if (!append)
+                target.x = addition.x;
+            target.cx += addition.cx;
+            return true;
+        }
+        return false;
+    }
+}
@@ -368,9 +368,11 @@ namespace neogfx
                     if (cellImage != std::nullopt)
                         aGc.draw_texture(cell_rect(itemIndex, aGc, cell_part::Image), *cellImage);
                     auto cellTextRect = cell_rect(itemIndex, aGc, cell_part::Text);
-                    auto const& glyphText = presentation_model().cell_glyph_text(itemIndex);
+                    auto const glyphText = presentation_model().cell_glyph_text(itemIndex);
                     if (!editing() || editing() != itemIndex)
-                        aGc.draw_glyph_text(cellTextRect.top_left(), glyphText, *textColor);
+                        aGc.draw_glyph_text(cellTextRect.top_left(), *glyphText, *textColor);
+                    // measuring painted cells refines column widths that were estimated from a sample
+                    presentation_model().cell_extents(itemIndex, *this);
                 }
                 if (currentCell)
                 {
@@ -776,6 +778,12 @@ namespace neogfx
 
     void item_view::scroll_page_updated()
     {
+        if (has_presentation_model() && vertical_scrollbar().step() > 0.0)
+        {
+            // keep the shaped text of a few pages of cells
+            auto const visibleRows = static_cast<std::size_t>(std::ceil(item_display_rect().height() / vertical_scrollbar().step())) + 1u;
+            presentation_model().set_glyph_text_cache_capacity(visibleRows * presentation_model().columns() * 4u);
+        }
         layout_items();
     }
 
@@ -1322,8 +1330,8 @@ namespace neogfx
         case cell_part::Text:
             {
                 auto cellRect = cell_rect(aItemIndex);
-                auto const& glyphText = presentation_model().cell_glyph_text(aItemIndex);
-                auto const textHeight = std::max(glyphText.extents().cy,
+                auto const glyphText = presentation_model().cell_glyph_text(aItemIndex);
+                auto const textHeight = std::max(glyphText->extents().cy,
                     (presentation_model().cell_font(aItemIndex) == std::nullopt ? presentation_model().default_font() : *presentation_model().cell_font(aItemIndex)).height());
                 auto const textAdjust = std::floor((cellRect.height() - textHeight) / 2.0);
                 cellRect.deflate(presentation_model().cell_padding(*this).left, textAdjust, presentation_model().cell_padding(*this).right, textAdjust);
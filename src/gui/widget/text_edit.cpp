@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <set>
 #include <boost/algorithm/string/find.hpp>
 #include <neolib/core/scoped.hpp>
 #include <neolib/task/thread.hpp>
@@ -29,12 +30,40 @@
 #include <neogfx/gfx/text/glyph.ipp>
 #include <neogfx/app/i_app.hpp>
 #include <neogfx/app/action.hpp>
+#include <neogfx/app/data_payload.hpp>
 #include <neogfx/core/easing.hpp>
 
 namespace neogfx
 {
     template class basic_glyph_text_content<text_edit::glyph_container_type>;
 
+    namespace
+    {
+        void append_utf8(std::string& aText, char32_t aCodePoint)
+        {
+            if (aCodePoint < 0x80u)
+                aText.push_back(static_cast<char>(aCodePoint));
+            else if (aCodePoint < 0x800u)
+            {
+                aText.push_back(static_cast<char>(0xC0u | (aCodePoint >> 6u)));
+                aText.push_back(static_cast<char>(0x80u | (aCodePoint & 0x3Fu)));
+            }
+            else if (aCodePoint < 0x10000u)
+            {
+                aText.push_back(static_cast<char>(0xE0u | (aCodePoint >> 12u)));
+                aText.push_back(static_cast<char>(0x80u | ((aCodePoint >> 6u) & 0x3Fu)));
+                aText.push_back(static_cast<char>(0x80u | (aCodePoint & 0x3Fu)));
+            }
+            else
+            {
+                aText.push_back(static_cast<char>(0xF0u | (aCodePoint >> 18u)));
+                aText.push_back(static_cast<char>(0x80u | ((aCodePoint >> 12u) & 0x3Fu)));
+                aText.push_back(static_cast<char>(0x80u | ((aCodePoint >> 6u) & 0x3Fu)));
+                aText.push_back(static_cast<char>(0x80u | (aCodePoint & 0x3Fu)));
+            }
+        }
+    }
+
     class text_edit::paragraph_positioned_glyph : public glyph
     {
     public:
@@ -194,17 +223,19 @@ namespace neogfx
                     dimension cy = parent().glyphs().extents(glyph).cy;
                     if (i == glyphsStartIndex || cy != previousHeight)
                     {
-                        iHeights[i] = cy;
+                        iHeights[i - glyphsStartIndex] = cy;
                         previousHeight = cy;
                     }
                 }
-                iHeights[end_index()] = 0.0;
+                iHeights[glyphsEndIndex - glyphsStartIndex] = 0.0;
             }
+            // keys are relative to the paragraph start so the cache survives edits to preceding paragraphs
+            auto const paragraphStart = parent().glyphs().begin() + start_index();
             dimension result = 0.0;
-            auto start = iHeights.lower_bound(aStart - parent().glyphs().begin());
-            if (start != iHeights.begin() && aStart < parent().glyphs().begin() + start->first)
+            auto start = iHeights.lower_bound(aStart - paragraphStart);
+            if (start != iHeights.begin() && aStart < paragraphStart + start->first)
                 --start;
-            auto stop = iHeights.lower_bound(aEnd - parent().glyphs().begin());
+            auto stop = iHeights.lower_bound(aEnd - paragraphStart);
             if (start == stop && stop != iHeights.end())
                 ++stop;
             for (auto i = start; i != stop; ++i)
@@ -218,17 +249,30 @@ namespace neogfx
         vector<glyph_text::size_type> iLineBreaks;
     };
 
+    // lineStart, lineEnd and ypos are only meaningful through the owning glyph_column which applies any
+    // pending shift from an edit to an earlier paragraph
     struct text_edit::glyph_line
     {
-        std::pair<glyph_paragraphs::size_type, glyph_paragraphs::const_iterator> paragraph;
-        std::pair<document_glyphs::size_type, document_glyphs::const_iterator> lineStart;
-        std::pair<document_glyphs::size_type, document_glyphs::const_iterator> lineEnd;
+        glyph_paragraphs::const_iterator paragraph;
+        document_glyphs::size_type lineStart;
+        document_glyphs::size_type lineEnd;
         coordinate ypos;
         size extents;
     };
 
     class text_edit::glyph_column : public column_info
     {
+    private:
+        // Lines from 'from' onwards have still to be moved by an edit made to an earlier paragraph. The move
+        // is applied as lines are read so an edit costs the lines of the paragraphs it changed rather than
+        // every line after them; it is folded into the stored lines only when a later edit lands elsewhere.
+        // The glyph shift uses modular (unsigned) arithmetic so it also encodes moves towards the start.
+        struct line_shift
+        {
+            glyph_lines::size_type from;
+            document_glyphs::size_type glyphs;
+            coordinate ypos;
+        };
     public:
         glyph_column() :
             iWidth(0.0)
@@ -236,11 +280,124 @@ namespace neogfx
         }
     public:
         const glyph_lines& lines() const { return iLines; }
-        glyph_lines& lines() { return iLines; }
         dimension width() const { return iWidth; }
         void set_width(dimension aWidth) { iWidth = aWidth; }
+    public:
+        document_glyphs::size_type line_start(glyph_lines::const_iterator aLine) const
+        {
+            return aLine->lineStart + (shifted(aLine) ? iShift->glyphs : 0u);
+        }
+        document_glyphs::size_type line_end(glyph_lines::const_iterator aLine) const
+        {
+            return aLine->lineEnd + (shifted(aLine) ? iShift->glyphs : 0u);
+        }
+        coordinate line_ypos(glyph_lines::const_iterator aLine) const
+        {
+            return aLine->ypos + (shifted(aLine) ? iShift->ypos : 0.0);
+        }
+        dimension lines_width() const
+        {
+            return iLineWidths.empty() ? 0.0 : *iLineWidths.rbegin();
+        }
+        glyph_lines::const_iterator line_at_ypos(coordinate aYpos) const
+        {
+            return partition_point([&](glyph_lines::const_iterator aLine) { return line_ypos(aLine) < aYpos; });
+        }
+        glyph_lines::const_iterator line_at_glyph(document_glyphs::size_type aGlyph) const
+        {
+            return partition_point([&](glyph_lines::const_iterator aLine) { return line_start(aLine) < aGlyph; });
+        }
+    public:
+        void clear_lines()
+        {
+            iLines.clear();
+            iLineWidths.clear();
+            iShift = std::nullopt;
+        }
+        void append_lines(glyph_lines const& aLines)
+        {
+            replace_lines(iLines.end(), iLines.end(), aLines, 0u, 0.0);
+        }
+        // Replaces [aFirst, aLast) with aLines (positioned for the document as it is now) and moves the lines
+        // after them by aGlyphs/aYpos.
+        void replace_lines(glyph_lines::const_iterator aFirst, glyph_lines::const_iterator aLast, glyph_lines const& aLines, document_glyphs::size_type aGlyphs, coordinate aYpos)
+        {
+            auto const first = static_cast<glyph_lines::size_type>(aFirst - iLines.begin());
+            auto const last = static_cast<glyph_lines::size_type>(aLast - iLines.begin());
+            auto shift = iShift.value_or(line_shift{ last, 0u, 0.0 });
+            for (auto line = aFirst; line != aLast; ++line)
+                iLineWidths.erase(iLineWidths.find(line->extents.cx));
+            for (auto const& line : aLines)
+                iLineWidths.insert(line.extents.cx);
+            if (last == iLines.size() && shift.from <= first)
+            {
+                // appending: store the new lines relative to the pending shift rather than folding it in
+                iLines.erase(iLines.begin() + first, iLines.end());
+                for (auto const& line : aLines)
+                    iLines.push_back(glyph_line{ line.paragraph, line.lineStart - shift.glyphs, line.lineEnd - shift.glyphs, line.ypos - shift.ypos, line.extents });
+                if (shift.from == iLines.size())
+                    iShift = std::nullopt;
+                return;
+            }
+            // lines before the replaced range keep their current shift and lines between the replaced range and 
+            // the start of the current shift only receive the new one; both are folded into the stored lines
+            if (shift.from < first)
+                move_lines(shift.from, first, shift.glyphs, shift.ypos);
+            if (shift.from > last)
+                move_lines(last, shift.from, aGlyphs, aYpos);
+            auto const from = std::max(shift.from, last) - last + first + aLines.size();
+            iLines.erase(iLines.begin() + first, iLines.begin() + last);
+            iLines.insert(iLines.begin() + first, aLines.begin(), aLines.end());
+            shift = line_shift{ from, shift.glyphs + aGlyphs, shift.ypos + aYpos };
+            if (shift.from < iLines.size() && (shift.glyphs != 0u || shift.ypos != 0.0))
+                iShift = shift;
+            else
+                iShift = std::nullopt;
+        }
+        void move_all_lines(coordinate aYpos)
+        {
+            if (iShift != std::nullopt)
+                move_lines(iShift->from, iLines.size(), iShift->glyphs, iShift->ypos);
+            iShift = std::nullopt;
+            move_lines(0u, iLines.size(), 0u, aYpos);
+        }
+    private:
+        bool shifted(glyph_lines::const_iterator aLine) const
+        {
+            return iShift != std::nullopt && static_cast<glyph_lines::size_type>(aLine - iLines.begin()) >= iShift->from;
+        }
+        template <typename Predicate>
+        glyph_lines::const_iterator partition_point(Predicate aBefore) const
+        {
+            auto first = iLines.begin();
+            auto count = iLines.size();
+            while (count > 0u)
+            {
+                auto const step = count / 2u;
+                auto const middle = first + step;
+                if (aBefore(middle))
+                {
+                    first = middle + 1;
+                    count -= step + 1u;
+                }
+                else
+                    count = step;
+            }
+            return first;
+        }
+        void move_lines(glyph_lines::size_type aFrom, glyph_lines::size_type aTo, document_glyphs::size_type aGlyphs, coordinate aYpos)
+        {
+            for (auto line = iLines.begin() + aFrom; line != iLines.begin() + aTo; ++line)
+            {
+                line->lineStart += aGlyphs;
+                line->lineEnd += aGlyphs;
+                line->ypos += aYpos;
+            }
+        }
     private:
         glyph_lines iLines;
+        std::optional<line_shift> iShift;
+        std::multiset<dimension> iLineWidths;
         dimension iWidth;
     };
 
@@ -670,7 +827,8 @@ namespace neogfx
         }, std::chrono::milliseconds{ 16 } },
         iSuppressTextChangedNotification{ 0u },
         iWantedToNotfiyTextChanged{ 0u },
-        iOutOfMemory{ false }
+        iOutOfMemory{ false },
+        iCursorVisibilityPending{ false }
     {
         init();
     }
@@ -691,7 +849,8 @@ namespace neogfx
         }, std::chrono::milliseconds{ 16 } },
         iSuppressTextChangedNotification{ 0u },
         iWantedToNotfiyTextChanged{ 0u },
-        iOutOfMemory{ false }
+        iOutOfMemory{ false },
+        iCursorVisibilityPending{ false }
     {
         init();
     }
@@ -712,7 +871,8 @@ namespace neogfx
         }, std::chrono::milliseconds{ 16 } },
         iSuppressTextChangedNotification{ 0u },
         iWantedToNotfiyTextChanged{ 0u },
-        iOutOfMemory{ false }
+        iOutOfMemory{ false },
+        iCursorVisibilityPending{ false }
     {
         init();
     }
@@ -796,20 +956,19 @@ namespace neogfx
             scoped_scissor scissor2{ aGc, columnClipRect };
             auto const& columnRectSansPadding = column_rect(columnIndex);
             auto const& lines = column.lines();
-            auto line = std::lower_bound(lines.begin(), lines.end(), glyph_line{ {}, {}, {}, vertical_scrollbar().position(), {} },
-                [](const glyph_line& left, const glyph_line& right) { return left.ypos < right.ypos; });
-            if (line != lines.begin() && (line == lines.end() || line->ypos > vertical_scrollbar().position()))
+            auto line = column.line_at_ypos(vertical_scrollbar().position());
+            if (line != lines.begin() && (line == lines.end() || column.line_ypos(line) > vertical_scrollbar().position()))
                 --line;
             if (line == lines.end())
                 continue;
             for (auto paintLine = line; paintLine != lines.end(); paintLine++)
             {
-                point linePos = columnRectSansPadding.top_left() + point{ -horizontal_scrollbar().position(), paintLine->ypos - vertical_scrollbar().position() };
+                point linePos = columnRectSansPadding.top_left() + point{ -horizontal_scrollbar().position(), column.line_ypos(paintLine) - vertical_scrollbar().position() };
                 if (linePos.y + paintLine->extents.cy < columnRectSansPadding.top() || linePos.y + paintLine->extents.cy < update_rect().top())
                     continue;
                 if (linePos.y > columnRectSansPadding.bottom() || linePos.y > update_rect().bottom())
                     break;
-                auto textDirection = glyph_text_direction(paintLine->lineStart.second, paintLine->lineEnd.second);
+                auto textDirection = glyph_text_direction(glyphs().begin() + column.line_start(paintLine), glyphs().begin() + column.line_end(paintLine));
                 if (((Alignment & alignment::Horizontal) == alignment::Left && textDirection == text_direction::RTL) ||
                     ((Alignment & alignment::Horizontal) == alignment::Right && textDirection == text_direction::LTR))
                     linePos.x += aGc.from_device_units(size{ columnRectSansPadding.width() - paintLine->extents.cx, 0.0 }).cx;
@@ -1313,27 +1472,39 @@ namespace neogfx
     {
         if (cursor().position() != cursor().anchor())
         {
-            std::u32string selectedText;
-            auto selectionStart = std::min(cursor().position(), cursor().anchor());
-            auto selectionEnd = std::max(cursor().position(), cursor().anchor());
-            selectedText.assign(iText.begin() + selectionStart, iText.begin() + selectionEnd);
-            for (auto sti = selectedText.begin(); sti != selectedText.end();)
+            // the selection is encoded as UTF-8 straight from the piece table into the payload's buffer
+            auto const selectionStart = iText.begin() + std::min(cursor().position(), cursor().anchor());
+            auto const selectionEnd = iText.begin() + std::max(cursor().position(), cursor().anchor());
+            std::string selectedText;
+            selectedText.reserve(selectionEnd - selectionStart);
+            for (auto sti = selectionStart; sti != selectionEnd;)
             {
-                auto const ch = *sti++;
-                if (ch == U'\r' && (sti == selectedText.end() || *sti != U'\n'))
-                    *std::prev(sti) = U'\n';
+                auto ch = *sti++;
+                if (ch == U'\r' && (sti == selectionEnd || *sti != U'\n'))
+                    ch = U'\n';
+                append_utf8(selectedText, ch);
             }
-            aClipboard.set_text(string{ neolib::utf32_to_utf8(selectedText) });
+            aClipboard.set_payload(ref_ptr<i_data_payload>{ make_ref<shared_buffer_payload>(TextPlainMimeType, std::move(selectedText)) });
         }
     }
 
     void text_edit::paste(i_clipboard& aClipboard)
     {
+        if (!aClipboard.has_payload(TextPlainMimeType))
+            return;
+        // the payload's data is read directly; text copied within this process shares the copier's buffer
+        auto const payload = aClipboard.payload(TextPlainMimeType);
+        std::string readText;
+        std::string_view pastedText;
+        if (payload->shared())
+            pastedText = std::string_view{ static_cast<char const*>(payload->shared_data()), static_cast<std::size_t>(payload->size()) };
+        else
+            pastedText = readText = payload->to_std_string();
         {
             multiple_text_changes mtc{ *this };
             if (cursor().position() != cursor().anchor())
                 delete_selected();
-            auto len = insert_text(aClipboard.text(), next_style());
+            auto len = insert_text(string{ pastedText }, next_style());
             cursor().set_position(cursor().position() + len);
         }
     }
@@ -1477,7 +1648,7 @@ namespace neogfx
                 if (currentPosition.line != currentPosition.column->lines().begin())
                 {
                     auto const columnRectSansPadding = column_rect(column_index(*currentPosition.column));
-                    auto const cursorPos = point{ *iCursorHint.x, std::prev(currentPosition.line)->ypos } + columnRectSansPadding.top_left();
+                    auto const cursorPos = point{ *iCursorHint.x, currentPosition.column->line_ypos(std::prev(currentPosition.line)) } + columnRectSansPadding.top_left();
                     auto const glyph = document_hit_test(cursorPos, false);
                     cursor().set_position(from_glyph(glyphs().begin() + glyph).first, aMoveAnchor);
                 }
@@ -1491,7 +1662,7 @@ namespace neogfx
                     if (std::next(currentPosition.line) != currentPosition.column->lines().end())
                     {
                         auto const columnRectSansPadding = column_rect(column_index(*currentPosition.column));
-                        auto const cursorPos = point{ *iCursorHint.x, std::next(currentPosition.line)->ypos } + columnRectSansPadding.top_left();
+                        auto const cursorPos = point{ *iCursorHint.x, currentPosition.column->line_ypos(std::next(currentPosition.line)) } + columnRectSansPadding.top_left();
                         auto const glyph = document_hit_test(cursorPos, false);
                         cursor().set_position(from_glyph(glyphs().begin() + glyph).first, aMoveAnchor);
                     }
@@ -1751,8 +1922,7 @@ namespace neogfx
         glyph_lines::const_iterator line;
         for (; column != iGlyphColumns.end(); ++column)
         {
-            line = std::lower_bound(column->lines().begin(), column->lines().end(), glyph_line{ {}, { aGlyphPosition, glyphs().begin() + aGlyphPosition }, {}, 0.0, {} },
-                [](const glyph_line& left, const glyph_line& right) { return left.lineStart.first < right.lineStart.first; });
+            line = column->line_at_glyph(aGlyphPosition);
             if (line != column->lines().end())
                 break;
         }
@@ -1772,17 +1942,16 @@ namespace neogfx
         {
             if (line == lines.end())
             {
-                auto const& lastLine = lines.back();
-                if (aGlyphPosition <= lastLine.lineEnd.first)
+                if (aGlyphPosition <= column->line_end(std::prev(lines.end())))
                     --line;
             }
-            else if (aGlyphPosition < line->lineStart.first)
+            else if (aGlyphPosition < column->line_start(line))
                 --line;
         }
         if (line != lines.end())
         {
-            position_type lineStart = line->lineStart.first;
-            position_type lineEnd = line->lineEnd.first;
+            position_type lineStart = column->line_start(line);
+            position_type lineEnd = column->line_end(line);
             bool placeCursorToRight = (aGlyphPosition == lineEnd);
             if (aForCursor)
             {
@@ -1807,7 +1976,7 @@ namespace neogfx
             if (aGlyphPosition >= lineStart && aGlyphPosition <= lineEnd)
             {
                 delta alignmentAdjust;
-                auto textDirection = glyph_text_direction(lines.back().lineStart.second, lines.back().lineEnd.second);
+                auto textDirection = glyph_text_direction(glyphs().begin() + column->line_start(std::prev(lines.end())), glyphs().begin() + column->line_end(std::prev(lines.end())));
                 if (((Alignment & alignment::Horizontal) == alignment::Left && textDirection == text_direction::RTL) ||
                     ((Alignment & alignment::Horizontal) == alignment::Right && textDirection == text_direction::LTR))
                     alignmentAdjust.dx = columnRectSansPadding.cx - line->extents.cx;
@@ -1817,26 +1986,27 @@ namespace neogfx
                 {
                     auto iterGlyph = glyphs().begin() + aGlyphPosition;
                     auto const& glyph = aGlyphPosition < lineEnd ? *iterGlyph : *(iterGlyph - 1);
-                    point linePos{ glyph.x - line->lineStart.second->x, line->ypos };
+                    point linePos{ glyph.x - glyphs()[lineStart].x, column->line_ypos(line) };
                     if (placeCursorToRight)
                         linePos.x += advance(glyph).cx;
                     return position_info{ iterGlyph, column, line, glyphs().begin() + lineStart, glyphs().begin() + lineEnd, linePos + alignmentAdjust };
                 }
                 else
-                    return position_info{ line->lineStart.second, column, line, glyphs().begin() + lineStart, glyphs().begin() + lineEnd, point{ 0.0, line->ypos } + alignmentAdjust };
+                    return position_info{ glyphs().begin() + lineStart, column, line, glyphs().begin() + lineStart, glyphs().begin() + lineEnd, point{ 0.0, column->line_ypos(line) } + alignmentAdjust };
             }
         }
         point pos;
         if (!lines.empty())
         {
             pos.x = 0.0;
-            auto textDirection = glyph_text_direction(lines.back().lineStart.second, lines.back().lineEnd.second);
+            auto const lastLine = std::prev(lines.end());
+            auto textDirection = glyph_text_direction(glyphs().begin() + column->line_start(lastLine), glyphs().begin() + column->line_end(lastLine));
             if (((Alignment & alignment::Horizontal) == alignment::Left && textDirection == text_direction::RTL) ||
                 ((Alignment & alignment::Horizontal) == alignment::Right && textDirection == text_direction::LTR))
                 pos.x = columnRectSansPadding.cx;
             else if ((Alignment & alignment::Horizontal) == alignment::Center)
                 pos.x = columnRectSansPadding.cx / 2.0;
-            pos.y = lines.back().ypos + lines.back().extents.cy;
+            pos.y = column->line_ypos(lastLine) + lastLine->extents.cy;
         }
         return position_info{ glyphs().end(), column, lines.end(), glyphs().end(), glyphs().end(), pos };
     }
@@ -1864,16 +2034,16 @@ namespace neogfx
         point adjustedPosition = (aAdjustForScrollPosition ? aPosition + point{ horizontal_scrollbar().position(), vertical_scrollbar().position() } : aPosition) - columnRectSansPadding.top_left();
         adjustedPosition = adjustedPosition.max(point{});
         auto const& lines = column.lines();
-        auto line = std::lower_bound(lines.begin(), lines.end(), glyph_line{ {}, {}, {}, adjustedPosition.y, {} },
-            [](const glyph_line& left, const glyph_line& right) { return left.ypos < right.ypos; });
-        if (line == lines.end() && !lines.empty() && adjustedPosition.y < lines.back().ypos + lines.back().extents.cy)
+        auto line = column.line_at_ypos(adjustedPosition.y);
+        if (line == lines.end() && !lines.empty() && adjustedPosition.y < column.line_ypos(std::prev(lines.end())) + lines.back().extents.cy)
             --line;
         if (line != lines.end())
         {
-            if (line != lines.begin() && adjustedPosition.y < line->ypos)
+            if (line != lines.begin() && adjustedPosition.y < column.line_ypos(line))
                 --line;
             delta alignmentAdjust;
-            auto textDirection = glyph_text_direction(lines.back().lineStart.second, lines.back().lineEnd.second);
+            auto const lastLine = std::prev(lines.end());
+            auto textDirection = glyph_text_direction(glyphs().begin() + column.line_start(lastLine), glyphs().begin() + column.line_end(lastLine));
             if (((Alignment & alignment::Horizontal) == alignment::Left && textDirection == text_direction::RTL) ||
                 ((Alignment & alignment::Horizontal) == alignment::Right && textDirection == text_direction::LTR))
                 alignmentAdjust.dx = columnRectSansPadding.cx - line->extents.cx;
@@ -1881,10 +2051,10 @@ namespace neogfx
                 alignmentAdjust.dx = (columnRectSansPadding.cx - line->extents.cx) / 2.0;
             adjustedPosition.x -= alignmentAdjust.dx;
             adjustedPosition = adjustedPosition.max(point{});
-            auto lineStart = (line != lines.end() ? line->lineStart.first : glyphs().size());
-            auto lineEnd = (line != lines.end() ? line->lineEnd.first : glyphs().size());
-            auto lineStartX = line->lineStart.second->x;
-            for (auto gi = line->lineStart.first; gi != lineEnd; ++gi)
+            auto lineStart = (line != lines.end() ? column.line_start(line) : glyphs().size());
+            auto lineEnd = (line != lines.end() ? column.line_end(line) : glyphs().size());
+            auto lineStartX = (lineStart < glyphs().size() ? glyphs()[lineStart].x : 0.0);
+            for (auto gi = lineStart; gi != lineEnd; ++gi)
             {
                 auto& glyph = glyphs()[gi];
                 auto const glyphAdvance = advance(glyph).cx;
@@ -1954,8 +2124,11 @@ namespace neogfx
         iText.clear();
         glyphs().clear();
         iGlyphParagraphs.clear();
+        clear_paragraph_caches();
+        iLayoutPending = std::nullopt;
         for (std::size_t i = 0; i < iGlyphColumns.size(); ++i)
-            iGlyphColumns[i].lines().clear();
+            iGlyphColumns[i].clear_lines();
+        invalidate_lines();
         iUtf8TextCache = std::nullopt;
         refresh_columns();
         if (iPreviousText != iText)
@@ -1967,6 +2140,11 @@ namespace neogfx
         return std::count(text().begin(), text().end(), '\n') + 1;
     }
 
+    bool text_edit::layout_complete() const
+    {
+        return iLayoutPending == std::nullopt;
+    }
+
     void text_edit::delete_paragraph(std::size_t aParagraphIndex)
     {
         if (paragraph_count() > 1)
@@ -1984,7 +2162,9 @@ namespace neogfx
     {
         if (iUtf8TextCache == std::nullopt)
         {
-            std::u32string u32text{ iText.begin(), iText.end() };
+            std::u32string u32text;
+            u32text.reserve(iText.size());
+            iText.visit([&](char32_t const* aData, std::size_t aLength, document_text::tag_type const&) { u32text.append(aData, aLength); });
             iUtf8TextCache = neolib::utf32_to_utf8(u32text);
         }
         return *iUtf8TextCache;
@@ -2216,7 +2396,18 @@ namespace neogfx
         {
             iNextStyle = std::nullopt;
             iCursorAnimationStartTime = neolib::thread::program_elapsed_ms();
-            make_cursor_visible();
+            // a cursor beyond the laid out text is scrolled to its estimated position rather than laying out the
+            // text up to it now; animate() makes it visible once layout has caught up
+            iCursorVisibilityPending = false;
+            if (iLayoutPending != std::nullopt && cursor().position() > *iLayoutPending)
+                continue_layout(0u);
+            if (iLayoutPending != std::nullopt && cursor().position() > *iLayoutPending && iTextExtents)
+            {
+                iCursorVisibilityPending = true;
+                vertical_scrollbar().set_position(std::floor(iTextExtents->cy * cursor().position() / iText.size()));
+            }
+            else
+                make_cursor_visible();
             update();
         });
         iSink += cursor().AnchorChanged([this]()
@@ -2254,16 +2445,16 @@ namespace neogfx
         if (aClearFirst)
             iText.clear();
 
-        std::u32string text = neolib::utf8_to_utf32(aText);
-        if (iNormalizedTextBuffer.capacity() < text.size())
-            iNormalizedTextBuffer.reserve(text.size());
-        iNormalizedTextBuffer.clear();
-        for (auto ti = text.begin(); ti != text.end();)
+        // CRLF is normalized to LF in place in the decoded text
+        iNormalizedTextBuffer = neolib::utf8_to_utf32(aText);
+        auto normalized = iNormalizedTextBuffer.begin();
+        for (auto ti = iNormalizedTextBuffer.begin(); ti != iNormalizedTextBuffer.end();)
         {
             auto ch = *ti++;
-            if (ch != U'\r' || (ti == text.end() || (*ti) != U'\n'))
-                iNormalizedTextBuffer.push_back(ch);
+            if (ch != U'\r' || (ti == iNormalizedTextBuffer.end() || (*ti) != U'\n'))
+                *normalized++ = ch;
         }
+        iNormalizedTextBuffer.erase(normalized, iNormalizedTextBuffer.end());
         auto eos = iNormalizedTextBuffer.size();
         if ((iCaps & text_edit_caps::LINES_MASK) == text_edit_caps::SingleLine)
         {
@@ -2272,9 +2463,18 @@ namespace neogfx
                 eos = eol;
         }
         auto s = (&aStyle != &iDefaultStyle || iPersistDefaultStyle ? iStyles.insert(style(*this, aStyle)).first : iStyles.end());
+        auto const tagData = s != iStyles.end() ? document_text::tag_type::tag_data{ static_cast<style_list::const_iterator>(s) } : document_text::tag_type::tag_data{ nullptr };
         auto insertionPoint = iText.begin() + aPosition;
-        insertionPoint = iText.insert(s != iStyles.end() ? document_text::tag_type::tag_data{ static_cast<style_list::const_iterator>(s) } : document_text::tag_type::tag_data{ nullptr },
-            insertionPoint, iNormalizedTextBuffer.begin(), iNormalizedTextBuffer.begin() + eos);
+        if (aClearFirst)
+        {
+            // replacing the whole document so adopt the normalized text as the piece table's original buffer rather than copying it
+            auto original = std::make_shared<std::u32string>(std::move(iNormalizedTextBuffer));
+            iNormalizedTextBuffer.clear();
+            iText.assign(tagData, original, original->data(), eos);
+            insertionPoint = iText.begin();
+        }
+        else
+            insertionPoint = iText.insert(tagData, insertionPoint, iNormalizedTextBuffer.begin(), iNormalizedTextBuffer.begin() + eos);
         refresh_paragraph(insertionPoint, eos);
         update();
         if (aMoveCursor)
@@ -2346,19 +2546,148 @@ namespace neogfx
         if (iUpdatingDocument)
             return;
 
-        /* simple (naive) implementation just to get things moving (so just refresh everything) ... */
-        (void)aWhere;
+        // (iText.begin(), 0) requests a refresh of the whole document (e.g. font or style change)
+        if (aDelta == 0)
+        {
+            refresh_all_paragraphs(first_visible_character());
+            return;
+        }
+        // nothing laid out yet or the whole document was replaced (set_text) so there are no paragraphs to keep
+        if (iGlyphParagraphs.empty() || static_cast<ptrdiff_t>(iText.size()) == aDelta)
+        {
+            refresh_all_paragraphs(0u);
+            return;
+        }
+
+        // only re-shape the paragraphs touched by the edit; paragraph character and glyph offsets are
+        // held by iGlyphParagraphs (an indexitor) so paragraphs after the edit are shifted in O(log n)
+        auto const changeStart = static_cast<document_text::size_type>(aWhere - iText.begin());
+        auto const oldTextSize = static_cast<document_text::size_type>(static_cast<ptrdiff_t>(iText.size()) - aDelta);
+        auto const oldChangeEnd = changeStart + (aDelta < 0 ? static_cast<document_text::size_type>(-aDelta) : 0u);
+        auto const laidOutSize = iLayoutPending != std::nullopt ? *iLayoutPending : oldTextSize;
+        if (iLayoutPending != std::nullopt && changeStart >= laidOutSize)
+        {
+            // edit lies entirely within text that has not been laid out yet
+            refresh_columns();
+            return;
+        }
+        auto const firstAffected = character_to_paragraph(std::min(changeStart, oldTextSize - 1u));
+        if (iLayoutPending != std::nullopt && firstAffected != iGlyphParagraphs.end() && oldChangeEnd >= laidOutSize)
+        {
+            // edit extends past the laid out text so discard the layout from the first affected paragraph onwards
+            auto const firstIndex = firstAffected - to_const(iGlyphParagraphs).begin();
+            iLayoutPending = firstAffected->first.text_start_index();
+            glyphs().container().erase(std::next(glyphs().container().begin(), firstAffected->first.start_index()), glyphs().container().end());
+            iGlyphParagraphs.erase(std::next(iGlyphParagraphs.begin(), firstIndex), iGlyphParagraphs.end());
+            clear_paragraph_caches();
+            invalidate_lines();
+            refresh_columns();
+            return;
+        }
+        auto const lastAffected = character_to_paragraph(std::min(oldChangeEnd, oldTextSize - 1u));
+        if (firstAffected == iGlyphParagraphs.end() || lastAffected == iGlyphParagraphs.end())
+        {
+            refresh_all_paragraphs(0u);
+            return;
+        }
+        auto const textStart = firstAffected->first.text_start_index();
+        auto const oldTextEnd = lastAffected->first.text_end_index();
+        auto const glyphStart = firstAffected->first.start_index();
+        auto const glyphEnd = lastAffected->first.end_index();
+        if (oldTextEnd != (std::next(lastAffected) == iGlyphParagraphs.end() ? laidOutSize : std::next(lastAffected)->first.text_start_index()))
+        {
+            // paragraph offsets do not cover the text contiguously
+            refresh_all_paragraphs(0u);
+            return;
+        }
+        auto const textEnd = static_cast<document_text::size_type>(static_cast<ptrdiff_t>(oldTextEnd) + aDelta);
+
+        auto const firstIndex = firstAffected - to_const(iGlyphParagraphs).begin();
+        auto const lastIndex = lastAffected - to_const(iGlyphParagraphs).begin();
+
+        clear_paragraph_caches();
+        glyphs().container().erase(std::next(glyphs().container().begin(), glyphStart), std::next(glyphs().container().begin(), glyphEnd));
+        iGlyphParagraphs.erase(std::next(iGlyphParagraphs.begin(), firstIndex), std::next(iGlyphParagraphs.begin(), lastIndex + 1));
+        auto const shapedEnd = shape_paragraphs(textStart, textEnd, std::next(iGlyphParagraphs.begin(), firstIndex), glyphStart);
+        position_paragraph_glyphs(std::next(iGlyphParagraphs.begin(), firstIndex), shapedEnd);
+        if (iLayoutPending != std::nullopt)
+            *iLayoutPending = static_cast<document_text::size_type>(static_cast<ptrdiff_t>(*iLayoutPending) + aDelta);
+        invalidate_lines(line_update{ glyphStart, glyphEnd, std::next(iGlyphParagraphs.begin(), firstIndex), shapedEnd });
+        refresh_columns();
+    }
+
+    void text_edit::refresh_all_paragraphs(document_text::size_type aPriorityPosition)
+    {
+        glyphs().clear();
+        iGlyphParagraphs.clear();
+        clear_paragraph_caches();
+        invalidate_lines();
+        iLayoutPending = std::nullopt;
+        if (iText.size() <= BACKGROUND_LAYOUT_THRESHOLD)
+        {
+            shape_paragraphs(0u, iText.size(), iGlyphParagraphs.end(), 0u);
+            position_paragraph_glyphs(iGlyphParagraphs.begin(), iGlyphParagraphs.end());
+            refresh_columns();
+            return;
+        }
+        // large documents: lay out as far as the priority (visible) text now and the remainder in time slices from animate()
+        iLayoutPending = 0u;
+        continue_layout(std::min(aPriorityPosition, iText.size()));
+    }
+
+    text_edit::document_text::size_type text_edit::first_visible_character() const
+    {
+        if (iGlyphColumns.empty() || iGlyphParagraphs.empty())
+            return 0u;
+        auto const& column = iGlyphColumns[0];
+        auto line = column.line_at_ypos(vertical_scrollbar().position());
+        if (line == column.lines().end())
+            return 0u;
+        return line->paragraph->first.text_start_index();
+    }
+
+    text_edit::document_text::size_type text_edit::layout_chunk_end(document_text::size_type aStart) const
+    {
+        // chunks end on a paragraph boundary so chunked layout produces the same paragraphs as a single pass
+        auto const from = std::min(aStart + LAYOUT_CHUNK_SIZE, iText.size());
+        if (from == iText.size())
+            return from;
+        auto const newline = std::find(iText.begin() + from, iText.end(), U'\n');
+        return newline == iText.end() ? iText.size() : static_cast<document_text::size_type>(newline - iText.begin()) + 1u;
+    }
+
+    void text_edit::continue_layout(document_text::size_type aUntil)
+    {
+        if (iLayoutPending == std::nullopt)
+            return;
+        auto const deadline = std::chrono::steady_clock::now() + LAYOUT_TIME_SLICE;
+        auto const firstNew = iGlyphParagraphs.end() - iGlyphParagraphs.begin();
+        auto const oldGlyphCount = glyphs().size();
+        do
+        {
+            auto const chunkEnd = layout_chunk_end(*iLayoutPending);
+            auto const chunkStart = iGlyphParagraphs.end() - iGlyphParagraphs.begin();
+            auto const shapedEnd = shape_paragraphs(*iLayoutPending, chunkEnd, iGlyphParagraphs.end(), glyphs().size());
+            position_paragraph_glyphs(std::next(iGlyphParagraphs.begin(), chunkStart), shapedEnd);
+            iLayoutPending = chunkEnd;
+        } while (*iLayoutPending < iText.size() && (*iLayoutPending < aUntil || std::chrono::steady_clock::now() < deadline));
+        if (*iLayoutPending >= iText.size())
+            iLayoutPending = std::nullopt;
+        // only the new paragraphs (and the one before them) need lines
+        invalidate_lines(line_update{ oldGlyphCount, oldGlyphCount, std::next(iGlyphParagraphs.begin(), firstNew), iGlyphParagraphs.end() });
+        refresh_columns();
+        if (iLayoutPending == std::nullopt)
+            LayoutCompleted.trigger();
+    }
+
+    text_edit::glyph_paragraphs::iterator text_edit::shape_paragraphs(document_text::size_type aTextStart, document_text::size_type aTextEnd, glyph_paragraphs::iterator aWhere, document_glyphs::size_type aGlyphPosition)
+    {
         graphics_context gc{ *this, graphics_context::type::Unattached };
         if (password())
             gc.set_password(true, PasswordMask.value().empty() ? "\xE2\x97\x8F"_s : PasswordMask);
-        glyphs().clear();
-        iGlyphParagraphs.clear();
-        iCharacterToParagraphCache.clear();
-        iCharacterToParagraphCacheLastAccess.reset();
-        iGlyphToParagraphCache.clear();
-        iGlyphToParagraphCacheLastAccess.reset();
-        std::u32string paragraphBuffer;
-        auto nextParagraph = iText.begin();
+        thread_local std::u32string paragraphBuffer;
+        auto const textEnd = iText.begin() + aTextEnd;
+        auto nextParagraph = iText.begin() + aTextStart;
         auto iterColumn = iGlyphColumns.begin();
         neolib::vecarray<std::u32string::size_type, 16, -1> columnDelimiters;
         auto fs = [this, &nextParagraph, &columnDelimiters](std::u32string::size_type aSourceIndex)
@@ -2373,7 +2702,7 @@ namespace neogfx
                 columnStyle.character().font() != std::nullopt ? columnStyle : iDefaultStyle;
             return style.character().font() != std::nullopt ? *style.character().font() : font();
         };
-        for (auto iterChar = iText.begin(); iterChar != iText.end(); ++iterChar)
+        for (auto iterChar = nextParagraph; iterChar != textEnd; ++iterChar)
         {
             auto& column = *(iterColumn);
             auto ch = *iterChar;
@@ -2384,30 +2713,39 @@ namespace neogfx
                 continue;
             }
             bool newParagraph = (ch == U'\n');
-            if (newParagraph || iterChar == iText.end() - 1)
+            if (newParagraph || iterChar == textEnd - 1)
             {
                 paragraphBuffer.assign(nextParagraph, iterChar + 1);
                 auto gt = gc.to_glyph_text(paragraphBuffer.begin(), paragraphBuffer.end(), fs);
                 if (gt.cbegin() != gt.cend())
                 {
-                    auto paragraphGlyphs = glyphs().container().insert(glyphs().container().end(), gt.cbegin(), gt.cend());
+                    auto const glyphCount = static_cast<document_glyphs::size_type>(gt.cend() - gt.cbegin());
+                    glyphs().container().insert(std::next(glyphs().container().begin(), aGlyphPosition), gt.cbegin(), gt.cend());
+                    aGlyphPosition += glyphCount;
                     for (auto& newGlyph : gt)
                         glyphs().cache_glyph_font(newGlyph.font);
-                    auto paragraph = iGlyphParagraphs.insert(iGlyphParagraphs.end(),
+                    auto paragraph = iGlyphParagraphs.insert(aWhere,
                         std::make_pair(
                             glyph_paragraph{ *this },
                             glyph_paragraph_index{
-                                static_cast<std::size_t>((iterChar + 1) - iText.begin()) - static_cast<std::size_t>(nextParagraph - iText.begin()),
-                                glyphs().size() - static_cast<std::size_t>(paragraphGlyphs - glyphs().container().begin()) }),
+                                static_cast<std::size_t>((iterChar + 1) - nextParagraph),
+                                glyphCount }),
                                 glyph_paragraphs::skip_type{ glyph_paragraph_index{}, glyph_paragraph_index{} });
                     paragraph->first.set_self(paragraph);
                     paragraph->first.set_line_breaks(gt.content().line_breaks());
+                    aWhere = std::next(paragraph);
                 }
                 nextParagraph = iterChar + 1;
+                iterColumn = iGlyphColumns.begin();
                 columnDelimiters.clear();
             }
         }
-        for (auto p = iGlyphParagraphs.begin(); p != iGlyphParagraphs.end(); ++p)
+        return aWhere;
+    }
+
+    void text_edit::position_paragraph_glyphs(glyph_paragraphs::iterator aFirst, glyph_paragraphs::iterator aLast)
+    {
+        for (auto p = aFirst; p != aLast; ++p)
         {
             auto& paragraph = *p;
 
@@ -2430,11 +2768,11 @@ namespace neogfx
                     continue;
 
                 coordinate x = 0.0;
-                iterColumn = iGlyphColumns.begin();
+                auto iterColumn = iGlyphColumns.begin();
                 for (auto iterGlyph = paragraphLineStart; iterGlyph != paragraphLineEnd; ++iterGlyph)
                 {
                     auto& glyph = *iterGlyph;
-                    if (iText[glyph.source.first] == iterColumn->delimiter() && iterColumn + 1 != iGlyphColumns.end())
+                    if (iText[paragraph.first.text_start_index() + glyph.source.first] == iterColumn->delimiter() && iterColumn + 1 != iGlyphColumns.end())
                     {
                         glyph.advance = size{};
                         ++iterColumn;
@@ -2458,7 +2796,14 @@ namespace neogfx
                 }
             }
         }
-        refresh_columns();
+    }
+
+    void text_edit::clear_paragraph_caches()
+    {
+        iCharacterToParagraphCache.clear();
+        iCharacterToParagraphCacheLastAccess.reset();
+        iGlyphToParagraphCache.clear();
+        iGlyphToParagraphCacheLastAccess.reset();
     }
 
     void text_edit::refresh_columns()
@@ -2470,15 +2815,46 @@ namespace neogfx
         update();
     }
 
+    void text_edit::invalidate_lines(std::optional<line_update> const& aUpdate)
+    {
+        // an update can only be applied to the lines it was made against so two updates in a row lay everything out again
+        if (aUpdate == std::nullopt || iLineUpdate != std::nullopt)
+        {
+            iLineLayout = std::nullopt;
+            iLineUpdate = std::nullopt;
+        }
+        else
+            iLineUpdate = aUpdate;
+    }
+
+    dimension text_edit::line_layout_width(size const& aTextExtents) const
+    {
+        // the width refresh_lines would settle on for text of the given extents (see its scrollbar passes)
+        dimension availableWidth = column_rect(0).width(); // todo: columns
+        dimension availableHeight = column_rect(0).height();
+        bool const showVerticalScrollbar = !vertical_scrollbar().visible() && aTextExtents.cy > availableHeight;
+        if (showVerticalScrollbar)
+            availableWidth -= vertical_scrollbar().width();
+        if (!horizontal_scrollbar().visible() && aTextExtents.cx > availableWidth)
+        {
+            availableHeight -= horizontal_scrollbar().width();
+            if (!vertical_scrollbar().visible() && !showVerticalScrollbar && aTextExtents.cy > availableHeight)
+                availableWidth -= vertical_scrollbar().width();
+        }
+        return availableWidth;
+    }
+
     void text_edit::refresh_lines()
     {
         try
         {
-            /* simple (naive) implementation just to get things moving... */
             iOutOfMemory = false;
 
+            if (update_lines())
+                return;
+
             for (auto& column : iGlyphColumns)
-                column.lines().clear();
+                column.clear_lines();
             
             point pos{};
             
@@ -2492,170 +2868,23 @@ namespace neogfx
             uint32_t pass = 1;
             auto iterColumn = iGlyphColumns.begin();
 
+            thread_local glyph_lines paragraphLines;
             for (auto p = iGlyphParagraphs.begin(); p != iGlyphParagraphs.end();)
             {
                 auto& column = *iterColumn;
-                auto& lines = column.lines();
-                auto& paragraph = *p;
+                auto const& lines = column.lines();
 
-                thread_local std::vector<std::pair<document_glyphs::iterator, document_glyphs::iterator>> paragraphLines;
                 paragraphLines.clear();
-                glyph_text::size_type lastBreak = 0;
-                for (auto lineBreak : paragraph.first.line_breaks())
-                {
-                    paragraphLines.emplace_back(paragraph.first.start() + lastBreak, paragraph.first.start() + lineBreak);
-                    lastBreak = lineBreak + 1;
-                }
-                paragraphLines.emplace_back(paragraph.first.start() + lastBreak, paragraph.first.end());
-                if (paragraphLines.back().first != paragraphLines.back().second && 
-                    is_line_breaking_whitespace(glyphs().back()) && std::next(p) == iGlyphParagraphs.end())
-                    paragraphLines.emplace_back(paragraph.first.end(), paragraph.first.end());
-
-                auto const& paragraphStyle = glyph_style(paragraph.first.start(), column);
-
-                if (paragraphStyle.paragraph().padding())
-                    pos.y += paragraphStyle.paragraph().padding().value().top;
-
-                bool again = false;
-
-                for (auto const& paragraphLine : paragraphLines)
-                {
-                    auto const paragraphLineStart = paragraphLine.first;
-                    auto const paragraphLineEnd = paragraphLine.second;
-
-                    if (again)
-                    {
-                        if (paragraphStyle.paragraph().line_spacing())
-                            pos.y += paragraphStyle.paragraph().line_spacing().value();
-                    }
-                    else
-                        again = true;
-
-                    if (paragraphLineStart == paragraphLineEnd || is_line_breaking_whitespace(*paragraphLineStart))
-                    {
-                        auto lineStart = paragraphLineStart;
-                        auto lineEnd = paragraphLineEnd;
-                        auto height = paragraph.first.height(lineStart, lineEnd);
-                        if (height == 0.0)
-                        {
-                            if (lines.empty())
-                                height = paragraphStyle.character().font()->height();
-                            else
-                                height = lines.back().extents.cy;
-                        }
-                        lines.push_back(
-                            glyph_line{
-                                { p - iGlyphParagraphs.begin(), p },
-                                { lineStart - glyphs().begin(), lineStart },
-                                { lineEnd - glyphs().begin(), lineEnd },
-                                pos.y,
-                                { 0.0, height } });
-                        pos.y += height;
-                    }
-                    else if (WordWrap && (paragraphLineEnd - 1)->x + advance(*(paragraphLineEnd - 1)).cx > availableWidth)
-                    {
-                        auto insertionPoint = lines.end();
-                        bool first = true;
-                        auto next = paragraphLineStart;
-                        auto lineStart = next;
-                        auto lineEnd = paragraphLineEnd;
-                        coordinate offset = 0.0;
-                        while (next != paragraphLineEnd)
-                        {
-                            auto split = std::lower_bound(next, paragraphLineEnd, paragraph_positioned_glyph{ offset + availableWidth });
-                            if (split != next && (split != paragraphLineEnd || (split - 1)->x + advance(*(split - 1)).cx >= offset + availableWidth))
-                                --split;
-                            if (split == next)
-                                ++split;
-                            if (split != paragraphLineEnd)
-                            {
-                                std::pair<document_glyphs::iterator, document_glyphs::iterator> wordBreak = word_break(lineStart, split, paragraphLineEnd);
-                                if (wordBreak.first == wordBreak.second)
-                                {
-                                    auto previousLineEnd = wordBreak.first;
-                                    while (previousLineEnd != lineStart && (previousLineEnd - 1)->source == wordBreak.first->source)
-                                        --previousLineEnd;
-                                    if (previousLineEnd != lineStart)
-                                    {
-                                        lineEnd = wordBreak.first;
-                                        next = previousLineEnd;
-                                    }
-                                    else
-                                        next = lineEnd = split;
-                                }
-                                else
-                                {
-                                    lineEnd = wordBreak.first;
-                                    next = wordBreak.second;
-                                }
-                            }
-                            else
-                                next = paragraphLineEnd;
-                            dimension x = (split != glyphs().end() ? split->x : (lineStart != lineEnd ? glyphs().back().x + advance(glyphs().back()).cx : 0.0));
-                            auto height = paragraph.first.height(lineStart, lineEnd);
-                            if (lineEnd != lineStart && is_line_breaking_whitespace(*(lineEnd - 1)))
-                                --lineEnd;
-                            bool rtl = false;
-                            if (!first &&
-                                insertionPoint->lineStart != insertionPoint->lineEnd &&
-                                lineStart != lineEnd &&
-                                direction(*insertionPoint->lineStart.second) == text_direction::RTL &&
-                                direction(*(lineEnd - 1)) == text_direction::RTL)
-                                rtl = true; // todo: is this sufficient for multi-line RTL text?
-                            if (!rtl)
-                                insertionPoint = lines.end();
-                            insertionPoint = lines.insert(insertionPoint,
-                                glyph_line{
-                                    { p - iGlyphParagraphs.begin(), p },
-                                    { lineStart - glyphs().begin(), lineStart },
-                                    { lineEnd - glyphs().begin(), lineEnd },
-                                    pos.y,
-                                    { x - offset, height } });
-                            if (rtl)
-                            {
-                                auto ypos = (insertionPoint + 1)->ypos;
-                                for (auto i = insertionPoint; i != lines.end(); ++i)
-                                {
-                                    i->ypos = ypos;
-                                    ypos += i->extents.cy;
-                                }
-                            }
-                            pos.y += height;
-                            iTextExtents->cx = std::max(iTextExtents->cx, x - offset);
-                            lineStart = next;
-                            if (lineStart != paragraphLineEnd)
-                                offset = lineStart->x;
-                            lineEnd = paragraphLineEnd;
-                            first = false;
-                        }
-                    }
-                    else
-                    {
-                        auto lineStart = paragraphLineStart;
-                        auto lineEnd = paragraphLineEnd;
-                        auto height = paragraph.first.height(lineStart, lineEnd);
-                        if (lineEnd != lineStart && is_line_breaking_whitespace(*(lineEnd - 1)))
-                            --lineEnd;
-                        lines.push_back(
-                            glyph_line{
-                                { p - iGlyphParagraphs.begin(), p },
-                                { lineStart - glyphs().begin(), lineStart },
-                                { lineEnd - glyphs().begin(), lineEnd },
-                                pos.y,
-                                { (lineEnd - 1)->x + advance(*(lineEnd - 1)).cx, height} });
-                        pos.y += lines.back().extents.cy;
-                        iTextExtents->cx = std::max(iTextExtents->cx, lines.back().extents.cx);
-                    }
-                }
-
-                if (paragraphStyle.paragraph().padding())
-                    pos.y += paragraphStyle.paragraph().padding().value().bottom;
+                pos.y = layout_paragraph(p, column, pos.y, availableWidth, 
+                    lines.empty() ? std::optional<dimension>{} : lines.back().extents.cy, paragraphLines);
+                column.append_lines(paragraphLines);
+                iTextExtents->cx = column.lines_width();
 
                 auto next_pass = [&]()
                 {
                     if (pass <= 3)
                     {
-                        lines.clear();
+                        column.clear_lines();
                         pos = point{};
                         iTextExtents = size{};
                         p = iGlyphParagraphs.begin();
@@ -2691,7 +2920,9 @@ namespace neogfx
                 }
             }
 
-            iTextExtents->cy = pos.y;
+            iLineLayout = line_layout{ availableWidth, word_wrap(), pos.y };
+            iLineUpdate = std::nullopt;
+            update_text_extents();
 
             if (iTextExtents->cy < client_rect(false).cy)
             {
@@ -2700,21 +2931,262 @@ namespace neogfx
                     ((Alignment & alignment::Vertical) == alignment::Bottom) ? space :
                     ((Alignment & alignment::Vertical) == alignment::VCenter) ? std::floor(space / 2.0) : 0.0;
                 if (adjust != 0.0)
+                {
                     for (auto& column : iGlyphColumns)
-                        for (auto& line : column.lines())
-                            line.ypos += adjust;
+                        column.move_all_lines(adjust);
+                    // the adjustment depends on the height of all the text so it is not updated in place
+                    iLineLayout = std::nullopt;
+                }
             }
         }
         catch (std::bad_alloc)
         {
             for (auto& column : iGlyphColumns)
-                column.lines().clear();
+                column.clear_lines();
+            iLineLayout = std::nullopt;
+            iLineUpdate = std::nullopt;
             iOutOfMemory = true;
         }
     }
 
+    bool text_edit::update_lines()
+    {
+        // Brings the lines of the last refresh_lines up to date in place when only the paragraphs described by
+        // iLineUpdate have changed since; returns false if everything has to be laid out again instead (the
+        // width changed, the lines were invalidated or the text no longer fills the page).
+        if (iLineLayout == std::nullopt || iLineLayout->wordWrap != word_wrap() || iGlyphColumns.empty())
+            return false;
+        auto& column = iGlyphColumns[0]; // todo: columns
+        auto const& lines = column.lines();
+        if (line_layout_width(size{ column.lines_width(), iLineLayout->height }) != iLineLayout->availableWidth)
+            return false;
+        if (iLineUpdate != std::nullopt)
+        {
+            auto const update = *iLineUpdate;
+            iLineUpdate = std::nullopt;
+            auto first = update.first;
+            auto glyphStart = update.glyphStart;
+            // the last paragraph gains an empty line if the text ends with a line break so the paragraph that 
+            // was last is laid out again when paragraphs are added after it
+            if (update.last == iGlyphParagraphs.end() && first != iGlyphParagraphs.begin())
+            {
+                --first;
+                glyphStart = first->first.start_index();
+            }
+            auto const previous = (first != iGlyphParagraphs.begin() ? std::optional<glyph_paragraphs::const_iterator>{ std::prev(first) } : std::nullopt);
+            glyph_paragraphs::const_iterator const next = update.last;
+            // find the replaced lines by glyph position then step over any empty line at a boundary that 
+            // belongs to a neighbouring paragraph
+            auto firstLine = (previous != std::nullopt ? column.line_at_glyph(glyphStart) : lines.begin());
+            while (firstLine != lines.end() && previous != std::nullopt && firstLine->paragraph == *previous)
+                ++firstLine;
+            auto lastLine = (next != iGlyphParagraphs.end() ? column.line_at_glyph(update.oldGlyphEnd) : lines.end());
+            while (lastLine != lines.end() && lastLine->paragraph != next)
+                ++lastLine;
+            auto const paragraph_padding = [&](glyph_paragraphs::const_iterator aParagraph)
+            {
+                auto const paragraphStyle = glyph_style(aParagraph->first.start(), column);
+                return paragraphStyle.paragraph().padding() ? paragraphStyle.paragraph().padding().value() : neogfx::padding{};
+            };
+            auto const top = (firstLine != lines.begin() ?
+                column.line_ypos(std::prev(firstLine)) + std::prev(firstLine)->extents.cy + paragraph_padding(*previous).bottom : 0.0);
+            auto const oldBottom = (lastLine != lines.end() ?
+                column.line_ypos(lastLine) - paragraph_padding(next).top : iLineLayout->height);
+            auto const previousLineHeight = (firstLine != lines.begin() ? std::optional<dimension>{ std::prev(firstLine)->extents.cy } : std::nullopt);
+            thread_local glyph_lines paragraphLines;
+            paragraphLines.clear();
+            auto bottom = top;
+            for (auto p = first; p != update.last; ++p)
+                bottom = layout_paragraph(p, column, bottom, iLineLayout->availableWidth, previousLineHeight, paragraphLines);
+            auto const newGlyphEnd = (next != iGlyphParagraphs.end() ? next->first.start_index() : glyphs().size());
+            column.replace_lines(firstLine, lastLine, paragraphLines, newGlyphEnd - update.oldGlyphEnd, bottom - oldBottom);
+            iLineLayout->height += bottom - oldBottom;
+            if (line_layout_width(size{ column.lines_width(), iLineLayout->height }) != iLineLayout->availableWidth)
+                return false;
+        }
+        update_text_extents();
+        if (iTextExtents->cy < client_rect(false).cy && (Alignment & alignment::Vertical) != alignment::Top)
+            return false;
+        return true;
+    }
+
+    void text_edit::update_text_extents()
+    {
+        iTextExtents = size{ iGlyphColumns.empty() ? 0.0 : iGlyphColumns[0].lines_width(), iLineLayout != std::nullopt ? iLineLayout->height : 0.0 };
+        if (iLayoutPending != std::nullopt && *iLayoutPending != 0u)
+            iTextExtents->cy = std::ceil(iTextExtents->cy * iText.size() / *iLayoutPending); // estimate until layout completes
+    }
+
+    coordinate text_edit::layout_paragraph(glyph_paragraphs::iterator aParagraph, glyph_column const& aColumn, coordinate aTop, dimension aAvailableWidth, std::optional<dimension> const& aPreviousLineHeight, glyph_lines& aLines)
+    {
+        auto& paragraph = *aParagraph;
+        auto ypos = aTop;
+
+        thread_local std::vector<std::pair<document_glyphs::iterator, document_glyphs::iterator>> paragraphLines;
+        paragraphLines.clear();
+        glyph_text::size_type lastBreak = 0;
+        for (auto lineBreak : paragraph.first.line_breaks())
+        {
+            paragraphLines.emplace_back(paragraph.first.start() + lastBreak, paragraph.first.start() + lineBreak);
+            lastBreak = lineBreak + 1;
+        }
+        paragraphLines.emplace_back(paragraph.first.start() + lastBreak, paragraph.first.end());
+        if (paragraphLines.back().first != paragraphLines.back().second && iLayoutPending == std::nullopt &&
+            is_line_breaking_whitespace(glyphs().back()) && std::next(aParagraph) == iGlyphParagraphs.end())
+            paragraphLines.emplace_back(paragraph.first.end(), paragraph.first.end());
+
+        auto const& paragraphStyle = glyph_style(paragraph.first.start(), aColumn);
+
+        if (paragraphStyle.paragraph().padding())
+            ypos += paragraphStyle.paragraph().padding().value().top;
+
+        bool again = false;
+
+        for (auto const& paragraphLine : paragraphLines)
+        {
+            auto const paragraphLineStart = paragraphLine.first;
+            auto const paragraphLineEnd = paragraphLine.second;
+
+            if (again)
+            {
+                if (paragraphStyle.paragraph().line_spacing())
+                    ypos += paragraphStyle.paragraph().line_spacing().value();
+            }
+            else
+                again = true;
+
+            if (paragraphLineStart == paragraphLineEnd || is_line_breaking_whitespace(*paragraphLineStart))
+            {
+                auto lineStart = paragraphLineStart;
+                auto lineEnd = paragraphLineEnd;
+                auto height = paragraph.first.height(lineStart, lineEnd);
+                if (height == 0.0)
+                {
+                    if (!aLines.empty())
+                        height = aLines.back().extents.cy;
+                    else if (aPreviousLineHeight)
+                        height = *aPreviousLineHeight;
+                    else
+                        height = paragraphStyle.character().font()->height();
+                }
+                aLines.push_back(
+                    glyph_line{
+                        aParagraph,
+                        static_cast<document_glyphs::size_type>(lineStart - glyphs().begin()),
+                        static_cast<document_glyphs::size_type>(lineEnd - glyphs().begin()),
+                        ypos,
+                        { 0.0, height } });
+                ypos += height;
+            }
+            else if (WordWrap && (paragraphLineEnd - 1)->x + advance(*(paragraphLineEnd - 1)).cx > aAvailableWidth)
+            {
+                auto insertionPoint = aLines.end();
+                bool first = true;
+                auto next = paragraphLineStart;
+                auto lineStart = next;
+                auto lineEnd = paragraphLineEnd;
+                coordinate offset = 0.0;
+                while (next != paragraphLineEnd)
+                {
+                    auto split = std::lower_bound(next, paragraphLineEnd, paragraph_positioned_glyph{ offset + aAvailableWidth });
+                    if (split != next && (split != paragraphLineEnd || (split - 1)->x + advance(*(split - 1)).cx >= offset + aAvailableWidth))
+                        --split;
+                    if (split == next)
+                        ++split;
+                    if (split != paragraphLineEnd)
+                    {
+                        std::pair<document_glyphs::iterator, document_glyphs::iterator> wordBreak = word_break(lineStart, split, paragraphLineEnd);
+                        if (wordBreak.first == wordBreak.second)
+                        {
+                            auto previousLineEnd = wordBreak.first;
+                            while (previousLineEnd != lineStart && (previousLineEnd - 1)->source == wordBreak.first->source)
+                                --previousLineEnd;
+                            if (previousLineEnd != lineStart)
+                            {
+                                lineEnd = wordBreak.first;
+                                next = previousLineEnd;
+                            }
+                            else
+                                next = lineEnd = split;
+                        }
+                        else
+                        {
+                            lineEnd = wordBreak.first;
+                            next = wordBreak.second;
+                        }
+                    }
+                    else
+                        next = paragraphLineEnd;
+                    dimension x = (split != glyphs().end() ? split->x : (lineStart != lineEnd ? glyphs().back().x + advance(glyphs().back()).cx : 0.0));
+                    auto height = paragraph.first.height(lineStart, lineEnd);
+                    if (lineEnd != lineStart && is_line_breaking_whitespace(*(lineEnd - 1)))
+                        --lineEnd;
+                    bool rtl = false;
+                    if (!first &&
+                        insertionPoint->lineStart != insertionPoint->lineEnd &&
+                        lineStart != lineEnd &&
+                        direction(glyphs()[insertionPoint->lineStart]) == text_direction::RTL &&
+                        direction(*(lineEnd - 1)) == text_direction::RTL)
+                        rtl = true; // todo: is this sufficient for multi-line RTL text?
+                    if (!rtl)
+                        insertionPoint = aLines.end();
+                    insertionPoint = aLines.insert(insertionPoint,
+                        glyph_line{
+                            aParagraph,
+                            static_cast<document_glyphs::size_type>(lineStart - glyphs().begin()),
+                            static_cast<document_glyphs::size_type>(lineEnd - glyphs().begin()),
+                            ypos,
+                            { x - offset, height } });
+                    if (rtl)
+                    {
+                        auto lineYpos = (insertionPoint + 1)->ypos;
+                        for (auto i = insertionPoint; i != aLines.end(); ++i)
+                        {
+                            i->ypos = lineYpos;
+                            lineYpos += i->extents.cy;
+                        }
+                    }
+                    ypos += height;
+                    lineStart = next;
+                    if (lineStart != paragraphLineEnd)
+                        offset = lineStart->x;
+                    lineEnd = paragraphLineEnd;
+                    first = false;
+                }
+            }
+            else
+            {
+                auto lineStart = paragraphLineStart;
+                auto lineEnd = paragraphLineEnd;
+                auto height = paragraph.first.height(lineStart, lineEnd);
+                if (lineEnd != lineStart && is_line_breaking_whitespace(*(lineEnd - 1)))
+                    --lineEnd;
+                aLines.push_back(
+                    glyph_line{
+                        aParagraph,
+                        static_cast<document_glyphs::size_type>(lineStart - glyphs().begin()),
+                        static_cast<document_glyphs::size_type>(lineEnd - glyphs().begin()),
+                        ypos,
+                        { (lineEnd - 1)->x + advance(*(lineEnd - 1)).cx, height} });
+                ypos += aLines.back().extents.cy;
+            }
+        }
+
+        if (paragraphStyle.paragraph().padding())
+            ypos += paragraphStyle.paragraph().padding().value().bottom;
+
+        return ypos;
+    }
+
     void text_edit::animate()
     {
+        if (iLayoutPending != std::nullopt)
+            continue_layout(0u);
+        if (iCursorVisibilityPending && (iLayoutPending == std::nullopt || cursor().position() <= *iLayoutPending))
+        {
+            iCursorVisibilityPending = false;
+            make_cursor_visible();
+        }
         if (neolib::service<neolib::i_power>().green_mode_active())
             return;
         if (has_focus())
@@ -2762,8 +3234,8 @@ namespace neogfx
 
     void text_edit::draw_glyphs(i_graphics_context const& aGc, const point& aPosition, const glyph_column& aColumn, glyph_lines::const_iterator aLine) const
     {
-        auto lineStart = aLine->lineStart.second;
-        auto lineEnd = aLine->lineEnd.second;
+        auto lineStart = glyphs().begin() + aColumn.line_start(aLine);
+        auto lineEnd = glyphs().begin() + aColumn.line_end(aLine);
         if (lineEnd != lineStart && is_line_breaking_whitespace(*(lineEnd - 1)))
             --lineEnd;
         {
@@ -31,6 +31,7 @@
 #include "opengl_window.hpp"
 #include "../../../gfx/native/opengl_helpers.hpp"
 #include "../../../gfx/native/opengl_texture.hpp"
+#include "../../../gfx/native/opengl_renderer.hpp"
 
 namespace neogfx
 {
@@ -141,16 +142,30 @@ namespace neogfx
 
     color opengl_window::read_pixel(const point& aPosition) const
     {
-        if (target_texture().sampling() != neogfx::texture_sampling::Multisample)
-        {
-            scoped_render_target srt{ *this };
-            avec4u8 pixel;
-            basic_point<GLint> pos{ aPosition };
-            glCheck(glReadPixels(pos.x, pos.y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixel));
-            return color{ pixel[0], pixel[1], pixel[2], pixel[3] };
-        }
-        else
-            throw std::logic_error("opengl_window::read_pixel: not yet implemented for multisample render targets");
+        avec4u8 pixel;
+        read_pixels(rect{ aPosition, size{ 1.0, 1.0 } }, &pixel);
+        return color{ pixel[0], pixel[1], pixel[2], pixel[3] };
+    }
+
+    void opengl_window::read_pixels(const rect& aRect, avec4u8* aPixels) const
+    {
+        if (target_texture().sampling() == neogfx::texture_sampling::Multisample)
+            throw std::logic_error("opengl_window::read_pixels: not yet implemented for multisample render targets");
+        scoped_render_target srt{ *this };
+        basic_rect<GLint> const source{ aRect };
+        GLint previousPackAlignment;
+        glCheck(glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment));
+        glCheck(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        glCheck(glReadPixels(source.x, source.y, source.cx, source.cy, GL_RGBA, GL_UNSIGNED_BYTE, aPixels));
+        glCheck(glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment));
+    }
+
+    void opengl_window::read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const
+    {
+        if (target_texture().sampling() == neogfx::texture_sampling::Multisample)
+            throw std::logic_error("opengl_window::read_pixels_async: not yet implemented for multisample render targets");
+        scoped_render_target srt{ *this };
+        static_cast<opengl_renderer&>(service<i_rendering_engine>()).pixel_reader().read(basic_rect<GLint>{ aRect }, aRect, aCallback);
     }
 
     neogfx::logical_coordinate_system opengl_window::logical_coordinate_system() const
@@ -59,6 +59,8 @@ namespace neogfx
     public:
         neogfx::color_space color_space() const override;
         color read_pixel(const point& aPosition) const override;
+        void read_pixels(const rect& aRect, avec4u8* aPixels) const override;
+        void read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const override;
     public:
         uint64_t frame_counter() const override;
         double fps() const override;
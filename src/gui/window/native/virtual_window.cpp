@@ -121,7 +121,20 @@ namespace neogfx
 
     color virtual_window::read_pixel(const point& aPosition) const
     {
-        return parent().read_pixel(surface_position());
+        return parent().read_pixel(surface_position() + aPosition);
+    }
+
+    void virtual_window::read_pixels(const rect& aRect, avec4u8* aPixels) const
+    {
+        parent().read_pixels(aRect + surface_position(), aPixels);
+    }
+
+    void virtual_window::read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const
+    {
+        parent().read_pixels_async(aRect + surface_position(), [aRect, aCallback](const rect&, const avec4u8* aPixels)
+        {
+            aCallback(aRect, aPixels);
+        });
     }
 
     neogfx::logical_coordinate_system virtual_window::logical_coordinate_system() const
@@ -53,6 +53,8 @@ namespace neogfx
     public:
         neogfx::color_space color_space() const final;
         color read_pixel(const point& aPosition) const final;
+        void read_pixels(const rect& aRect, avec4u8* aPixels) const final;
+        void read_pixels_async(const rect& aRect, const read_pixels_callback& aCallback) const final;
     public:
         uint64_t frame_counter() const final;
         double fps() const final;
@@ -0,0 +1,535 @@
+// gltf.cpp
+/*
+  neogfx C++ App/Game Engine
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <sstream>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <neogfx/app/i_resource_manager.hpp>
+#include <neogfx/support/file/gfx/gltf.hpp>
+
+namespace neogfx::file
+{
+    namespace
+    {
+        constexpr uint32_t kGlbMagic = 0x46546C67u; // "glTF"
+        constexpr uint32_t kGlbJsonChunk = 0x4E4F534Au; // "JSON"
+        constexpr uint32_t kGlbBinaryChunk = 0x004E4942u; // "BIN\0"
+
+        uint32_t read_uint32(uint8_t const* aData)
+        {
+            return static_cast<uint32_t>(aData[0]) | (static_cast<uint32_t>(aData[1]) << 8u) | 
+                (static_cast<uint32_t>(aData[2]) << 16u) | (static_cast<uint32_t>(aData[3]) << 24u);
+        }
+
+        std::vector<uint8_t> decode_base64(std::string_view aEncoded)
+        {
+            std::vector<uint8_t> result;
+            result.reserve(aEncoded.size() * 3u / 4u);
+            uint32_t accumulator = 0u;
+            uint32_t bits = 0u;
+            for (auto ch : aEncoded)
+            {
+                uint32_t value;
+                if (ch >= 'A' && ch <= 'Z')
+                    value = static_cast<uint32_t>(ch - 'A');
+                else if (ch >= 'a' && ch <= 'z')
+                    value = static_cast<uint32_t>(ch - 'a' + 26);
+                else if (ch >= '0' && ch <= '9')
+                    value = static_cast<uint32_t>(ch - '0' + 52);
+                else if (ch == '+')
+                    value = 62u;
+                else if (ch == '/')
+                    value = 63u;
+                else if (ch == '=')
+                    break;
+                else
+                    throw gltf::invalid_file();
+                accumulator = (accumulator << 6u) | value;
+                bits += 6u;
+                if (bits >= 8u)
+                {
+                    bits -= 8u;
+                    result.push_back(static_cast<uint8_t>(accumulator >> bits));
+                }
+            }
+            return result;
+        }
+
+        std::optional<std::string> optional_name(boost::property_tree::ptree const& aObject)
+        {
+            auto const name = aObject.get_optional<std::string>("name");
+            return name ? std::optional<std::string>{ *name } : std::nullopt;
+        }
+
+        std::optional<std::size_t> optional_index(boost::property_tree::ptree const& aObject, std::string const& aKey)
+        {
+            auto const index = aObject.get_optional<std::size_t>(aKey);
+            return index ? std::optional<std::size_t>{ *index } : std::nullopt;
+        }
+
+        template <std::size_t N>
+        basic_vector<scalar, N> read_vector(boost::property_tree::ptree const& aArray)
+        {
+            basic_vector<scalar, N> result;
+            std::size_t index = 0u;
+            for (auto const& element : aArray)
+                if (index < N)
+                    result[index++] = element.second.get_value<scalar>();
+            return result;
+        }
+
+        scene_graph::accessor_type to_accessor_type(std::string const& aType)
+        {
+            static const std::pair<std::string_view, scene_graph::accessor_type> sTypes[] =
+            {
+                { "SCALAR", scene_graph::accessor_type::SCALAR },
+                { "VEC2", scene_graph::accessor_type::VEC2 },
+                { "VEC3", scene_graph::accessor_type::VEC3 },
+                { "VEC4", scene_graph::accessor_type::VEC4 },
+                { "MAT2", scene_graph::accessor_type::MAT2 },
+                { "MAT3", scene_graph::accessor_type::MAT3 },
+                { "MAT4", scene_graph::accessor_type::MAT4 }
+            };
+            for (auto const& type : sTypes)
+                if (type.first == aType)
+                    return type.second;
+            throw gltf::invalid_file();
+        }
+
+        std::optional<scene_graph::vertex_attribute> to_vertex_attribute(std::string const& aAttribute)
+        {
+            static const std::pair<std::string_view, scene_graph::vertex_attribute> sAttributes[] =
+            {
+                { "POSITION", scene_graph::vertex_attribute::POSITION },
+                { "NORMAL", scene_graph::vertex_attribute::NORMAL },
+                { "TANGENT", scene_graph::vertex_attribute::TANGENT },
+                { "TEXCOORD_0", scene_graph::vertex_attribute::TEXCOORD_0 },
+                { "TEXCOORD_1", scene_graph::vertex_attribute::TEXCOORD_1 },
+                { "COLOR_0", scene_graph::vertex_attribute::COLOR_0 },
+                { "JOINTS_0", scene_graph::vertex_attribute::JOINTS_0 },
+                { "WEIGHTS_0", scene_graph::vertex_attribute::WEIGHTS_0 }
+            };
+            for (auto const& attribute : sAttributes)
+                if (attribute.first == aAttribute)
+                    return attribute.second;
+            return std::nullopt;
+        }
+
+        template <typename IndexView>
+        std::size_t max_index(IndexView const& aIndices)
+        {
+            std::size_t result = 0u;
+            for (std::size_t i = 0u; i < aIndices.size(); ++i)
+                result = std::max<std::size_t>(result, aIndices[i]);
+            return result;
+        }
+
+        template <typename IndexView>
+        void append_faces(IndexView const& aIndices, std::size_t aVertexCount, scene_graph::rendering_mode aMode, game::faces& aFaces)
+        {
+            auto const count = aIndices.size();
+            if (count != 0u && max_index(aIndices) >= aVertexCount)
+                throw gltf::vertex_index_out_of_bounds();
+            switch (aMode)
+            {
+            case scene_graph::rendering_mode::TRIANGLES:
+                aFaces.reserve(aFaces.size() + count / 3u);
+                for (std::size_t i = 0u; i + 2u < count; i += 3u)
+                    aFaces.push_back(game::face{ aIndices[i], aIndices[i + 1u], aIndices[i + 2u] });
+                break;
+            case scene_graph::rendering_mode::TRIANGLE_STRIP:
+                for (std::size_t i = 0u; i + 2u < count; ++i)
+                    if (i % 2u == 0u)
+                        aFaces.push_back(game::face{ aIndices[i], aIndices[i + 1u], aIndices[i + 2u] });
+                    else
+                        aFaces.push_back(game::face{ aIndices[i + 1u], aIndices[i], aIndices[i + 2u] });
+                break;
+            case scene_graph::rendering_mode::TRIANGLE_FAN:
+                for (std::size_t i = 1u; i + 1u < count; ++i)
+                    aFaces.push_back(game::face{ aIndices[0u], aIndices[i], aIndices[i + 1u] });
+                break;
+            default:
+                // points and lines have no faces
+                break;
+            }
+        }
+
+        struct sequential_indices
+        {
+            std::size_t count;
+            std::size_t size() const { return count; }
+            uint32_t operator[](std::size_t aIndex) const { return static_cast<uint32_t>(aIndex); }
+        };
+    }
+
+    gltf::gltf(std::string const& aUri) :
+        iResource{ service<i_resource_manager>().load_resource(aUri) }
+    {
+        if (!iResource || !iResource->available() || iResource->is_empty())
+            throw failed_to_open_file(aUri);
+        auto const data = static_cast<uint8_t const*>(iResource->cdata());
+        auto const size = iResource->size();
+        if (size >= 12u && read_uint32(data) == kGlbMagic)
+        {
+            // binary glTF: a header followed by a JSON chunk and an optional binary chunk which stays in the mapped file
+            if (read_uint32(data + 4u) != 2u)
+                throw unsupported_version();
+            // all chunk arithmetic is done in std::size_t and compared against what remains so that
+            // lengths near 4 GiB cannot wrap around and pass the bounds checks
+            std::size_t const length = std::min<std::size_t>(read_uint32(data + 8u), size);
+            if (length < 20u || read_uint32(data + 16u) != kGlbJsonChunk)
+                throw invalid_file();
+            std::size_t const jsonLength = read_uint32(data + 12u);
+            if (jsonLength > length - 20u)
+                throw invalid_file();
+            uint8_t const* binaryChunk = nullptr;
+            std::size_t binaryChunkLength = 0u;
+            std::size_t const binaryHeader = 20u + ((jsonLength + 3u) & ~std::size_t{ 3u });
+            if (binaryHeader <= length && length - binaryHeader >= 8u && read_uint32(data + binaryHeader + 4u) == kGlbBinaryChunk)
+            {
+                binaryChunk = data + binaryHeader + 8u;
+                binaryChunkLength = std::min<std::size_t>(read_uint32(data + binaryHeader), length - binaryHeader - 8u);
+            }
+            parse(aUri, reinterpret_cast<char const*>(data + 20u), jsonLength, binaryChunk, binaryChunkLength);
+        }
+        else
+            parse(aUri, reinterpret_cast<char const*>(data), size, nullptr, 0u);
+    }
+
+    game::mesh gltf::to_mesh(std::size_t aMesh, std::size_t aPrimitive) const
+    {
+        auto const& source = meshes.at(aMesh).primitives.at(aPrimitive);
+        game::mesh result;
+        auto const position = source.attributes.find(scene_graph::vertex_attribute::POSITION);
+        if (position == source.attributes.end())
+            return result;
+        if (accessors.at(position->second).componentType != scene_graph::accessor_component_type::FLOAT)
+            throw unsupported_accessor();
+        // convert straight out of the buffer into the component: no intermediate copies of vertex data
+        auto const positions = view<std::array<float, 3>>(position->second);
+        result.vertices.reserve(positions.size());
+        for (std::size_t i = 0u; i < positions.size(); ++i)
+        {
+            auto const p = positions[i];
+            result.vertices.emplace_back(p[0], p[1], p[2]);
+        }
+        auto const texCoord = source.attributes.find(scene_graph::vertex_attribute::TEXCOORD_0);
+        if (texCoord != source.attributes.end() && accessors.at(texCoord->second).componentType == scene_graph::accessor_component_type::FLOAT)
+        {
+            auto const uvs = view<std::array<float, 2>>(texCoord->second);
+            result.uv.reserve(uvs.size());
+            for (std::size_t i = 0u; i < uvs.size(); ++i)
+            {
+                auto const uv = uvs[i];
+                result.uv.emplace_back(uv[0], uv[1]);
+            }
+        }
+        if (source.indices)
+        {
+            switch (accessors.at(*source.indices).componentType)
+            {
+            case scene_graph::accessor_component_type::UNSIGNED_BYTE:
+                append_faces(view<uint8_t>(*source.indices), positions.size(), source.mode, result.faces);
+                break;
+            case scene_graph::accessor_component_type::UNSIGNED_SHORT:
+                append_faces(view<uint16_t>(*source.indices), positions.size(), source.mode, result.faces);
+                break;
+            case scene_graph::accessor_component_type::UNSIGNED_INT:
+                append_faces(view<uint32_t>(*source.indices), positions.size(), source.mode, result.faces);
+                break;
+            default:
+                throw unsupported_accessor();
+            }
+        }
+        else
+            append_faces(sequential_indices{ positions.size() }, positions.size(), source.mode, result.faces);
+        return result;
+    }
+
+    std::size_t gltf::component_size(scene_graph::accessor_component_type aComponentType)
+    {
+        switch (aComponentType)
+        {
+        case scene_graph::accessor_component_type::BYTE:
+        case scene_graph::accessor_component_type::UNSIGNED_BYTE:
+            return 1u;
+        case scene_graph::accessor_component_type::SHORT:
+        case scene_graph::accessor_component_type::UNSIGNED_SHORT:
+            return 2u;
+        case scene_graph::accessor_component_type::UNSIGNED_INT:
+        case scene_graph::accessor_component_type::FLOAT:
+            return 4u;
+        default:
+            throw invalid_file();
+        }
+    }
+
+    std::size_t gltf::component_count(scene_graph::accessor_type aType)
+    {
+        switch (aType)
+        {
+        case scene_graph::accessor_type::SCALAR:
+            return 1u;
+        case scene_graph::accessor_type::VEC2:
+            return 2u;
+        case scene_graph::accessor_type::VEC3:
+            return 3u;
+        case scene_graph::accessor_type::VEC4:
+        case scene_graph::accessor_type::MAT2:
+            return 4u;
+        case scene_graph::accessor_type::MAT3:
+            return 9u;
+        case scene_graph::accessor_type::MAT4:
+            return 16u;
+        default:
+            throw invalid_file();
+        }
+    }
+
+    std::size_t gltf::element_size(accessor const& aAccessor)
+    {
+        return component_size(aAccessor.componentType) * component_count(aAccessor.type);
+    }
+
+    std::size_t gltf::element_stride(accessor const& aAccessor) const
+    {
+        auto const& bufferView = bufferViews.at(aAccessor.bufferView.value());
+        return bufferView.byteStride.value_or(element_size(aAccessor));
+    }
+
+    uint8_t const* gltf::element_data(accessor const& aAccessor) const
+    {
+        if (!aAccessor.bufferView || aAccessor.sparse)
+            throw unsupported_accessor();
+        auto const& bufferView = bufferViews.at(*aAccessor.bufferView);
+        auto const& source = buffers.at(bufferView.buffer);
+        if (bufferView.byteOffset > source.byteLength || bufferView.byteLength > source.byteLength - bufferView.byteOffset)
+            throw accessor_out_of_bounds();
+        if (aAccessor.count != 0u)
+        {
+            // byteOffset + (count - 1) * stride + size <= byteLength, rearranged so nothing can overflow
+            auto const stride = element_stride(aAccessor);
+            auto const size = element_size(aAccessor);
+            if (aAccessor.byteOffset > bufferView.byteLength || size > bufferView.byteLength - aAccessor.byteOffset)
+                throw accessor_out_of_bounds();
+            if (stride != 0u && aAccessor.count - 1u > (bufferView.byteLength - aAccessor.byteOffset - size) / stride)
+                throw accessor_out_of_bounds();
+        }
+        return source.data() + bufferView.byteOffset + aAccessor.byteOffset;
+    }
+
+    std::size_t gltf::max_index(std::size_t aAccessor) const
+    {
+        switch (accessors.at(aAccessor).componentType)
+        {
+        case scene_graph::accessor_component_type::UNSIGNED_BYTE:
+            return file::max_index(view<uint8_t>(aAccessor));
+        case scene_graph::accessor_component_type::UNSIGNED_SHORT:
+            return file::max_index(view<uint16_t>(aAccessor));
+        case scene_graph::accessor_component_type::UNSIGNED_INT:
+            return file::max_index(view<uint32_t>(aAccessor));
+        default:
+            throw unsupported_accessor();
+        }
+    }
+
+    void gltf::validate(primitive const& aPrimitive) const
+    {
+        for (auto const& attribute : aPrimitive.attributes)
+            if (attribute.second >= accessors.size())
+                throw invalid_file();
+        if (!aPrimitive.indices)
+            return;
+        if (*aPrimitive.indices >= accessors.size())
+            throw invalid_file();
+        auto const& indices = accessors[*aPrimitive.indices];
+        auto const position = aPrimitive.attributes.find(scene_graph::vertex_attribute::POSITION);
+        if (position == aPrimitive.attributes.end() || indices.count == 0u || !indices.bufferView || indices.sparse)
+            return;
+        if (max_index(*aPrimitive.indices) >= accessors[position->second].count)
+            throw vertex_index_out_of_bounds();
+    }
+
+    void gltf::parse(std::string const& aUri, char const* aJson, std::size_t aJsonLength, uint8_t const* aBinaryChunk, std::size_t aBinaryChunkLength)
+    {
+        boost::property_tree::ptree document;
+        try
+        {
+            std::istringstream json{ std::string{ aJson, aJsonLength } };
+            boost::property_tree::read_json(json, document);
+        }
+        catch (boost::property_tree::json_parser_error const&)
+        {
+            throw invalid_file();
+        }
+        try
+        {
+            auto const& assetObject = document.get_child("asset");
+            asset.version = assetObject.get<std::string>("version");
+            if (auto const minVersion = assetObject.get_optional<std::string>("minVersion"))
+                asset.minVersion = *minVersion;
+            asset.generator = assetObject.get<std::string>("generator", "");
+            asset.copyright = assetObject.get<std::string>("copyright", "");
+            if (asset.version.empty() || asset.version[0] != '2')
+                throw unsupported_version();
+
+            static const boost::property_tree::ptree sNone;
+            auto const base = aUri.substr(0u, aUri.find_last_of("/\\") + 1u);
+            for (auto const& b : document.get_child("buffers", sNone))
+            {
+                buffer newBuffer{};
+                newBuffer.byteLength = b.second.get<std::size_t>("byteLength");
+                auto const uri = b.second.get_optional<std::string>("uri");
+                if (!uri)
+                {
+                    if (aBinaryChunk == nullptr)
+                        throw invalid_file();
+                    newBuffer.resource = iResource;
+                    newBuffer.resourceOffset = static_cast<std::size_t>(aBinaryChunk - static_cast<uint8_t const*>(iResource->cdata()));
+                    newBuffer.byteLength = std::min(newBuffer.byteLength, aBinaryChunkLength);
+                }
+                else if (uri->compare(0u, 5u, "data:") == 0)
+                {
+                    auto const comma = uri->find(',');
+                    if (comma == std::string::npos)
+                        throw invalid_file();
+                    newBuffer.decoded = decode_base64(std::string_view{ *uri }.substr(comma + 1u));
+                    newBuffer.byteLength = std::min(newBuffer.byteLength, newBuffer.decoded.size());
+                }
+                else
+                {
+                    newBuffer.resource = service<i_resource_manager>().load_resource(base + *uri);
+                    if (!newBuffer.resource || !newBuffer.resource->available())
+                        throw failed_to_open_file(base + *uri);
+                    newBuffer.byteLength = std::min(newBuffer.byteLength, newBuffer.resource->size());
+                }
+                buffers.push_back(std::move(newBuffer));
+            }
+            for (auto const& bv : document.get_child("bufferViews", sNone))
+            {
+                buffer_view newBufferView{};
+                newBufferView.name = optional_name(bv.second);
+                newBufferView.buffer = bv.second.get<std::size_t>("buffer");
+                newBufferView.byteOffset = bv.second.get<std::size_t>("byteOffset", 0u);
+                newBufferView.byteLength = bv.second.get<std::size_t>("byteLength");
+                newBufferView.byteStride = optional_index(bv.second, "byteStride");
+                if (auto const target = bv.second.get_optional<uint32_t>("target"))
+                    newBufferView.target = static_cast<scene_graph::buffer_view_target>(*target);
+                if (newBufferView.buffer >= buffers.size())
+                    throw invalid_file();
+                bufferViews.push_back(std::move(newBufferView));
+            }
+            for (auto const& a : document.get_child("accessors", sNone))
+            {
+                accessor newAccessor{};
+                newAccessor.name = optional_name(a.second);
+                newAccessor.bufferView = optional_index(a.second, "bufferView");
+                newAccessor.byteOffset = a.second.get<std::size_t>("byteOffset", 0u);
+                newAccessor.componentType = static_cast<scene_graph::accessor_component_type>(a.second.get<uint32_t>("componentType"));
+                newAccessor.normalized = a.second.get<bool>("normalized", false);
+                newAccessor.count = a.second.get<std::size_t>("count");
+                newAccessor.type = to_accessor_type(a.second.get<std::string>("type"));
+                newAccessor.sparse = a.second.get_child_optional("sparse") != boost::none;
+                if (newAccessor.bufferView && *newAccessor.bufferView >= bufferViews.size())
+                    throw invalid_file();
+                // reject accessors that reach outside their buffer view now rather than when they are first read
+                element_size(newAccessor);
+                if (newAccessor.bufferView && !newAccessor.sparse)
+                    element_data(newAccessor);
+                accessors.push_back(std::move(newAccessor));
+            }
+            for (auto const& m : document.get_child("meshes", sNone))
+            {
+                mesh newMesh{};
+                newMesh.name = optional_name(m.second);
+                for (auto const& p : m.second.get_child("primitives"))
+                {
+                    primitive newPrimitive{};
+                    for (auto const& attribute : p.second.get_child("attributes"))
+                        if (auto const vertexAttribute = to_vertex_attribute(attribute.first))
+                            newPrimitive.attributes[*vertexAttribute] = attribute.second.get_value<std::size_t>();
+                    newPrimitive.indices = optional_index(p.second, "indices");
+                    newPrimitive.material = optional_index(p.second, "material");
+                    newPrimitive.mode = static_cast<scene_graph::rendering_mode>(p.second.get<uint32_t>("mode", static_cast<uint32_t>(scene_graph::rendering_mode::TRIANGLES)));
+                    validate(newPrimitive);
+                    newMesh.primitives.push_back(std::move(newPrimitive));
+                }
+                for (auto const& w : m.second.get_child("weights", sNone))
+                    newMesh.weights.push_back(w.second.get_value<scalar>());
+                meshes.push_back(std::move(newMesh));
+            }
+            cameras.resize(document.get_child("cameras", sNone).size());
+            for (auto const& n : document.get_child("nodes", sNone))
+            {
+                node newNode{};
+                newNode.name = optional_name(n.second);
+                for (auto const& child : n.second.get_child("children", sNone))
+                    newNode.children.push_back(child.second.get_value<std::size_t>());
+                newNode.mesh = optional_index(n.second, "mesh");
+                newNode.camera = optional_index(n.second, "camera");
+                if (auto const matrix = n.second.get_child_optional("matrix"))
+                {
+                    // glTF matrices are column-major
+                    auto const elements = read_vector<16>(*matrix);
+                    matrix_transform transform;
+                    for (std::size_t column = 0u; column < 4u; ++column)
+                        for (std::size_t row = 0u; row < 4u; ++row)
+                            transform[column][row] = elements[column * 4u + row];
+                    newNode.transform = transform;
+                }
+                else if (n.second.get_child_optional("translation") || n.second.get_child_optional("rotation") || n.second.get_child_optional("scale"))
+                {
+                    trs_transform transform{ vec3{}, vec4{ 0.0, 0.0, 0.0, 1.0 }, vec3{ 1.0, 1.0, 1.0 } };
+                    if (auto const translation = n.second.get_child_optional("translation"))
+                        transform.translation = read_vector<3>(*translation);
+                    if (auto const rotation = n.second.get_child_optional("rotation"))
+                        transform.rotation = read_vector<4>(*rotation);
+                    if (auto const scale = n.second.get_child_optional("scale"))
+                        transform.scale = read_vector<3>(*scale);
+                    newNode.transform = transform;
+                }
+                if ((newNode.mesh && *newNode.mesh >= meshes.size()) || (newNode.camera && *newNode.camera >= cameras.size()))
+                    throw invalid_file();
+                nodes.push_back(std::move(newNode));
+            }
+            for (auto const& s : document.get_child("scenes", sNone))
+            {
+                scene newScene{};
+                newScene.name = optional_name(s.second);
+                for (auto const& n : s.second.get_child("nodes", sNone))
+                    newScene.nodes.push_back(n.second.get_value<std::size_t>());
+                scenes.push_back(std::move(newScene));
+            }
+            displayScene = optional_index(document, "scene");
+        }
+        catch (boost::property_tree::ptree_error const&)
+        {
+            throw invalid_file();
+        }
+        for (auto const& n : nodes)
+            for (auto child : n.children)
+                if (child >= nodes.size())
+                    throw invalid_file();
+        for (auto const& s : scenes)
+            for (auto n : s.nodes)
+                if (n >= nodes.size())
+                    throw invalid_file();
+    }
+}
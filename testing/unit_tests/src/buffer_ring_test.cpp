@@ -0,0 +1,138 @@
+// buffer_ring_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <set>
+#include <neogfx/gfx/buffer_ring.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    // Stands in for the GPU: fences only signal when complete() is called (or when waited on).
+    class mock_fence_source : public neogfx::i_fence_source
+    {
+    public:
+        fence insert_fence() override
+        {
+            auto const result = reinterpret_cast<fence>(++iNextFence);
+            iPending.insert(result);
+            iLive.insert(result);
+            return result;
+        }
+        bool fence_signalled(fence aFence) override
+        {
+            return iPending.find(aFence) == iPending.end();
+        }
+        void wait_fence(fence aFence) override
+        {
+            ++waits;
+            iPending.erase(aFence);
+        }
+        void delete_fence(fence aFence) override
+        {
+            NEOGFX_CHECK(iLive.erase(aFence) == 1u);
+            iPending.erase(aFence);
+        }
+    public:
+        void complete()
+        {
+            iPending.clear();
+        }
+        std::size_t live() const
+        {
+            return iLive.size();
+        }
+    public:
+        std::size_t waits = 0u;
+    private:
+        std::uintptr_t iNextFence = 0u;
+        std::set<fence> iPending;
+        std::set<fence> iLive;
+    };
+}
+
+NEOGFX_TEST(buffer_ring_regions)
+{
+    mock_fence_source fences;
+    neogfx::buffer_ring ring{ fences, 1000u, 3u };
+    NEOGFX_CHECK(ring.region_size() == 333u);
+    NEOGFX_CHECK(ring.region_begin() == 0u && ring.region_end() == 333u);
+    ring.advance();
+    NEOGFX_CHECK(ring.current_region() == 1u && ring.region_begin() == 333u && ring.region_end() == 666u);
+    ring.advance();
+    // the last region takes the remainder
+    NEOGFX_CHECK(ring.current_region() == 2u && ring.region_begin() == 666u && ring.region_end() == 1000u);
+    NEOGFX_CHECK(neogfx::unit_test::throws<neogfx::buffer_ring::bad_region_count>([&]() { neogfx::buffer_ring{ fences, 1000u, 0u }; }));
+}
+
+NEOGFX_TEST(buffer_ring_wraps_without_stalling)
+{
+    mock_fence_source fences;
+    neogfx::buffer_ring ring{ fences, 300u, 3u };
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        ring.advance();
+        fences.complete();
+    }
+    NEOGFX_CHECK(ring.advances() == 10u);
+    NEOGFX_CHECK(ring.current_region() == 10u % 3u);
+    NEOGFX_CHECK(ring.stalls() == 0u && fences.waits == 0u);
+}
+
+NEOGFX_TEST(buffer_ring_back_pressure)
+{
+    mock_fence_source fences;
+    neogfx::buffer_ring ring{ fences, 300u, 3u };
+    ring.advance();
+    ring.advance();
+    NEOGFX_CHECK(ring.stalls() == 0u);
+    // region 0 is still being read so returning to it waits for its fence only
+    ring.advance();
+    NEOGFX_CHECK(ring.current_region() == 0u);
+    NEOGFX_CHECK(ring.stalls() == 1u && fences.waits == 1u);
+    fences.complete();
+    ring.advance();
+    NEOGFX_CHECK(ring.stalls() == 1u);
+}
+
+NEOGFX_TEST(buffer_ring_resize)
+{
+    mock_fence_source fences;
+    neogfx::buffer_ring ring{ fences, 300u, 3u };
+    ring.advance();
+    ring.resize(600u);
+    // outstanding regions are waited for and the current span runs on to the new end
+    NEOGFX_CHECK(ring.stalls() == 1u);
+    NEOGFX_CHECK(ring.region_begin() == 100u && ring.region_end() == 600u);
+    ring.advance();
+    NEOGFX_CHECK(ring.current_region() == 0u && ring.region_begin() == 0u && ring.region_end() == 200u);
+    NEOGFX_CHECK(fences.live() == 0u);
+}
+
+NEOGFX_TEST(buffer_ring_deletes_fences)
+{
+    mock_fence_source fences;
+    {
+        neogfx::buffer_ring ring{ fences, 300u, 3u };
+        for (int frame = 0; frame < 5; ++frame)
+            ring.advance();
+        NEOGFX_CHECK(fences.live() != 0u);
+    }
+    NEOGFX_CHECK(fences.live() == 0u);
+}
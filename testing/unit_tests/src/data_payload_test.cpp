@@ -0,0 +1,138 @@
+// data_payload_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/app/i_clipboard.hpp>
+#include <neogfx/app/data_payload.hpp>
+#include <neogfx/gui/window/window.hpp>
+#include <neogfx/gui/widget/text_edit.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    // "a", "\u00E9", "\u20AC" and "\U0001F600": one to four byte UTF-8 sequences
+    std::string const sMixedText = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+    std::u16string const sMixedText16 = u"a\u00E9\u20AC\U0001F600";
+
+    neogfx::ref_ptr<neogfx::i_data_payload> generated_text(std::string const& aText)
+    {
+        return neogfx::make_ref<neogfx::generated_payload>(neogfx::TextPlainMimeType, 
+            [aText](std::uint64_t aOffset, void* aBuffer, std::size_t aBufferSize)
+            {
+                auto const count = std::min<std::size_t>(aBufferSize, aText.size() - static_cast<std::size_t>(aOffset));
+                std::copy_n(aText.begin() + static_cast<std::size_t>(aOffset), count, static_cast<char*>(aBuffer));
+                return count;
+            });
+    }
+
+    std::u16string read_utf16(neogfx::i_data_payload const& aPayload, std::size_t aChunkSize)
+    {
+        std::u16string result;
+        neogfx::read_utf16(aPayload, [&](std::u16string const& aChunk) { result += aChunk; }, aChunkSize);
+        return result;
+    }
+
+    // Holds the last payload set in memory in place of the system clipboard.
+    class test_clipboard : public neogfx::i_clipboard
+    {
+    public:
+        define_declared_event(Updated, updated)
+        define_declared_event(SinkActivated, sink_activated)
+        define_declared_event(SinkDeactivated, sink_deactivated)
+    public:
+        bool sink_active() const override { return false; }
+        neogfx::i_clipboard_sink& active_sink() override { throw no_active_sink(); }
+        void activate(neogfx::i_clipboard_sink&) override {}
+        void deactivate(neogfx::i_clipboard_sink&) override {}
+    public:
+        bool has_text() const override { return false; }
+        neogfx::i_string const& text() const override { throw std::logic_error{ "text() used instead of the payload" }; }
+        void set_text(neogfx::i_string const&) override {}
+        bool has_image() const override { return false; }
+        neogfx::image image() const override { return {}; }
+        void set_image(const neogfx::image&) override {}
+        using i_clipboard::has_payload;
+        using i_clipboard::payload;
+        bool has_payload(neogfx::i_string const& aMimeType) const override
+        {
+            return stored && stored->mime_type().to_std_string_view() == aMimeType.to_std_string_view();
+        }
+        void payload(neogfx::i_string const& aMimeType, neogfx::i_ref_ptr<neogfx::i_data_payload>& aPayload) const override
+        {
+            if (!has_payload(aMimeType))
+                throw no_payload();
+            aPayload = stored;
+        }
+        void set_payload(neogfx::i_ref_ptr<neogfx::i_data_payload> const& aPayload) override
+        {
+            stored = aPayload;
+        }
+    public:
+        void cut() override {}
+        void copy() override {}
+        void paste() override {}
+        void delete_selected() override {}
+        void select_all() override {}
+    public:
+        neogfx::ref_ptr<neogfx::i_data_payload> stored;
+    };
+}
+
+NEOGFX_TEST(data_payload_utf16_chunks)
+{
+    // every chunk size splits at least one sequence somewhere
+    for (std::size_t chunkSize = 1u; chunkSize <= sMixedText.size() + 1u; ++chunkSize)
+        NEOGFX_CHECK(read_utf16(*generated_text(sMixedText), chunkSize) == sMixedText16);
+    auto const shared = neogfx::make_ref<neogfx::shared_buffer_payload>(neogfx::TextPlainMimeType, std::string{ sMixedText });
+    NEOGFX_CHECK(read_utf16(*shared, 3u) == sMixedText16);
+    NEOGFX_CHECK(shared->to_std_string() == sMixedText);
+    NEOGFX_CHECK(generated_text(sMixedText)->to_std_string() == sMixedText);
+}
+
+NEOGFX_TEST(data_payload_utf16_truncated_sequence)
+{
+    // the last sequence is cut short: it becomes U+FFFD rather than being dropped
+    std::string const truncated = "ab\xE2\x82";
+    for (std::size_t chunkSize = 1u; chunkSize <= truncated.size() + 1u; ++chunkSize)
+        NEOGFX_CHECK(read_utf16(*generated_text(truncated), chunkSize) == u"ab\uFFFD");
+}
+
+NEOGFX_TEST(text_edit_copy_paste_payload)
+{
+    neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    neogfx::text_edit edit{ window.client_layout() };
+    test_clipboard clipboard;
+    edit.set_text(std::string{ "line\r\n" } + sMixedText + "\rend");
+    edit.select_all();
+    edit.copy(clipboard);
+    NEOGFX_CHECK(clipboard.stored);
+    NEOGFX_CHECK(clipboard.stored->shared());
+    // a lone CR is copied as a line break
+    std::string const expected = "line\n" + sMixedText + "\nend";
+    NEOGFX_CHECK(clipboard.stored->to_std_string() == expected);
+    edit.cursor().set_position(edit.document_length());
+    edit.paste(clipboard);
+    NEOGFX_CHECK(edit.text().to_std_string() == "line\n" + sMixedText + "\rend" + expected);
+    // a payload that is not shared is read a chunk at a time
+    clipboard.stored = generated_text(sMixedText);
+    edit.select_all();
+    edit.paste(clipboard);
+    NEOGFX_CHECK(edit.text().to_std_string() == sMixedText);
+}
@@ -0,0 +1,118 @@
+// gltf_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstring>
+#include <neogfx/app/i_resource_manager.hpp>
+#include <neogfx/support/file/gfx/gltf.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    using neogfx::file::gltf;
+
+    void append_uint32(std::vector<uint8_t>& aBytes, uint32_t aValue)
+    {
+        for (uint32_t shift = 0u; shift < 32u; shift += 8u)
+            aBytes.push_back(static_cast<uint8_t>(aValue >> shift));
+    }
+
+    // A GLB container: 12 byte header, JSON chunk padded with spaces and a BIN chunk padded with zeros.
+    std::vector<uint8_t> make_glb(std::string aJson, std::vector<uint8_t> aBinary, std::optional<uint32_t> aJsonLength = {})
+    {
+        while (aJson.size() % 4u != 0u)
+            aJson.push_back(' ');
+        while (aBinary.size() % 4u != 0u)
+            aBinary.push_back(0u);
+        std::vector<uint8_t> result;
+        append_uint32(result, 0x46546C67u);
+        append_uint32(result, 2u);
+        append_uint32(result, static_cast<uint32_t>(12u + 8u + aJson.size() + 8u + aBinary.size()));
+        append_uint32(result, aJsonLength.value_or(static_cast<uint32_t>(aJson.size())));
+        append_uint32(result, 0x4E4F534Au);
+        result.insert(result.end(), aJson.begin(), aJson.end());
+        append_uint32(result, static_cast<uint32_t>(aBinary.size()));
+        append_uint32(result, 0x004E4942u);
+        result.insert(result.end(), aBinary.begin(), aBinary.end());
+        return result;
+    }
+
+    // One triangle: three VEC3 float positions followed by three uint32 indices.
+    std::vector<uint8_t> triangle_data(uint32_t aLastIndex = 2u)
+    {
+        float const positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+        uint32_t const indices[] = { 0u, 1u, aLastIndex };
+        std::vector<uint8_t> result(sizeof(positions) + sizeof(indices));
+        std::memcpy(result.data(), positions, sizeof(positions));
+        std::memcpy(result.data() + sizeof(positions), indices, sizeof(indices));
+        return result;
+    }
+
+    std::string triangle_json(std::string const& aIndexCount = "3", std::string const& aPositionAccessor = "0")
+    {
+        return 
+            R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":48}],)"
+            R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":12}],)"
+            R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},)"
+            R"({"bufferView":1,"componentType":5125,"count":)" + aIndexCount + R"(,"type":"SCALAR"}],)"
+            R"("meshes":[{"primitives":[{"attributes":{"POSITION":)" + aPositionAccessor + R"(},"indices":1}]}]})";
+    }
+
+    std::string add_glb(std::string const& aName, std::vector<uint8_t> const& aGlb)
+    {
+        std::string const uri = ":/neogfx/unit_tests/" + aName + ".glb";
+        neogfx::service<neogfx::i_resource_manager>().add_resource(uri, aGlb.data(), aGlb.size());
+        return uri;
+    }
+}
+
+NEOGFX_TEST(gltf_glb_triangle)
+{
+    gltf const triangle{ add_glb("triangle", make_glb(triangle_json(), triangle_data())) };
+    auto const mesh = triangle.to_mesh(0u);
+    NEOGFX_CHECK(mesh.vertices.size() == 3u);
+    NEOGFX_CHECK(mesh.faces.size() == 1u);
+}
+
+NEOGFX_TEST(gltf_glb_truncated)
+{
+    auto glb = make_glb(triangle_json(), triangle_data());
+    // cut off in the middle of the JSON chunk; the header still claims the full length
+    glb.resize(40u);
+    auto const uri = add_glb("truncated", glb);
+    NEOGFX_CHECK(neogfx::unit_test::throws<gltf::invalid_file>([&]() { gltf{ uri }; }));
+}
+
+NEOGFX_TEST(gltf_glb_overflowing_lengths)
+{
+    // a JSON chunk length that wraps 20 + length around to a small value in 32-bit arithmetic
+    auto const jsonLengthUri = add_glb("overflowing_json", make_glb(triangle_json(), triangle_data(), 0xFFFFFFF0u));
+    NEOGFX_CHECK(neogfx::unit_test::throws<gltf::invalid_file>([&]() { gltf{ jsonLengthUri }; }));
+    // an accessor count for which byteOffset + (count - 1) * stride + size wraps around
+    auto const countUri = add_glb("overflowing_count", make_glb(triangle_json("4611686018427387905"), triangle_data()));
+    NEOGFX_CHECK(neogfx::unit_test::throws<gltf::accessor_out_of_bounds>([&]() { gltf{ countUri }; }));
+}
+
+NEOGFX_TEST(gltf_glb_out_of_range_index)
+{
+    auto const indexUri = add_glb("out_of_range_index", make_glb(triangle_json(), triangle_data(3u)));
+    NEOGFX_CHECK(neogfx::unit_test::throws<gltf::vertex_index_out_of_bounds>([&]() { gltf{ indexUri }; }));
+    auto const accessorUri = add_glb("out_of_range_accessor", make_glb(triangle_json("3", "7"), triangle_data()));
+    NEOGFX_CHECK(neogfx::unit_test::throws<gltf::invalid_file>([&]() { gltf{ accessorUri }; }));
+}
@@ -0,0 +1,72 @@
+// html_tokenizer_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <sstream>
+#include <neogfx/core/html.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    class recording_handler : public neogfx::i_html_handler
+    {
+    public:
+        void doctype(std::string_view aDeclaration) final { tokens += "D(" + std::string{ aDeclaration } + ")"; }
+        void start_element(std::string_view aName, const neogfx::html_attributes& aAttributes, bool aSelfClosing) final
+        {
+            tokens += "S(" + std::string{ aName };
+            for (auto const& attribute : aAttributes)
+                tokens += " " + std::string{ attribute.first } + "=" + std::string{ attribute.second };
+            tokens += aSelfClosing ? "/)" : ")";
+        }
+        void end_element(std::string_view aName) final { tokens += "E(" + std::string{ aName } + ")"; }
+        void character_data(std::string_view aText) final { tokens += aText; }
+        void comment(std::string_view aText) final { tokens += "C(" + std::string{ aText } + ")"; }
+    public:
+        std::string tokens;
+    };
+
+    std::string tokenize(std::string const& aDocument, std::size_t aChunkSize)
+    {
+        std::istringstream input{ aDocument };
+        recording_handler handler;
+        neogfx::html_tokenizer{ input, handler, aChunkSize }.tokenize();
+        return handler.tokens;
+    }
+}
+
+NEOGFX_TEST(html_tokenizer_chunk_size_independent)
+{
+    std::string const document =
+        "<!DOCTYPE html><html><!-- a -- comment --><body class=\"x > y\" id='z'>"
+        "a &amp; b<br/><script>if (a </b) x();</script></body></html>";
+    auto const expected = tokenize(document, document.size());
+    for (std::size_t chunkSize = 1u; chunkSize < document.size(); ++chunkSize)
+        NEOGFX_CHECK(tokenize(document, chunkSize) == expected);
+}
+
+NEOGFX_BENCHMARK(html_tokenizer_long_tokens)
+{
+    // tokens much longer than a chunk are not rescanned from their start each time a chunk is read
+    std::string document;
+    document += "<!--" + std::string(0x40000u, '-') + "-->";
+    document += "<p title=\"" + std::string(0x40000u, '>') + "\">";
+    auto const time = neogfx::unit_test::measure(1u, [&]() { tokenize(document, 0x100u); });
+    neogfx::unit_test::report("512 KiB of long tokens in 256 byte chunks", time, "us");
+}
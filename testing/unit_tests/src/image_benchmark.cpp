@@ -0,0 +1,46 @@
+// image_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/image.hpp>
+#include "unit_test.hpp"
+
+// Throughput of decoding the same embedded PNG 64 times on the calling thread and through image::load_async(),
+// which queues each load to the resource manager's loader threads.
+NEOGFX_BENCHMARK(image_load_throughput)
+{
+    neogfx::unit_test::test_app();
+    std::string const uri = ":/neogfx/resources/icons/neoGFX.png";
+    std::size_t const imageCount = 64u;
+    auto const sequential = neogfx::unit_test::measure(1u, [&]()
+    {
+        for (std::size_t i = 0u; i < imageCount; ++i)
+            NEOGFX_CHECK(neogfx::image{ uri }.extents() != neogfx::size{});
+    });
+    neogfx::unit_test::report("calling thread", imageCount / (sequential / 1000000.0), "images/s");
+    auto const async = neogfx::unit_test::measure(1u, [&]()
+    {
+        std::vector<std::future<neogfx::ref_ptr<neogfx::i_image>>> loads;
+        for (std::size_t i = 0u; i < imageCount; ++i)
+            loads.push_back(neogfx::image::load_async(uri));
+        for (auto& load : loads)
+            NEOGFX_CHECK(load.get()->extents() != neogfx::size{});
+    });
+    neogfx::unit_test::report("image::load_async", imageCount / (async / 1000000.0), "images/s");
+}
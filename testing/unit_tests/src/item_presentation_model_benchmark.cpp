@@ -0,0 +1,91 @@
+// item_presentation_model_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <random>
+#include <neogfx/gui/window/window.hpp>
+#include <neogfx/gui/widget/item_model.hpp>
+#include <neogfx/gui/widget/item_presentation_model.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    void fill_integers(neogfx::item_model& aModel, uint32_t aRows)
+    {
+        aModel.reserve(aRows);
+        for (uint32_t row = 0u; row < aRows; ++row)
+            aModel.insert_item(aModel.end(), neogfx::item_cell_data{ row * 7919u % 1000003u });
+    }
+
+    void fill_prices(neogfx::item_model& aModel, uint32_t aRows, std::mt19937& aRandom)
+    {
+        std::uniform_real_distribution<double> price{ 1.0, 1000.0 };
+        aModel.reserve(aRows);
+        for (uint32_t row = 0u; row < aRows; ++row)
+            aModel.insert_item(aModel.end(), neogfx::item_cell_data{ price(aRandom) });
+    }
+}
+
+// Time taken by the first column_width() of an integer column, which shapes the cells it measures, with the
+// Sampled and Exact width policies.
+NEOGFX_BENCHMARK(column_width_sampling)
+{
+    neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    for (uint32_t rows : { 10000u, 100000u, 1000000u })
+    {
+        neogfx::item_model model;
+        fill_integers(model, rows);
+        for (auto policy : { neogfx::item_presentation_model::column_width_policy::Sampled, neogfx::item_presentation_model::column_width_policy::Exact })
+        {
+            neogfx::item_presentation_model presentationModel{ model };
+            presentationModel.set_width_policy(policy);
+            auto const width = neogfx::unit_test::measure(1u, [&]() { presentationModel.column_width(0u, window); });
+            neogfx::unit_test::report(std::to_string(rows) + " rows, " + (policy == neogfx::item_presentation_model::column_width_policy::Sampled ? "sampled" : "exact"), width / 1000.0, "ms");
+        }
+    }
+}
+
+// A headless ticker: single price changes to a 100k row model sorted on the price column. A change outside of an
+// update repositions just the changed row; the same change made as a bulk update falls back to a full re-sort.
+NEOGFX_BENCHMARK(sorted_ticker_updates)
+{
+    neogfx::unit_test::test_app();
+    uint32_t const rows = 100000u;
+    std::mt19937 random{ 42u };
+    neogfx::item_model model;
+    fill_prices(model, rows, random);
+    neogfx::item_presentation_model presentationModel{ model, true };
+    presentationModel.sort_by(0u, neogfx::item_presentation_model::sort_direction::Ascending);
+    std::uniform_int_distribution<uint32_t> row{ 0u, rows - 1u };
+    std::uniform_real_distribution<double> price{ 1.0, 1000.0 };
+    auto const tick = [&]()
+    {
+        model.update_cell_data(neogfx::item_model_index{ row(random), 0u }, neogfx::item_cell_data{ price(random) });
+    };
+    auto const incremental = neogfx::unit_test::measure(10000u, tick);
+    neogfx::unit_test::report("incremental", 1000000.0 / incremental, "updates/s");
+    auto const full = neogfx::unit_test::measure(20u, [&]()
+    {
+        presentationModel.begin_update();
+        tick();
+        presentationModel.end_update();
+    });
+    neogfx::unit_test::report("full re-sort", 1000000.0 / full, "updates/s");
+}
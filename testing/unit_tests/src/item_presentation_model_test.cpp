@@ -0,0 +1,109 @@
+// item_presentation_model_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <memory>
+#include <random>
+#include <neogfx/gui/window/window.hpp>
+#include <neogfx/gui/widget/item_model.hpp>
+#include <neogfx/gui/widget/item_presentation_model.hpp>
+#include "unit_test.hpp"
+
+NEOGFX_TEST(column_width_sampling_skips_unsupported_cells)
+{
+    neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    neogfx::item_model model;
+    // an empty first cell and one wide cell that is neither a leading row nor the middle row of a stratum
+    model.insert_item(model.end(), neogfx::item_cell_data{});
+    for (uint32_t row = 1u; row < 5000u; ++row)
+        model.insert_item(model.end(), neogfx::item_cell_data{ row == 2345u ? 123456789u : 1u });
+    neogfx::item_presentation_model sampled{ model };
+    neogfx::item_presentation_model exact{ model };
+    exact.set_width_policy(neogfx::item_presentation_model::column_width_policy::Exact);
+    NEOGFX_CHECK(sampled.width_policy() == neogfx::item_presentation_model::column_width_policy::Sampled);
+    NEOGFX_CHECK(sampled.column_width(0u, window) == exact.column_width(0u, window));
+}
+
+NEOGFX_TEST(glyph_text_cache_is_bounded_and_handles_survive_eviction)
+{
+    neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    neogfx::item_model model;
+    uint32_t const rows = 4000u;
+    for (uint32_t row = 0u; row < rows; ++row)
+        model.insert_item(model.end(), neogfx::item_cell_data{ row });
+    neogfx::item_presentation_model presentationModel{ model };
+    auto const capacity = presentationModel.glyph_text_cache_capacity();
+    NEOGFX_CHECK(capacity < rows);
+    auto const pinned = presentationModel.cell_glyph_text(neogfx::item_presentation_model_index{ 0u, 0u });
+    auto const pinnedExtents = pinned->extents();
+    // shape every cell once, holding nothing but weak references so only the cache keeps text alive
+    std::vector<std::weak_ptr<const neogfx::glyph_text>> shaped;
+    for (uint32_t row = 1u; row < rows; ++row)
+        shaped.push_back(presentationModel.cell_glyph_text(neogfx::item_presentation_model_index{ row, 0u }));
+    std::size_t live = 0u;
+    for (auto const& text : shaped)
+        if (!text.expired())
+            ++live;
+    NEOGFX_CHECK(live <= capacity);
+    // row 0 has been evicted but the handle taken before eviction is still usable
+    NEOGFX_CHECK(pinned->extents() == pinnedExtents);
+    auto const reshaped = presentationModel.cell_glyph_text(neogfx::item_presentation_model_index{ 0u, 0u });
+    NEOGFX_CHECK(reshaped != pinned);
+    NEOGFX_CHECK(reshaped->extents() == pinnedExtents);
+    // shrinking the cache clears it; handles are unaffected
+    presentationModel.set_glyph_text_cache_capacity(capacity * 4u);
+    for (uint32_t row = 0u; row < rows; ++row)
+        presentationModel.cell_glyph_text(neogfx::item_presentation_model_index{ row, 0u });
+    presentationModel.set_glyph_text_cache_capacity(capacity);
+    NEOGFX_CHECK(reshaped->extents() == pinnedExtents);
+}
+
+NEOGFX_TEST(single_item_changes_keep_rows_sorted)
+{
+    neogfx::unit_test::test_app();
+    neogfx::item_model model;
+    std::mt19937 random{ 42u };
+    std::uniform_int_distribution<int32_t> value{ 0, 99 };
+    uint32_t const rows = 500u;
+    for (uint32_t row = 0u; row < rows; ++row)
+        model.insert_item(model.end(), neogfx::item_cell_data{ value(random) });
+    neogfx::item_presentation_model presentationModel{ model, true };
+    presentationModel.sort_by(0u, neogfx::item_presentation_model::sort_direction::Descending);
+    std::uniform_int_distribution<uint32_t> row{ 0u, rows - 1u };
+    for (int update = 0; update < 2000; ++update)
+    {
+        model.update_cell_data(neogfx::item_model_index{ row(random), 0u }, neogfx::item_cell_data{ value(random) });
+        if (update % 100 != 0)
+            continue;
+        // rows are in order and each still maps back to the item it presents
+        for (uint32_t presented = 0u; presented < rows; ++presented)
+        {
+            auto const index = presentationModel.to_item_model_index(neogfx::item_presentation_model_index{ presented, 0u });
+            NEOGFX_CHECK(presentationModel.from_item_model_index(index).row() == presented);
+            if (presented > 0u)
+            {
+                auto const previous = presentationModel.to_item_model_index(neogfx::item_presentation_model_index{ presented - 1u, 0u });
+                NEOGFX_CHECK(!(model.cell_data(previous) < model.cell_data(index)));
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+// main.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstring>
+#include "unit_test.hpp"
+
+// Runs every registered test; benchmarks only run when "--benchmark" is passed as they are
+// timing reports rather than pass/fail checks. A test name on the command line selects that
+// test (or benchmark) alone. The exit code is the number of failures.
+int main(int argc, char* argv[])
+{
+    bool runBenchmarks = false;
+    char const* selected = nullptr;
+    for (int arg = 1; arg < argc; ++arg)
+        if (std::strcmp(argv[arg], "--benchmark") == 0)
+            runBenchmarks = true;
+        else
+            selected = argv[arg];
+
+    int failures = 0;
+    for (auto const& testCase : neogfx::unit_test::test_cases())
+    {
+        if (selected != nullptr ? std::strcmp(selected, testCase.name) != 0 : 
+            testCase.kind == neogfx::unit_test::test_kind::Benchmark && !runBenchmarks)
+            continue;
+        std::cout << testCase.name << std::endl;
+        try
+        {
+            testCase.function();
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << "  FAILED: " << e.what() << std::endl;
+            ++failures;
+        }
+    }
+    std::cout << (failures == 0 ? "all tests passed" : std::to_string(failures) + " test(s) failed") << std::endl;
+    return failures;
+}
@@ -0,0 +1,76 @@
+// path_stroker_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cmath>
+#include <random>
+#include <neogfx/gfx/path_stroker.hpp>
+#include <neogfx/gfx/line_geometry.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    neogfx::path make_plot(std::size_t aPoints, bool aNoisy)
+    {
+        std::mt19937 random{ 42u };
+        std::uniform_real_distribution<double> noise{ -20.0, 20.0 };
+        neogfx::path result{ neogfx::path_shape::LineStrip };
+        for (std::size_t i = 0u; i < aPoints; ++i)
+        {
+            auto const x = static_cast<double>(i) * 0.01;
+            auto const y = 100.0 + 50.0 * std::sin(x * 0.1) + (aNoisy ? noise(random) : 0.0);
+            if (i == 0u)
+                result.move_to(x, y);
+            else
+                result.line_to(x, y);
+        }
+        return result;
+    }
+}
+
+// Time taken to stroke a 100000 point plot with a 1.5 pixel pen with each join, against building the overlapping
+// quads that line paths were drawn with before the stroker.
+NEOGFX_BENCHMARK(path_stroker_plot)
+{
+    for (bool noisy : { false, true })
+    {
+        auto const plot = make_plot(100000u, noisy);
+        std::string const name = noisy ? "noisy plot" : "smooth plot";
+        for (auto join : { neogfx::line_join::Miter, neogfx::line_join::Round, neogfx::line_join::Bevel })
+        {
+            neogfx::pen const pen = neogfx::pen{ neogfx::color::White, 1.5 }.with_join(join);
+            std::size_t vertexCount = 0u;
+            auto const stroke = neogfx::unit_test::measure(10u, [&]() { vertexCount = neogfx::path_stroker::stroke(plot, pen).vertices.size(); });
+            std::string const joinName = join == neogfx::line_join::Miter ? "miter" : join == neogfx::line_join::Round ? "round" : "bevel";
+            neogfx::unit_test::report(name + ", " + joinName + " join", stroke / 1000.0, "ms");
+            neogfx::unit_test::report(name + ", " + joinName + " join", static_cast<double>(vertexCount), "strip vertices");
+        }
+        std::size_t vertexCount = 0u;
+        auto const quads = neogfx::unit_test::measure(10u, [&]()
+        {
+            neogfx::vertices lineQuads;
+            neogfx::lines_to_quads(neogfx::line_strip_to_lines(plot.to_vertices(plot.sub_paths()[0])), 1.5, lineQuads);
+            neogfx::vertices triangles;
+            neogfx::quads_to_triangles(lineQuads, triangles);
+            vertexCount = triangles.size();
+        });
+        neogfx::unit_test::report(name + ", overlapping quads", quads / 1000.0, "ms");
+        neogfx::unit_test::report(name + ", overlapping quads", static_cast<double>(vertexCount), "triangle vertices");
+    }
+}
@@ -0,0 +1,131 @@
+// path_tessellator_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <random>
+#include <neogfx/gfx/path_tessellator.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    typedef std::vector<neogfx::point> polygon;
+
+    neogfx::path make_path(std::vector<polygon> const& aPolygons, neogfx::fill_rule aFillRule)
+    {
+        neogfx::path result;
+        result.set_fill_rule(aFillRule);
+        for (auto const& p : aPolygons)
+        {
+            result.move_to(p[0]);
+            for (std::size_t i = 1u; i < p.size(); ++i)
+                result.line_to(p[i]);
+        }
+        return result;
+    }
+
+    // reference rasteriser: winding number of the closed sub-paths from the crossings of a ray towards +x
+    bool reference_inside(neogfx::path const& aPath, neogfx::point const& aPoint)
+    {
+        int32_t winding = 0;
+        for (auto const& subPath : aPath.sub_paths())
+            for (std::size_t i = 0u; i < subPath.size(); ++i)
+            {
+                auto const& from = subPath[i];
+                auto const& to = subPath[(i + 1u) % subPath.size()];
+                if ((from.y <= aPoint.y) == (to.y <= aPoint.y))
+                    continue;
+                if (from.x + (aPoint.y - from.y) * (to.x - from.x) / (to.y - from.y) > aPoint.x)
+                    winding += (to.y > from.y ? 1 : -1);
+            }
+        return aPath.fill_rule() == neogfx::fill_rule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+    }
+
+    std::size_t covering_triangles(neogfx::tessellated_path const& aTessellation, neogfx::point const& aPoint)
+    {
+        std::size_t result = 0u;
+        auto const side = [&](neogfx::xyz const& aFrom, neogfx::xyz const& aTo)
+        {
+            return (aTo.x - aFrom.x) * (aPoint.y - aFrom.y) - (aTo.y - aFrom.y) * (aPoint.x - aFrom.x);
+        };
+        for (std::size_t i = 0u; i + 2u < aTessellation.indices.size(); i += 3u)
+        {
+            auto const& v0 = aTessellation.vertices[aTessellation.indices[i]];
+            auto const& v1 = aTessellation.vertices[aTessellation.indices[i + 1u]];
+            auto const& v2 = aTessellation.vertices[aTessellation.indices[i + 2u]];
+            auto const s0 = side(v0, v1);
+            auto const s1 = side(v1, v2);
+            auto const s2 = side(v2, v0);
+            if ((s0 > 0.0 && s1 > 0.0 && s2 > 0.0) || (s0 < 0.0 && s1 < 0.0 && s2 < 0.0))
+                ++result;
+        }
+        return result;
+    }
+
+    // every sample point is covered by exactly one triangle if the reference says it is inside and by none otherwise;
+    // sample points are offset from the grid so that they do not fall on edges or vertices
+    bool matches_reference(neogfx::path const& aPath, double aExtent)
+    {
+        auto const tessellation = neogfx::path_tessellator::tessellate(aPath);
+        for (double y = -1.0 + 0.1234; y < aExtent + 1.0; y += 0.25)
+            for (double x = -1.0 + 0.0567; x < aExtent + 1.0; x += 0.25)
+            {
+                neogfx::point const sample{ x, y };
+                if (covering_triangles(tessellation, sample) != (reference_inside(aPath, sample) ? 1u : 0u))
+                    return false;
+            }
+        return true;
+    }
+}
+
+NEOGFX_TEST(path_tessellator_shapes)
+{
+    polygon const concave{ { 0.0, 0.0 }, { 20.0, 0.0 }, { 20.0, 20.0 }, { 10.0, 8.0 }, { 0.0, 20.0 } };
+    polygon const star{ { 10.0, 0.0 }, { 16.0, 20.0 }, { 0.0, 7.0 }, { 20.0, 7.0 }, { 4.0, 20.0 } };
+    polygon const outer{ { 0.0, 0.0 }, { 20.0, 0.0 }, { 20.0, 20.0 }, { 0.0, 20.0 } };
+    polygon const innerSame{ { 5.0, 5.0 }, { 15.0, 5.0 }, { 15.0, 15.0 }, { 5.0, 15.0 } };
+    polygon const innerOpposite{ { 5.0, 5.0 }, { 5.0, 15.0 }, { 15.0, 15.0 }, { 15.0, 5.0 } };
+    polygon const overlapping{ { 10.0, 10.0 }, { 25.0, 10.0 }, { 25.0, 25.0 }, { 10.0, 25.0 } };
+    for (auto fillRule : { neogfx::fill_rule::NonZero, neogfx::fill_rule::EvenOdd })
+    {
+        NEOGFX_CHECK(matches_reference(make_path({ concave }, fillRule), 20.0));
+        NEOGFX_CHECK(matches_reference(make_path({ star }, fillRule), 20.0));
+        NEOGFX_CHECK(matches_reference(make_path({ outer, innerSame }, fillRule), 20.0));
+        NEOGFX_CHECK(matches_reference(make_path({ outer, innerOpposite }, fillRule), 20.0));
+        NEOGFX_CHECK(matches_reference(make_path({ outer, overlapping }, fillRule), 25.0));
+    }
+}
+
+NEOGFX_TEST(path_tessellator_random_polygons)
+{
+    // random self-intersecting polygons, one or two per path
+    std::mt19937 random{ 42u };
+    std::uniform_real_distribution<double> coordinate{ 0.0, 30.0 };
+    for (int iteration = 0; iteration < 100; ++iteration)
+    {
+        std::vector<polygon> polygons(1u + iteration % 2);
+        for (auto& p : polygons)
+        {
+            p.resize(std::uniform_int_distribution<std::size_t>{ 3u, 12u }(random));
+            for (auto& v : p)
+                v = neogfx::point{ coordinate(random), coordinate(random) };
+        }
+        for (auto fillRule : { neogfx::fill_rule::NonZero, neogfx::fill_rule::EvenOdd })
+            NEOGFX_CHECK(matches_reference(make_path(polygons, fillRule), 30.0));
+    }
+}
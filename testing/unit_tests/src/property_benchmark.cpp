@@ -0,0 +1,91 @@
+// property_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstdlib>
+#include <new>
+#include <neogfx/core/object.hpp>
+#include <neogfx/core/property.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    // allocations made by the benchmark's own thread while counting
+    thread_local bool tCountingAllocations = false;
+    thread_local std::size_t tAllocations = 0u;
+
+    class labelled : public neogfx::object<neogfx::i_property_owner>
+    {
+    public:
+        neogfx::property<std::string, neogfx::property_category::other, labelled> Label{ *this, "Label", std::string{} };
+    };
+
+    template <typename Function>
+    double allocations_per_call(std::size_t aCalls, Function aFunction)
+    {
+        tAllocations = 0u;
+        tCountingAllocations = true;
+        for (std::size_t i = 0u; i < aCalls; ++i)
+            aFunction();
+        tCountingAllocations = false;
+        return static_cast<double>(tAllocations) / static_cast<double>(aCalls);
+    }
+}
+
+void* operator new(std::size_t aSize)
+{
+    if (tCountingAllocations)
+        ++tAllocations;
+    if (auto result = std::malloc(aSize != 0u ? aSize : 1u))
+        return result;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* aPointer) noexcept
+{
+    std::free(aPointer);
+}
+
+void operator delete(void* aPointer, std::size_t) noexcept
+{
+    std::free(aPointer);
+}
+
+// Heap allocations and time per set() of a 40 character string property, with no subscribers and with a
+// subscriber to each kind of change event.
+NEOGFX_BENCHMARK(property_set_allocations)
+{
+    std::string const values[] = { std::string(40u, 'a'), std::string(40u, 'b') };
+    labelled unobserved;
+    labelled observed;
+    observed.Label.Changed([](std::string const&) {});
+    labelled observedAsVariant;
+    observedAsVariant.Label.PropertyChanged([](neogfx::property_variant const&) {});
+    std::size_t setCount = 0u;
+    for (auto* object : { &unobserved, &observed, &observedAsVariant })
+    {
+        std::string const name = object == &unobserved ? "no subscribers" : object == &observed ? "Changed subscriber" : "PropertyChanged subscriber";
+        auto const set = [&]() { object->Label = values[++setCount % 2u]; };
+        // the first sets size the value and previous value strings
+        set();
+        set();
+        neogfx::unit_test::report(name, allocations_per_call(10000u, set), "allocations per set");
+        neogfx::unit_test::report(name, neogfx::unit_test::measure(100000u, set), "us per set");
+    }
+}
@@ -0,0 +1,133 @@
+// range_allocator_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <random>
+#include <bit>
+#include <neogfx/gfx/range_allocator.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    // reference model: one flag per buffer element
+    struct occupancy
+    {
+        std::vector<bool> used;
+
+        std::size_t free_size() const
+        {
+            return static_cast<std::size_t>(std::count(used.begin(), used.end(), false));
+        }
+        std::size_t free_run_count() const
+        {
+            std::size_t result = 0u;
+            for (std::size_t i = 0u; i < used.size(); ++i)
+                if (!used[i] && (i == 0u || used[i - 1u]))
+                    ++result;
+            return result;
+        }
+        std::size_t largest_free_run() const
+        {
+            std::size_t result = 0u;
+            std::size_t run = 0u;
+            for (bool u : used)
+            {
+                run = u ? 0u : run + 1u;
+                result = std::max(result, run);
+            }
+            return result;
+        }
+    };
+}
+
+NEOGFX_TEST(range_allocator_coalesces)
+{
+    neogfx::range_allocator allocator;
+    NEOGFX_CHECK(allocator.empty() && !allocator.allocate(1u));
+    allocator.deallocate(0u, 100u);
+    auto const a = allocator.allocate(10u);
+    auto const b = allocator.allocate(10u);
+    auto const c = allocator.allocate(10u);
+    NEOGFX_CHECK(a && b && c && *a == 0u && *b == 10u && *c == 20u);
+    NEOGFX_CHECK(allocator.free_size() == 70u && allocator.free_range_count() == 1u);
+    allocator.deallocate(*a, *a + 10u);
+    allocator.deallocate(*c, *c + 10u);
+    NEOGFX_CHECK(allocator.free_range_count() == 2u && allocator.largest_free_range() == 80u);
+    // freeing the middle range merges it with both neighbours
+    allocator.deallocate(*b, *b + 10u);
+    NEOGFX_CHECK(allocator.free_range_count() == 1u && allocator.largest_free_range() == 100u && allocator.fragmentation() == 0.0);
+    bool threw = false;
+    try
+    {
+        allocator.deallocate(10u, 5u);
+    }
+    catch (neogfx::range_allocator::bad_range const&)
+    {
+        threw = true;
+    }
+    NEOGFX_CHECK(threw);
+}
+
+NEOGFX_TEST(range_allocator_fuzz)
+{
+    // random allocations and frees checked against the reference model after every operation: ranges never
+    // overlap, free ranges are always fully coalesced and a request fails only if no free range is certain to fit
+    std::size_t const capacity = 4096u;
+    neogfx::range_allocator allocator;
+    allocator.deallocate(0u, capacity);
+    occupancy model{ std::vector<bool>(capacity, false) };
+    std::vector<std::pair<std::size_t, std::size_t>> allocated;
+    std::mt19937 random{ 42u };
+    for (int operation = 0; operation < 20000; ++operation)
+    {
+        if (allocated.empty() || std::uniform_int_distribution<int>{ 0, 2 }(random) != 0)
+        {
+            auto const count = std::uniform_int_distribution<std::size_t>{ 1u, 96u }(random);
+            auto const start = allocator.allocate(count);
+            if (start)
+            {
+                NEOGFX_CHECK(*start + count <= capacity);
+                for (auto i = *start; i < *start + count && i < capacity; ++i)
+                {
+                    NEOGFX_CHECK(!model.used[i]);
+                    model.used[i] = true;
+                }
+                allocated.emplace_back(*start, *start + count);
+            }
+            else
+                NEOGFX_CHECK(model.largest_free_run() < std::bit_ceil(count));
+        }
+        else
+        {
+            auto const victim = std::uniform_int_distribution<std::size_t>{ 0u, allocated.size() - 1u }(random);
+            auto const [start, end] = allocated[victim];
+            allocated[victim] = allocated.back();
+            allocated.pop_back();
+            allocator.deallocate(start, end);
+            for (auto i = start; i < end; ++i)
+                model.used[i] = false;
+        }
+        NEOGFX_CHECK(allocator.free_size() == model.free_size());
+        NEOGFX_CHECK(allocator.free_range_count() == model.free_run_count());
+        NEOGFX_CHECK(allocator.largest_free_range() == model.largest_free_run());
+    }
+    for (auto const& [start, end] : allocated)
+        allocator.deallocate(start, end);
+    NEOGFX_CHECK(allocator.free_size() == capacity && allocator.free_range_count() == 1u);
+}
@@ -0,0 +1,97 @@
+// stipple_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cmath>
+#include <neogfx/gfx/line_geometry.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    void stipple(neogfx::vertices const& aLines, double aLineWidth, neogfx::vertices& aTriangles, std::vector<float>& aDistances, bool aLoop = false)
+    {
+        neogfx::vertices quads;
+        neogfx::lines_to_quads(aLines, aLineWidth, quads);
+        neogfx::quads_to_triangles(quads, aTriangles);
+        neogfx::stipple_distances(aTriangles, aDistances, aLoop);
+    }
+
+    // the distance the stipple shader interpolates at a point on the axis of the quad drawn for line aLine
+    double distance_at(neogfx::vertices const& aTriangles, std::vector<float> const& aDistances, std::size_t aLine, neogfx::vec3 const& aPoint)
+    {
+        auto const quad = aLine * 6u;
+        auto const quadStart = (aTriangles[quad] + aTriangles[quad + 1u]) * 0.5;
+        return aDistances[quad] + (aPoint - quadStart).magnitude();
+    }
+
+    bool near(double aLhs, double aRhs)
+    {
+        return std::abs(aLhs - aRhs) < 1.0e-3;
+    }
+}
+
+NEOGFX_TEST(stipple_continuous_along_strip)
+{
+    // at every join of a strip both lines give the same distance, and each line advances it by its own length
+    neogfx::vertices const strip{
+        neogfx::vec3{ 0.0, 0.0, 0.0 }, neogfx::vec3{ 10.0, 0.0, 0.0 }, neogfx::vec3{ 10.0, 5.0, 0.0 },
+        neogfx::vec3{ 20.0, 15.0, 0.0 }, neogfx::vec3{ 5.0, 15.0, 0.0 } };
+    for (double lineWidth : { 1.0, 2.0, 7.0 })
+    {
+        neogfx::vertices triangles;
+        std::vector<float> distances;
+        stipple(neogfx::line_strip_to_lines(strip), lineWidth, triangles, distances);
+        NEOGFX_CHECK(triangles.size() == (strip.size() - 1u) * 6u && distances.size() == triangles.size());
+        double length = 0.0;
+        for (std::size_t line = 0u; line + 1u < strip.size(); ++line)
+        {
+            NEOGFX_CHECK(near(distance_at(triangles, distances, line, strip[line]), lineWidth / 2.0 + length));
+            length += (strip[line + 1u] - strip[line]).magnitude();
+            NEOGFX_CHECK(near(distance_at(triangles, distances, line, strip[line + 1u]), lineWidth / 2.0 + length));
+            if (line + 2u < strip.size())
+                NEOGFX_CHECK(near(distance_at(triangles, distances, line, strip[line + 1u]), distance_at(triangles, distances, line + 1u, strip[line + 1u])));
+        }
+    }
+}
+
+NEOGFX_TEST(stipple_continuous_around_loop)
+{
+    neogfx::vertices const loop{
+        neogfx::vec3{ 0.0, 0.0, 0.0 }, neogfx::vec3{ 8.0, 0.0, 0.0 }, neogfx::vec3{ 8.0, 6.0, 0.0 }, neogfx::vec3{ 0.0, 6.0, 0.0 } };
+    neogfx::vertices triangles;
+    std::vector<float> distances;
+    stipple(neogfx::line_loop_to_lines(loop), 2.0, triangles, distances);
+    NEOGFX_CHECK(triangles.size() == loop.size() * 6u);
+    // the closing line ends back at the first vertex having covered the whole perimeter
+    NEOGFX_CHECK(near(distance_at(triangles, distances, loop.size() - 1u, loop[0]), 1.0 + 28.0));
+}
+
+NEOGFX_TEST(stipple_gaps_between_lines)
+{
+    // the gap between separate lines only counts towards the distance if aLoop is set
+    neogfx::vertices const lines{
+        neogfx::vec3{ 0.0, 0.0, 0.0 }, neogfx::vec3{ 10.0, 0.0, 0.0 }, neogfx::vec3{ 15.0, 0.0, 0.0 }, neogfx::vec3{ 25.0, 0.0, 0.0 } };
+    for (bool loop : { false, true })
+    {
+        neogfx::vertices triangles;
+        std::vector<float> distances;
+        stipple(lines, 2.0, triangles, distances, loop);
+        NEOGFX_CHECK(near(distance_at(triangles, distances, 1u, lines[2]), 1.0 + (loop ? 15.0 : 10.0)));
+    }
+}
@@ -0,0 +1,93 @@
+// text_edit_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gui/window/window.hpp>
+#include <neogfx/gui/widget/text_edit.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    std::string make_document(std::size_t aParagraphs)
+    {
+        std::string result;
+        for (std::size_t paragraph = 0u; paragraph < aParagraphs; ++paragraph)
+            result += "The quick brown fox jumps over the lazy dog (paragraph " + std::to_string(paragraph) + ")\n";
+        return result;
+    }
+
+    void wait_for_layout(neogfx::text_edit& aEdit)
+    {
+        while (!aEdit.layout_complete())
+            neogfx::unit_test::test_app().process_events();
+    }
+}
+
+// Time taken by one keystroke typed into the middle of documents of increasing size; as only the edited
+// paragraph is laid out again it should not grow with the document.
+NEOGFX_BENCHMARK(text_edit_keystroke)
+{
+    neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    for (std::size_t paragraphs : { 1000u, 10000u, 100000u })
+    {
+        neogfx::text_edit edit{ window.client_layout() };
+        edit.set_text(make_document(paragraphs));
+        wait_for_layout(edit);
+        auto const middle = edit.text().size() / 2u;
+        auto const insert = neogfx::unit_test::measure(100u, [&]() { edit.insert_text(middle, neogfx::string{ "x" }); });
+        neogfx::unit_test::report(std::to_string(paragraphs) + " paragraphs, insert character", insert, "us");
+        auto const split = neogfx::unit_test::measure(100u, [&]() { edit.insert_text(middle, neogfx::string{ "\n" }); });
+        neogfx::unit_test::report(std::to_string(paragraphs) + " paragraphs, insert line break", split, "us");
+    }
+}
+
+// Progressive layout of a large document: the time until set_text returns and the first frame has been 
+// processed, the longest single pass of the event loop while the rest is laid out in the background and
+// the time a cursor jump to the end of the not yet laid out text takes.
+NEOGFX_BENCHMARK(text_edit_progressive_layout)
+{
+    auto& app = neogfx::unit_test::test_app();
+    neogfx::window window{ neogfx::size{ 800.0, 600.0 } };
+    neogfx::text_edit edit{ window.client_layout() };
+    auto const document = make_document(200000u);
+    using clock = std::chrono::steady_clock;
+    auto const milliseconds = [](clock::duration aDuration) { return std::chrono::duration<double, std::milli>(aDuration).count(); };
+
+    auto const start = clock::now();
+    edit.set_text(document);
+    app.process_events();
+    neogfx::unit_test::report("time to first paint", milliseconds(clock::now() - start), "ms");
+    clock::duration worstStall{};
+    while (!edit.layout_complete())
+    {
+        auto const passStart = clock::now();
+        app.process_events();
+        worstStall = std::max(worstStall, clock::now() - passStart);
+    }
+    neogfx::unit_test::report("time to complete layout", milliseconds(clock::now() - start), "ms");
+    neogfx::unit_test::report("worst stall", milliseconds(worstStall), "ms");
+
+    edit.set_text(document);
+    app.process_events();
+    auto const jumpStart = clock::now();
+    edit.cursor().set_position(edit.text().size());
+    neogfx::unit_test::report("cursor jump to end", milliseconds(clock::now() - jumpStart), "ms");
+    wait_for_layout(edit);
+}
@@ -0,0 +1,138 @@
+// texture_upload_queue_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <random>
+#include <cstring>
+#include <neogfx/gfx/texture_upload_queue.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    std::size_t const kBytesPerPixel = 4u;
+    uint32_t const kExtent = 32u;
+
+    typedef std::vector<std::byte> texels;
+
+    neogfx::rect_u32 make_rect(uint32_t aX, uint32_t aY, uint32_t aCx, uint32_t aCy)
+    {
+        return neogfx::rect_u32{ neogfx::point_u32{ aX, aY }, neogfx::size_u32{ aCx, aCy } };
+    }
+
+    // writes tightly packed pixels the way glTexSubImage2D would
+    void write(texels& aTexture, neogfx::rect_u32 const& aRect, std::byte const* aPixels)
+    {
+        auto const rowBytes = aRect.cx * kBytesPerPixel;
+        for (uint32_t row = 0u; row < aRect.cy; ++row)
+            std::memcpy(&aTexture[((aRect.y + row) * kExtent + aRect.x) * kBytesPerPixel], aPixels + row * rowBytes, rowBytes);
+    }
+
+    texels replay(neogfx::texture_upload_queue const& aQueue)
+    {
+        texels result(kExtent * kExtent * kBytesPerPixel);
+        for (auto const& upload : aQueue.uploads())
+        {
+            NEOGFX_CHECK(upload.pixels.size() == upload.rect.cx * upload.rect.cy * kBytesPerPixel);
+            write(result, upload.rect, upload.pixels.data());
+        }
+        return result;
+    }
+}
+
+NEOGFX_TEST(texture_upload_queue_merges_adjacent_rows)
+{
+    neogfx::texture_upload_queue queue{ kBytesPerPixel };
+    texels row(16u * kBytesPerPixel);
+    // a rectangle written a row at a time, bottom half first, becomes one upload
+    for (uint32_t y : { 8u, 9u, 10u, 11u, 7u, 6u, 5u, 4u })
+        queue.enqueue(make_rect(2u, y, 16u, 1u), row.data());
+    NEOGFX_CHECK(queue.uploads().size() == 1u);
+    NEOGFX_CHECK(queue.uploads()[0].rect == make_rect(2u, 4u, 16u, 8u));
+    // as are columns written side by side
+    queue.clear();
+    texels column(8u * kBytesPerPixel);
+    for (uint32_t x : { 10u, 11u, 9u })
+        queue.enqueue(make_rect(x, 0u, 1u, 8u), column.data());
+    NEOGFX_CHECK(queue.uploads().size() == 1u && queue.uploads()[0].rect == make_rect(9u, 0u, 3u, 8u));
+    // a later upload covering earlier ones replaces them
+    texels all(kExtent * kExtent * kBytesPerPixel);
+    queue.enqueue(make_rect(0u, 0u, kExtent, kExtent), all.data());
+    NEOGFX_CHECK(queue.uploads().size() == 1u && queue.pending_bytes() == all.size());
+}
+
+NEOGFX_TEST(texture_upload_queue_unpack_alignment)
+{
+    // three byte pixels with rows padded to four bytes are packed tightly when staged
+    neogfx::texture_upload_queue queue{ 3u };
+    std::vector<std::byte> const source{
+        std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 }, std::byte{ 0xFF },
+        std::byte{ 4 }, std::byte{ 5 }, std::byte{ 6 }, std::byte{ 0xFF } };
+    queue.enqueue(make_rect(0u, 0u, 1u, 2u), source.data(), 4u);
+    NEOGFX_CHECK(queue.uploads().size() == 1u);
+    NEOGFX_CHECK((queue.uploads()[0].pixels == std::vector<std::byte>{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 }, std::byte{ 4 }, std::byte{ 5 }, std::byte{ 6 } }));
+}
+
+NEOGFX_TEST(texture_upload_queue_fuzz)
+{
+    // replaying the staged uploads always leaves the texture as writing each rectangle directly would, whatever
+    // was dropped or merged
+    std::mt19937 random{ 42u };
+    for (int iteration = 0; iteration < 2000; ++iteration)
+    {
+        neogfx::texture_upload_queue queue{ kBytesPerPixel };
+        texels expected(kExtent * kExtent * kBytesPerPixel);
+        auto const writes = std::uniform_int_distribution<int>{ 1, 40 }(random);
+        neogfx::rect_u32 previous = make_rect(0u, 0u, 1u, 1u);
+        for (int w = 0; w < writes; ++w)
+        {
+            neogfx::rect_u32 rect;
+            switch (std::uniform_int_distribution<int>{ 0, 3 }(random))
+            {
+            case 0:
+                // below the previous write, so likely to merge
+                rect = previous.y + previous.cy < kExtent ? make_rect(previous.x, previous.y + previous.cy, previous.cx, 1u) : previous;
+                break;
+            case 1:
+                // right of the previous write
+                rect = previous.x + previous.cx < kExtent ? make_rect(previous.x + previous.cx, previous.y, 1u, previous.cy) : previous;
+                break;
+            default:
+                {
+                    auto const x = std::uniform_int_distribution<uint32_t>{ 0u, kExtent - 1u }(random);
+                    auto const y = std::uniform_int_distribution<uint32_t>{ 0u, kExtent - 1u }(random);
+                    auto const cx = std::uniform_int_distribution<uint32_t>{ 1u, std::min(8u, kExtent - x) }(random);
+                    auto const cy = std::uniform_int_distribution<uint32_t>{ 1u, std::min(8u, kExtent - y) }(random);
+                    rect = make_rect(x, y, cx, cy);
+                }
+                break;
+            }
+            texels pixels(rect.cx * rect.cy * kBytesPerPixel);
+            for (auto& p : pixels)
+                p = static_cast<std::byte>(random());
+            write(expected, rect, pixels.data());
+            queue.enqueue(rect, pixels.data(), 1u);
+            previous = rect;
+        }
+        NEOGFX_CHECK(replay(queue) == expected);
+        std::size_t pending = 0u;
+        for (auto const& upload : queue.uploads())
+            pending += upload.pixels.size();
+        NEOGFX_CHECK(queue.pending_bytes() == pending);
+    }
+}
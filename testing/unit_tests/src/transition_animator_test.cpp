@@ -0,0 +1,64 @@
+// transition_animator_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/core/transition_animator.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    class test_transition : public neogfx::transition
+    {
+    public:
+        using transition::transition;
+    public:
+        bool finished() const final { return false; }
+        void clear() final {}
+        void sync(bool) final {}
+        bool can_apply() const final { return enabled() && !paused(); }
+        void apply() final { ++applied; }
+        void apply(double) final { ++applied; }
+    public:
+        uint32_t applied = 0u;
+    };
+}
+
+NEOGFX_TEST(animator_wakes_for_new_enabled_transition)
+{
+    auto& app = neogfx::unit_test::test_app();
+    neogfx::animator animator;
+    NEOGFX_CHECK(animator.idle());
+    {
+        test_transition disabled{ animator, neogfx::easing::Linear, 1.0, false };
+        NEOGFX_CHECK(animator.idle());
+    }
+    {
+        test_transition enabled{ animator, neogfx::easing::Linear, 1.0, true };
+        NEOGFX_CHECK(!animator.idle());
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+        while (enabled.applied == 0u && std::chrono::steady_clock::now() < deadline)
+            app.process_events();
+        NEOGFX_CHECK(enabled.applied != 0u);
+    }
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+    while (!animator.idle() && std::chrono::steady_clock::now() < deadline)
+        app.process_events();
+    NEOGFX_CHECK(animator.idle());
+    animator.stop();
+}
@@ -0,0 +1,68 @@
+// transition_benchmark.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/core/object.hpp>
+#include <neogfx/core/property.hpp>
+#include <neogfx/core/transition_animator.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    class animated : public neogfx::object<neogfx::i_property_owner>
+    {
+    public:
+        neogfx::property<double, neogfx::property_category::other, animated> Value{ *this, "Value", 0.0 };
+    };
+}
+
+// Time taken to write one frame's mix values to 10000 animated double properties, through apply(double)
+// and through the scalar_mix_handle the animator uses for a batch of arithmetic properties.
+NEOGFX_BENCHMARK(transition_mix_assign)
+{
+    neogfx::unit_test::test_app();
+    neogfx::animator animator;
+    std::vector<std::unique_ptr<animated>> objects(10000u);
+    std::vector<neogfx::i_transition::scalar_mix_handle> handles;
+    for (auto& object : objects)
+    {
+        object = std::make_unique<animated>();
+        object->Value.set_transition(animator, neogfx::easing::Linear, 1.0);
+        object->Value = 1.0;
+        NEOGFX_CHECK(object->Value.transition().mix_handle(handles.emplace_back()));
+    }
+    double mix = 0.0;
+    auto const viaApply = neogfx::unit_test::measure(100u, [&]()
+    {
+        mix = mix < 1.0 ? mix + 0.01 : 0.0;
+        for (auto& object : objects)
+            object->Value.transition().apply(mix);
+    });
+    neogfx::unit_test::report("10000 properties, apply(double)", viaApply, "us");
+    auto const viaHandle = neogfx::unit_test::measure(100u, [&]()
+    {
+        mix = mix < 1.0 ? mix + 0.01 : 0.0;
+        for (auto const& handle : handles)
+            handle.assign(handle.target, handle.from * (1.0 - mix) + handle.to * mix);
+    });
+    neogfx::unit_test::report("10000 properties, scalar_mix_handle", viaHandle, "us");
+    NEOGFX_CHECK(objects.front()->Value.value() == mix);
+    objects.clear();
+    animator.stop();
+}
@@ -0,0 +1,120 @@
+// translation_catalogue_test.cpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <random>
+#include <neogfx/app/translation_catalogue.hpp>
+#include "unit_test.hpp"
+
+namespace
+{
+    struct translation
+    {
+        std::string context;
+        std::string source;
+        std::int64_t plurality;
+        std::string target;
+    };
+
+    std::vector<translation> const& translations()
+    {
+        static std::vector<translation> const sTranslations = []()
+        {
+            std::vector<translation> result;
+            for (int i = 0; i < 64; ++i)
+            {
+                result.push_back({ {}, "Text " + std::to_string(i), 1, "Texte " + std::to_string(i) });
+                result.push_back({ "Menu", "Item " + std::to_string(i), 1, "Element " + std::to_string(i) });
+            }
+            result.push_back({ {}, "%n file(s)", 1, "%n fichier" });
+            result.push_back({ {}, "%n file(s)", 2, "%n fichiers" });
+            return result;
+        }();
+        return sTranslations;
+    }
+
+    std::vector<char> build_catalogue()
+    {
+        neogfx::translation_catalogue_builder builder;
+        builder.set_language("fr");
+        for (auto const& t : translations())
+            builder.add(t.context, t.source, t.plurality == 1 ? neogfx::translation_catalogue_builder::plurality_range{ 1, 1 } :
+                neogfx::translation_catalogue_builder::plurality_range{ 2, std::numeric_limits<std::int64_t>::max() }, t.target);
+        return builder.build();
+    }
+}
+
+NEOGFX_TEST(translation_catalogue_lookup)
+{
+    auto const data = build_catalogue();
+    neogfx::translation_catalogue const catalogue{ data.data(), data.size() };
+    NEOGFX_CHECK(catalogue.language() == "fr");
+    for (auto const& t : translations())
+    {
+        auto const target = catalogue.find(t.context, t.source, t.plurality);
+        NEOGFX_CHECK(target && catalogue.text(*target) == t.target);
+    }
+    NEOGFX_CHECK(!catalogue.find({}, "Item 0", 1));
+    NEOGFX_CHECK(!catalogue.find({}, "Untranslated", 1));
+}
+
+NEOGFX_TEST(translation_catalogue_fuzz)
+{
+    // a corrupt catalogue is either rejected when it is loaded or is safe to search
+    auto const original = build_catalogue();
+    std::mt19937 random{ 42u };
+    for (int iteration = 0; iteration < 10000; ++iteration)
+    {
+        auto data = original;
+        if (iteration % 4 == 0)
+            data.resize(std::uniform_int_distribution<std::size_t>{ 0u, data.size() - 1u }(random));
+        else
+        {
+            auto const mutations = std::uniform_int_distribution<int>{ 1, 8 }(random);
+            // mutations mostly land in the header, seeds, entries and targets rather than the string pool
+            auto const limit = iteration % 2 == 0 ? data.size() - 1u : std::min<std::size_t>(data.size() - 1u, 1024u);
+            for (int mutation = 0; mutation < mutations; ++mutation)
+                data[std::uniform_int_distribution<std::size_t>{ 0u, limit }(random)] = static_cast<char>(random());
+        }
+        std::optional<neogfx::translation_catalogue> catalogue;
+        try
+        {
+            catalogue.emplace(data.data(), data.size());
+        }
+        catch (neogfx::translation_catalogue::bad_catalogue const&)
+        {
+            continue;
+        }
+        bool searched = true;
+        try
+        {
+            for (auto const& t : translations())
+            {
+                auto const target = catalogue->find(t.context, t.source, t.plurality);
+                if (target)
+                    searched = searched && catalogue->text(*target).size() <= data.size();
+            }
+        }
+        catch (...)
+        {
+            searched = false;
+        }
+        NEOGFX_CHECK(searched);
+    }
+}
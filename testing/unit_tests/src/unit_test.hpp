@@ -0,0 +1,114 @@
+// unit_test.hpp
+/*
+  neogfx C++ App/Game Engine - Unit Tests
+  Copyright (c) 2020 Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <neogfx/app/app.hpp>
+
+namespace neogfx::unit_test
+{
+    struct check_failed : std::runtime_error { check_failed(std::string const& aWhat) : std::runtime_error{ aWhat } {} };
+
+    enum class test_kind
+    {
+        Test,
+        Benchmark
+    };
+
+    struct test_case
+    {
+        char const* name;
+        test_kind kind;
+        void(*function)();
+    };
+
+    inline std::vector<test_case>& test_cases()
+    {
+        static std::vector<test_case> sTestCases;
+        return sTestCases;
+    }
+
+    struct test_registration
+    {
+        test_registration(char const* aName, test_kind aKind, void(*aFunction)())
+        {
+            test_cases().push_back(test_case{ aName, aKind, aFunction });
+        }
+    };
+
+    inline void check(bool aCondition, char const* aExpression, char const* aFile, int aLine)
+    {
+        if (!aCondition)
+            throw check_failed{ std::string{ aFile } + "(" + std::to_string(aLine) + "): check failed: " + aExpression };
+    }
+
+    template <typename Exception, typename Function>
+    inline bool throws(Function aFunction)
+    {
+        try
+        {
+            aFunction();
+        }
+        catch (Exception const&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    // Runs aFunction aIterations times and returns the mean duration of one run in microseconds.
+    template <typename Function>
+    inline double measure(std::size_t aIterations, Function aFunction)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < aIterations; ++i)
+            aFunction();
+        auto const end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / static_cast<double>(aIterations);
+    }
+
+    // The app widget tests and benchmarks run in; created on first use and shared by all of them.
+    inline neogfx::app& test_app()
+    {
+        static char name[] = "unit_tests";
+        static char* argv[] = { name, nullptr };
+        static neogfx::app sApp{ 1, argv, "neoGFX Unit Tests" };
+        return sApp;
+    }
+
+    inline void report(std::string const& aMeasurement, double aValue, std::string const& aUnits)
+    {
+        std::cout << "    " << aMeasurement << ": " << aValue << " " << aUnits << std::endl;
+    }
+}
+
+#define NEOGFX_UNIT_TEST_CASE(name, kind) \
+    static void name(); \
+    static neogfx::unit_test::test_registration const name##_registration{ #name, neogfx::unit_test::test_kind::kind, &name }; \
+    static void name()
+
+#define NEOGFX_TEST(name) NEOGFX_UNIT_TEST_CASE(name, Test)
+#define NEOGFX_BENCHMARK(name) NEOGFX_UNIT_TEST_CASE(name, Benchmark)
+#define NEOGFX_CHECK(expression) neogfx::unit_test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
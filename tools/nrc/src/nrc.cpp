@@ -20,10 +20,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <neogfx/neogfx.hpp>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <iterator>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/algorithm/string.hpp>
 #include <neolib/file/json.hpp>
 #include <neolib/app/application.hpp>
+#include <neogfx/app/translation_catalogue.hpp>
 
 #include "resource_parser.hpp"
 #include "ui_parser.hpp"
@@ -36,6 +40,7 @@ namespace neogfx::nrc
         invalid_file() : std::runtime_error("Not a valid neoGFX resource meta file (.nrc)!") {}
         invalid_file(std::string const& aReason) : std::runtime_error("Not a valid neoGFX resource meta file (.nrc), " + aReason + "!") {}
     };
+    struct invalid_translation_file : std::runtime_error { invalid_translation_file() : std::runtime_error("Not a valid neoGFX translation file (.xneol)!") {} };
     struct bad_usage : std::runtime_error { bad_usage() : std::runtime_error("Bad usage") {} };
 
     void parse_ui(const boost::filesystem::path& aInputFilename, neolib::i_plugin_manager& aPluginManager, const neolib::fjson_string& aNamespace, const neolib::fjson_value& aItem, std::ofstream& aOutput)
@@ -44,6 +49,49 @@ namespace neogfx::nrc
         auto ns = aNamespace + (ui.has("namespace") ? "_" + ui.at("namespace").text() : "");
         ui_parser uiParser{ aInputFilename, aPluginManager, ns, ui, aOutput };
     }
+
+    std::string const kInputHashPrefix = "// nrc input hash: ";
+
+    bool up_to_date(std::string const& aResourceOutputPath, std::string const& aBlobOutputPath, std::string const& aBlobResourceScriptPath, content_hash aInputHash)
+    {
+        if (!boost::filesystem::exists(aResourceOutputPath) || !boost::filesystem::exists(aBlobOutputPath) || !boost::filesystem::exists(aBlobResourceScriptPath))
+            return false;
+        std::ifstream existing{ aResourceOutputPath };
+        std::string firstLine;
+        std::getline(existing, firstLine);
+        std::ostringstream expected;
+        expected << kInputHashPrefix << std::hex << aInputHash;
+        return firstLine == expected.str();
+    }
+
+    void write_blob_stub(std::ostream& aOutput, std::string const& aSymbol, std::string const& aBlobOutputPath)
+    {
+        // MSVC has no .incbin so there the blob is linked as an RCDATA resource (see the generated .rc file)...
+        aOutput << "#ifdef _MSC_VER" << std::endl;
+        aOutput << "#include <windows.h>" << std::endl << std::endl;
+        aOutput << "namespace nrc" << std::endl << "{" << std::endl << "namespace" << std::endl << "{" << std::endl;
+        aOutput << "\tconst unsigned char* " << aSymbol << "_blob()" << std::endl << "\t{" << std::endl;
+        aOutput << "\t\tstatic const unsigned char* const sBlob = []()" << std::endl << "\t\t{" << std::endl;
+        aOutput << "\t\t\tHMODULE module = nullptr;" << std::endl;
+        aOutput << "\t\t\t::GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCSTR>(&" << aSymbol << "_blob), &module);" << std::endl;
+        aOutput << "\t\t\tHRSRC const blobInfo = ::FindResourceA(module, \"" << boost::to_upper_copy(aSymbol) << "\", MAKEINTRESOURCEA(10) /* RT_RCDATA */);" << std::endl;
+        aOutput << "\t\t\treturn blobInfo != nullptr ? static_cast<const unsigned char*>(::LockResource(::LoadResource(module, blobInfo))) : nullptr;" << std::endl;
+        aOutput << "\t\t}();" << std::endl;
+        aOutput << "\t\treturn sBlob;" << std::endl << "\t}" << std::endl;
+        aOutput << "}" << std::endl << "}" << std::endl;
+        aOutput << "#else" << std::endl;
+        aOutput << "#ifdef __APPLE__" << std::endl;
+        aOutput << "__asm__(\".const_data\\n.balign 16\\n.globl _nrc_" << aSymbol << "_blob_data\\n_nrc_" << aSymbol << "_blob_data:\\n.incbin \\\"" << aBlobOutputPath << "\\\"\\n.text\\n\");" << std::endl;
+        aOutput << "#else" << std::endl;
+        aOutput << "__asm__(\".section .rodata\\n.balign 16\\n.globl nrc_" << aSymbol << "_blob_data\\nnrc_" << aSymbol << "_blob_data:\\n.incbin \\\"" << aBlobOutputPath << "\\\"\\n.previous\\n\");" << std::endl;
+        aOutput << "#endif" << std::endl;
+        aOutput << "extern \"C\" const unsigned char nrc_" << aSymbol << "_blob_data[];" << std::endl << std::endl;
+        aOutput << "namespace nrc" << std::endl << "{" << std::endl << "namespace" << std::endl << "{" << std::endl;
+        aOutput << "\tconst unsigned char* " << aSymbol << "_blob()" << std::endl << "\t{" << std::endl;
+        aOutput << "\t\treturn nrc_" << aSymbol << "_blob_data;" << std::endl << "\t}" << std::endl;
+        aOutput << "}" << std::endl << "}" << std::endl;
+        aOutput << "#endif" << std::endl << std::endl;
+    }
 }
 
 int main(int argc, char* argv[])
@@ -87,6 +135,20 @@ int main(int argc, char* argv[])
         }
 
         boost::filesystem::path const inputFileName{ files[0] };
+
+        if (!options.empty() && options[0] == "-translations")
+        {
+            std::cout << "Translation file: " << inputFileName << std::endl;
+            neogfx::translation_catalogue_builder catalogue;
+            if (!catalogue.parse_xneol(inputFileName.string()))
+                throw invalid_translation_file();
+            auto const catalogueOutputPath = (files.size() > 1 ? files[1] : boost::filesystem::current_path().string()) + "/" + inputFileName.filename().stem().string() + ".neolc";
+            std::cout << "Creating " << catalogueOutputPath << "..." << std::endl;
+            auto const compiled = catalogue.build();
+            std::ofstream{ catalogueOutputPath, std::ios_base::out | std::ios_base::binary }.write(compiled.data(), compiled.size());
+            return 0;
+        }
+
         std::cout << "Resource meta file: " << inputFileName << std::endl;
         neolib::fjson const input{ inputFileName.string() };
         if (!input.has_root())
@@ -96,19 +158,28 @@ int main(int argc, char* argv[])
 
         std::string resourceFileName;
         std::string uiFileName;
-        if (options.empty() || options[0] == "-embed")
+        std::string blobFileName;
+        std::string blobResourceScriptFileName;
+        bool const blob = !options.empty() && options[0] == "-blob";
+        bool const compress = std::find(options.begin(), options.end(), "-compress") != options.end();
+        if (options.empty() || options[0] == "-embed" || options[0] == "-blob" || options[0] == "-compress")
         {
             resourceFileName = inputFileName.filename().stem().string() + ".res.cpp";
             uiFileName = inputFileName.filename().stem().string() + ".ui.hpp";
+            blobFileName = inputFileName.filename().stem().string() + ".res.bin";
+            blobResourceScriptFileName = inputFileName.filename().stem().string() + ".res.rc";
         }
         else if (options[0] == "-archive")
             throw not_yet_implemented("nrc");
         else
             throw bad_usage();
+        if (compress && !blob)
+            throw bad_usage();
 
-        if (options.empty() || options[0] == "-embed")
         {
             std::optional<std::ofstream> resourceOutput;
+            std::ostringstream blobResourceOutput;
+            std::optional<resource_blob> resourceBlob;
             std::optional<std::ofstream> uiOutput;
             auto const& ns = input.root().as<neolib::fjson_object>().has("namespace") ? input.root().as<neolib::fjson_object>().at("namespace").text() : "";
             std::optional<resource_parser> resourceParser;
@@ -116,6 +187,22 @@ int main(int argc, char* argv[])
             {
                 if (item.name() == "resource")
                 {
+                    if (blob)
+                    {
+                        if (resourceBlob == std::nullopt)
+                        {
+                            auto symbol = (ns.empty() ? std::string{} : ns + "_") + inputFileName.filename().stem().string();
+                            boost::replace_all(symbol, "::", "_");
+                            for (auto& ch : symbol)
+                                if (!std::isalnum(static_cast<unsigned char>(ch)))
+                                    ch = '_';
+                            resourceBlob.emplace(resource_blob{ symbol, compress });
+                        }
+                        if (resourceParser == std::nullopt)
+                            resourceParser.emplace(inputFileName, ns, blobResourceOutput, *resourceBlob);
+                        resourceParser->parse(item);
+                        continue;
+                    }
                     if (resourceOutput == std::nullopt)
                     {
                         auto resourceOutputPath = outputDirectory + "/" + resourceFileName;
@@ -139,11 +226,40 @@ int main(int argc, char* argv[])
                     parse_ui(inputFileName, app.plugin_manager(), ns, item, *uiOutput);
                 }
             }
+            if (resourceBlob != std::nullopt)
+            {
+                auto const resourceOutputPath = outputDirectory + "/" + resourceFileName;
+                auto const blobOutputPath = boost::filesystem::absolute(outputDirectory + "/" + blobFileName).generic_string();
+                auto const blobResourceScriptPath = outputDirectory + "/" + blobResourceScriptFileName;
+                std::ifstream nrcFile{ inputFileName.string(), std::ios_base::in | std::ios_base::binary };
+                std::string const nrcContents{ std::istreambuf_iterator<char>{ nrcFile }, std::istreambuf_iterator<char>{} };
+                content_hash inputHash = resourceParser->input_hash();
+                hash_content(inputHash, nrcContents.data(), nrcContents.size());
+                hash_content(inputHash, &resourceBlob->compress, sizeof(resourceBlob->compress));
+                hash_content(inputHash, blobOutputPath.data(), blobOutputPath.size());
+                if (up_to_date(resourceOutputPath, blobOutputPath, blobResourceScriptPath, inputHash))
+                    std::cout << resourceOutputPath << " is up to date." << std::endl;
+                else
+                {
+                    resourceParser->generate_blob();
+                    std::cout << "Creating " << blobOutputPath << "..." << std::endl;
+                    std::ofstream{ blobOutputPath, std::ios_base::out | std::ios_base::binary }.write(resourceBlob->data.data(), resourceBlob->data.size());
+                    std::cout << "Creating " << blobResourceScriptPath << "..." << std::endl;
+                    std::ofstream{ blobResourceScriptPath } << boost::to_upper_copy(resourceBlob->symbol) << " RCDATA \"" << blobFileName << "\"" << std::endl;
+                    std::cout << "Creating " << resourceOutputPath << "..." << std::endl;
+                    std::ofstream resourceOutput{ resourceOutputPath };
+                    resourceOutput << kInputHashPrefix << std::hex << inputHash << std::dec << std::endl;
+                    resourceOutput << "// This is an automatically generated file, do not edit!" << std::endl << std::endl;
+                    resourceOutput << "#include <neogfx/app/resource_manager.hpp>" << std::endl << std::endl;
+                    write_blob_stub(resourceOutput, resourceBlob->symbol, blobOutputPath);
+                    resourceOutput << blobResourceOutput.str();
+                }
+            }
         }
     }
     catch (const bad_usage&)
     {
-        std::cerr << "Usage: " << argv[0] << " [-embed|-archive] <input path> [<output directory>]" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-embed|-blob [-compress]|-archive|-translations] <input path> [<output directory>]" << std::endl;
         return EXIT_FAILURE;
     }
     catch (const std::exception& e)
@@ -20,7 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <iterator>
 #include <boost/algorithm/string.hpp>
+#include <zlib.h>
 
 #include "resource_parser.hpp"
 
@@ -31,77 +33,60 @@ namespace neogfx::nrc
         failed_to_read_resource_file(std::string const& aPath) : std::runtime_error("Failed to read resource file '" + aPath + "'!") {}
     };
 
-    resource_parser::resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ofstream& aOutput) :
-        iInputFilename{ aInputFilename }, iNamespace{ aNamespace }, iOutput{ aOutput }, iResourceIndex{ 0u }
+    struct failed_to_compress_resource : std::runtime_error
+    {
+        failed_to_compress_resource(std::string const& aPath) : std::runtime_error("Failed to compress resource file '" + aPath + "'!") {}
+    };
+
+    resource_parser::resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ostream& aOutput) :
+        iInputFilename{ aInputFilename }, iNamespace{ aNamespace }, iOutput{ aOutput }, iBlob{ nullptr }, iResourceIndex{ 0u }, iInputHash{ content_hash_seed }
+    {
+    }
+
+    resource_parser::resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ostream& aOutput, resource_blob& aBlob) :
+        iInputFilename{ aInputFilename }, iNamespace{ aNamespace }, iOutput{ aOutput }, iBlob{ &aBlob }, iResourceIndex{ 0u }, iInputHash{ content_hash_seed }
     {
     }
 
+    content_hash resource_parser::input_hash() const
+    {
+        return iInputHash;
+    }
+
     void resource_parser::parse(const neolib::fjson_value& aItem)
     {
         auto const& resource = aItem.as<neolib::fjson_object>();
 
-        typedef neolib::fjson_string symbol_t;
-        std::vector<std::string> resourcePaths;
+        resource_item item;
 
         auto resourcePrefix = (iNamespace + (resource.has("namespace") ? ("/" + resource.at("namespace").text()) : ""));
         boost::replace_all(resourcePrefix, "::", "/");
 
         auto const& resourceRef = resource.has("ref") ? resource.at("ref").text() : "";
-        auto symbol = iInputFilename.filename().stem().string();
-        if (!symbol.empty() && !resourceRef.empty())
-            symbol += "_";
-        symbol += resourceRef;
+        item.symbol = iInputFilename.filename().stem().string();
+        if (!item.symbol.empty() && !resourceRef.empty())
+            item.symbol += "_";
+        item.symbol += resourceRef;
 
-        iOutput << "namespace nrc" << std::endl << "{" << std::endl;
-        iOutput << "namespace" << std::endl << "{" << std::endl;
-
-        auto nextResourceIndex = iResourceIndex;
+        item.initializerName = (iNamespace + (resource.has("namespace") ? ("_" + resource.at("namespace").text()) : "")) + "_" + item.symbol;
+        boost::replace_all(item.initializerName, "::", "_");
 
         for (auto const& resourceItem : resource.contents())
         {
             auto process_file = [&](const neolib::fjson_string& aInputFilename)
             {
                 std::cout << "Processing " << aInputFilename << "..." << std::endl;
-                resourcePaths.push_back((!resourcePrefix.empty() ? resourcePrefix + "/" : "") + aInputFilename);
                 std::string resourcePath = boost::filesystem::path(iInputFilename).parent_path().string();
                 if (!resourcePath.empty())
                     resourcePath += "/";
                 resourcePath += aInputFilename;
                 std::ifstream resourceFile(resourcePath, std::ios_base::in | std::ios_base::binary);
-                iOutput << "\tconst unsigned char resource_" << nextResourceIndex << "_data[] =" << std::endl << "\t{" << std::endl;
-                const std::size_t kBufferSize = 32;
-                bool doneSome = false;
-                unsigned char buffer[kBufferSize];
-                while (resourceFile)
-                {
-                    resourceFile.read(reinterpret_cast<char*>(buffer), kBufferSize);
-                    std::streamsize amount = resourceFile.gcount();
-                    if (amount != 0)
-                    {
-                        if (doneSome)
-                            iOutput << ", " << std::endl;
-                        iOutput << "\t\t";
-                        for (std::size_t j = 0; j != amount;)
-                        {
-                            iOutput << "0x";
-                            iOutput.width(2);
-                            iOutput.fill('0');
-                            iOutput << std::hex << std::uppercase << static_cast<unsigned int>(buffer[j]);
-                            if (++j != amount)
-                                iOutput << ", ";
-                        }
-                        doneSome = true;
-                    }
-                    else
-                    {
-                        iOutput << std::endl;
-                        break;
-                    }
-                }
-                if (resourceFile.fail() && !resourceFile.eof())
+                std::vector<char> contents{ std::istreambuf_iterator<char>{ resourceFile }, std::istreambuf_iterator<char>{} };
+                if (!resourceFile.eof() && resourceFile.fail())
                     throw failed_to_read_resource_file(resourcePath);
-                iOutput << "\t};" << std::endl;
-                ++nextResourceIndex;
+                hash_content(iInputHash, aInputFilename.data(), aInputFilename.size());
+                hash_content(iInputHash, contents.data(), contents.size());
+                item.files.push_back(resource_file{ (!resourcePrefix.empty() ? resourcePrefix + "/" : "") + aInputFilename, resourcePath, std::move(contents) });
             };
 
             if (resourceItem.name() == "file")
@@ -113,23 +98,110 @@ namespace neogfx::nrc
                 continue;
         }
 
+        // blob output is only generated (and compressed) once the caller knows from input_hash() that it is out of date
+        if (iBlob == nullptr)
+            generate(item);
+        else
+            iPendingItems.push_back(std::move(item));
+    }
+
+    void resource_parser::generate_blob()
+    {
+        for (auto const& item : iPendingItems)
+            generate(item);
+        iPendingItems.clear();
+    }
+
+    void resource_parser::generate(resource_item const& aItem)
+    {
+        iOutput << "namespace nrc" << std::endl << "{" << std::endl;
+        iOutput << "namespace" << std::endl << "{" << std::endl;
+
+        auto nextResourceIndex = iResourceIndex;
+        for (auto const& file : aItem.files)
+        {
+            if (iBlob == nullptr)
+                embed(file.contents, nextResourceIndex);
+            else
+                append_to_blob(file.contents, file.filePath);
+            ++nextResourceIndex;
+        }
+
         iOutput << "\n\tstruct register_" << "resource_" << iResourceIndex << std::endl << "\t{" << std::endl;
         iOutput << "\t\tregister_" << "resource_" << iResourceIndex << "()" << std::endl << "\t\t{" << std::endl;
-        for (std::size_t i = 0; i < resourcePaths.size(); ++i, ++iResourceIndex)
+        for (auto const& file : aItem.files)
         {
-            iOutput << "\t\t\tneogfx::resource_manager::instance().add_module_resource("
-                << "\":/" << resourcePaths[i] << "\", " << "resource_" << iResourceIndex << "_data, " << "sizeof(resource_" << iResourceIndex << "_data)"
-                << ");" << std::endl;
+            if (iBlob == nullptr)
+                iOutput << "\t\t\tneogfx::resource_manager::instance().add_module_resource("
+                    << "\":/" << file.resourcePath << "\", " << "resource_" << iResourceIndex << "_data, " << "sizeof(resource_" << iResourceIndex << "_data)"
+                    << ");" << std::endl;
+            else
+            {
+                auto const& entry = iBlobEntries[iResourceIndex];
+                if (entry.size == entry.uncompressedSize)
+                    iOutput << "\t\t\tneogfx::resource_manager::instance().add_module_resource("
+                        << "\":/" << file.resourcePath << "\", " << iBlob->symbol << "_blob() + " << std::dec << entry.offset << ", " << entry.size
+                        << ");" << std::endl;
+                else
+                    iOutput << "\t\t\tneogfx::resource_manager::instance().add_compressed_module_resource("
+                        << "\":/" << file.resourcePath << "\", " << iBlob->symbol << "_blob() + " << std::dec << entry.offset << ", " << entry.size << ", " << entry.uncompressedSize
+                        << ");" << std::endl;
+            }
+            ++iResourceIndex;
         }
 
         iOutput << "\t\t}" << std::endl;
 
-        iOutput << "\t} " << symbol << ";" << std::endl;
+        iOutput << "\t} " << aItem.symbol << ";" << std::endl;
 
         iOutput << "}" << std::endl << "}" << std::endl << std::endl;
 
-        auto initializerName = (iNamespace + (resource.has("namespace") ? ("_" + resource.at("namespace").text()) : "")) + "_" + symbol;
-        boost::replace_all(initializerName, "::", "_");
-        iOutput << "extern \"C\" void* nrc_" << initializerName << " = &nrc::" << symbol << ";" << std::endl << std::endl;
+        iOutput << "extern \"C\" void* nrc_" << aItem.initializerName << " = &nrc::" << aItem.symbol << ";" << std::endl << std::endl;
+    }
+
+    void resource_parser::embed(std::vector<char> const& aContents, uint32_t aResourceIndex)
+    {
+        iOutput << "\tconst unsigned char resource_" << std::dec << aResourceIndex << "_data[] =" << std::endl << "\t{" << std::endl;
+        const std::size_t kBytesPerLine = 32;
+        for (std::size_t i = 0; i < aContents.size(); ++i)
+        {
+            if (i % kBytesPerLine == 0)
+                iOutput << (i != 0 ? ", \n" : "") << "\t\t";
+            else
+                iOutput << ", ";
+            iOutput << "0x";
+            iOutput.width(2);
+            iOutput.fill('0');
+            iOutput << std::hex << std::uppercase << static_cast<unsigned int>(static_cast<unsigned char>(aContents[i]));
+        }
+        if (!aContents.empty())
+            iOutput << std::endl;
+        iOutput << "\t};" << std::endl << std::dec;
+    }
+
+    void resource_parser::append_to_blob(std::vector<char> const& aContents, std::string const& aResourcePath)
+    {
+        const std::size_t kAlignment = 16;
+        iBlob->data.resize((iBlob->data.size() + kAlignment - 1) / kAlignment * kAlignment);
+        blob_entry entry{ iBlob->data.size(), aContents.size(), aContents.size() };
+        bool stored = false;
+        if (iBlob->compress && !aContents.empty())
+        {
+            uLongf compressedSize = ::compressBound(static_cast<uLong>(aContents.size()));
+            std::vector<char> compressed(compressedSize);
+            if (::compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize, 
+                reinterpret_cast<const Bytef*>(aContents.data()), static_cast<uLong>(aContents.size()), Z_BEST_COMPRESSION) != Z_OK)
+                throw failed_to_compress_resource(aResourcePath);
+            // only keep the compressed form if it is worth the cost of decompressing at startup
+            if (compressedSize < aContents.size() - aContents.size() / 8)
+            {
+                entry.size = compressedSize;
+                iBlob->data.insert(iBlob->data.end(), compressed.begin(), std::next(compressed.begin(), compressedSize));
+                stored = true;
+            }
+        }
+        if (!stored)
+            iBlob->data.insert(iBlob->data.end(), aContents.begin(), aContents.end());
+        iBlobEntries.push_back(entry);
     }
-}
+}
\ No newline at end of file
@@ -24,16 +24,67 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace neogfx::nrc
 {
+    // FNV-1a; used to detect unchanged resource inputs so outputs are not regenerated needlessly.
+    typedef uint64_t content_hash;
+    content_hash const content_hash_seed = 0xcbf29ce484222325ull;
+
+    inline void hash_content(content_hash& aHash, const void* aData, std::size_t aSize)
+    {
+        auto const bytes = static_cast<const unsigned char*>(aData);
+        for (std::size_t i = 0; i < aSize; ++i)
+        {
+            aHash ^= bytes[i];
+            aHash *= 0x100000001b3ull;
+        }
+    }
+
+    struct resource_blob
+    {
+        std::string symbol;
+        bool compress = false;
+        std::vector<char> data;
+    };
+
     class resource_parser
     {
     public:
-        resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ofstream& aOutput);
+        resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ostream& aOutput);
+        resource_parser(const boost::filesystem::path& aInputFilename, const neolib::fjson_string& aNamespace, std::ostream& aOutput, resource_blob& aBlob);
     public:
         void parse(const neolib::fjson_value& aItem);
+        content_hash input_hash() const;
+        void generate_blob();
+    private:
+        struct resource_file
+        {
+            std::string resourcePath;
+            std::string filePath;
+            std::vector<char> contents;
+        };
+        struct resource_item
+        {
+            std::string symbol;
+            std::string initializerName;
+            std::vector<resource_file> files;
+        };
+        struct blob_entry
+        {
+            std::size_t offset;
+            std::size_t size;
+            std::size_t uncompressedSize;
+        };
+    private:
+        void generate(resource_item const& aItem);
+        void embed(std::vector<char> const& aContents, uint32_t aResourceIndex);
+        void append_to_blob(std::vector<char> const& aContents, std::string const& aResourcePath);
     private:
         const boost::filesystem::path iInputFilename;
         const neolib::fjson_string iNamespace;
-        std::ofstream& iOutput;
+        std::ostream& iOutput;
+        resource_blob* iBlob;
+        std::vector<resource_item> iPendingItems;
+        std::vector<blob_entry> iBlobEntries;
         uint32_t iResourceIndex;
+        content_hash iInputHash;
     };
 }